@@ -0,0 +1,130 @@
+/* FleetSim.cpp
+ * UT Austin RAS Demobots
+ * Fleet simulator: runs the real firmware for a mothership and up to SIM_MAX_BOTS bots on a PC, see SimWorld.h
+ *
+ * Build from the Dancebot folder (no ESP32 toolchain needed), with every .cpp file in sim but not the ones in sim/tests:
+ *    g++ -std=gnu++11 -O2 -Wall -Isim/host -Isrc sim/Fleet*.cpp sim/Sim*.cpp -o fleetsim
+ *
+ * Run:
+ *    ./fleetsim [options] [t_ms:Move | t_ms:/path?args ...]
+ *    --bots N            number of bots (default 4)
+ *    --seconds S         how long to run (default 20)
+ *    --seed N            random seed, the same seed and options give the same run (default 1)
+ *    --latency US        frame latency (default 2000)
+ *    --jitter US         extra random frame latency, up to this (default 1000)
+ *    --timer-jitter US   esp_timer callbacks run up to this late, not the motion task on APP_CPU (default 0)
+ *    --clock-ppm PPM     each bot's crystal is off by a random amount up to this, the mothership's is exact (default 0)
+ *    --loss PERCENT      frames lost to each receiver (default 0)
+ *    --reorder PERCENT   frames held back so later ones overtake them (default 0)
+ *    --loop-us US        time one loop() takes (default 1000)
+ *    --boot-spread MS    bots power on at random times up to this (default 500)
+ *    --battery MV        what the bots' battery monitors read (default 8000)
+ *    --trace DIR         write DIR/<node>.csv with every servo write, "t_us,joint,angle"
+ *    --max-sample-gap US exit with 1 if a node's servo samples are ever further apart than this while it moves
+ *    --verbose           print every node's Serial output
+ *
+ * Each t_ms:Move asks the mothership's web page for a dance move (POST /danceM?dance_move=Move) at t_ms,
+ * t_ms:/path?args sends any other request (POST). Without any, the bots Walk, Wiggle, Hop and Stop.
+ *
+ * The report has each node's radio counts, how far each bot's legs were from the first bot's (rms_deg),
+ * how far each bot's servo samples were from the mothership's once the beat clock settled (tick_ms, see BeatClock.h),
+ * and for every dance move how long after the mothership the bots started it (skew).
+ * Exits with 1 if a bot never got a dance move, or its servo samples were further apart than --max-sample-gap.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "SimWorld.h"
+
+static const char* defaultScript[] = {"3000:Walk", "8000:Wiggle", "13000:Hop", "18000:Stop"};
+
+static void usage() {
+  fprintf(stderr, "usage: fleetsim [--bots N] [--seconds S] [--seed N] [--latency US] [--jitter US] [--timer-jitter US] [--clock-ppm PPM]\n"
+                  "                [--loss PERCENT] [--reorder PERCENT] [--loop-us US] [--boot-spread MS] [--battery MV] [--trace DIR]\n"
+                  "                [--max-sample-gap US] [--verbose]\n"
+                  "                [t_ms:Move | t_ms:/path?args ...]\n");
+}
+
+//t_ms:Move or t_ms:/path?args
+static bool addRequest(const char* arg) {
+  char* end;
+  long t = strtol(arg, &end, 10);
+  if (end == arg || *end != ':' || t < 0) {
+    return false;
+  }
+  const char* what = end + 1;
+  char uri[160];
+  if (what[0] == '/') {snprintf(uri, sizeof(uri), "%s", what);}
+  else {snprintf(uri, sizeof(uri), "/danceM?dance_move=%s", what);}
+  return simWorld.request((uint64_t) t * 1000, 0, uri, true);
+}
+
+int main(int argc, char** argv) {
+  SimConfig config;
+  memset(&config, 0, sizeof(config));
+  config.seed = 1;
+  config.numBots = 4;
+  config.durationUs = 20000000;
+  config.loopUs = 1000;
+  config.bootSpreadUs = 500000;
+  config.latencyUs = 2000;
+  config.jitterUs = 1000;
+  config.batteryMillivolts = 8000;
+
+  long maxSampleGap = -1;
+
+  const char* script[SIM_MAX_COMMANDS];
+  int numScript = 0;
+  for (int i = 1; i < argc; i++) {
+    const char* option = argv[i];
+    bool hasValue = i + 1 < argc;
+    long value = hasValue ? strtol(argv[i + 1], NULL, 10) : 0;
+    if (strcmp(option, "--verbose") == 0) {config.verbose = true; continue;}
+    if (option[0] != '-' && numScript < SIM_MAX_COMMANDS) {script[numScript++] = option; continue;}
+    if (!hasValue) {usage(); return 2;}
+    i++;
+    if (strcmp(option, "--bots") == 0) {config.numBots = value;}
+    else if (strcmp(option, "--seconds") == 0) {config.durationUs = (uint64_t) value * 1000000;}
+    else if (strcmp(option, "--seed") == 0) {config.seed = value;}
+    else if (strcmp(option, "--latency") == 0) {config.latencyUs = value;}
+    else if (strcmp(option, "--jitter") == 0) {config.jitterUs = value;}
+    else if (strcmp(option, "--timer-jitter") == 0) {config.timerJitterUs = value;}
+    else if (strcmp(option, "--clock-ppm") == 0) {config.clockPpm = value;}
+    else if (strcmp(option, "--loss") == 0) {config.lossPercent = value;}
+    else if (strcmp(option, "--reorder") == 0) {config.reorderPercent = value;}
+    else if (strcmp(option, "--loop-us") == 0) {config.loopUs = value;}
+    else if (strcmp(option, "--boot-spread") == 0) {config.bootSpreadUs = value * 1000;}
+    else if (strcmp(option, "--battery") == 0) {config.batteryMillivolts = value;}
+    else if (strcmp(option, "--trace") == 0) {config.traceDir = argv[i];}
+    else if (strcmp(option, "--max-sample-gap") == 0) {maxSampleGap = value;}
+    else {usage(); return 2;}
+  }
+  if (config.loopUs == 0 || config.lossPercent < 0 || config.lossPercent > 100 || config.clockPpm < 0 || config.clockPpm > 1000) {
+    usage();
+    return 2;
+  }
+
+  if (!simWorld.begin(&config)) {
+    return 2;
+  }
+  if (numScript == 0) {
+    for (unsigned int i = 0; i < sizeof(defaultScript) / sizeof(defaultScript[0]); i++) {
+      script[numScript++] = defaultScript[i];
+    }
+  }
+  for (int i = 0; i < numScript; i++) {
+    if (!addRequest(script[i])) {
+      fprintf(stderr, "Bad request %s, use t_ms:Move or t_ms:/path?args\n", script[i]);
+      return 2;
+    }
+  }
+
+  simWorld.run();
+  simWorld.report(stdout);
+  if (maxSampleGap >= 0 && simWorld.maxSampleGap() > (uint64_t) maxSampleGap) {
+    printf("\nFAILED servo samples %.2f ms apart, more than --max-sample-gap\n", simWorld.maxSampleGap() / 1000.0);
+    return 1;
+  }
+  return simWorld.allBotsCommanded() ? 0 : 1;
+}
@@ -0,0 +1,89 @@
+/* SimBots.cpp
+ * UT Austin RAS Demobots
+ * The fleet simulator's bots, SIM_MAX_BOTS copies of the small dancebot firmware (see SimImage.h)
+ *
+ * They all run the same profile, so their joint angles can be compared with each other to measure how well they keep in sync.
+ * The small dancebot hops like the mothership does.
+ */
+
+#define DANCEBOT_PROFILE_SMALLBOT
+
+#undef SIM_IMAGE
+#define SIM_IMAGE bot1
+#include "SimImage.h"
+
+#undef SIM_IMAGE
+#define SIM_IMAGE bot2
+#include "SimImage.h"
+
+#undef SIM_IMAGE
+#define SIM_IMAGE bot3
+#include "SimImage.h"
+
+#undef SIM_IMAGE
+#define SIM_IMAGE bot4
+#include "SimImage.h"
+
+#undef SIM_IMAGE
+#define SIM_IMAGE bot5
+#include "SimImage.h"
+
+#undef SIM_IMAGE
+#define SIM_IMAGE bot6
+#include "SimImage.h"
+
+#undef SIM_IMAGE
+#define SIM_IMAGE bot7
+#include "SimImage.h"
+
+#undef SIM_IMAGE
+#define SIM_IMAGE bot8
+#include "SimImage.h"
+
+#undef SIM_IMAGE
+#define SIM_IMAGE bot9
+#include "SimImage.h"
+
+#undef SIM_IMAGE
+#define SIM_IMAGE bot10
+#include "SimImage.h"
+
+#undef SIM_IMAGE
+#define SIM_IMAGE bot11
+#include "SimImage.h"
+
+#undef SIM_IMAGE
+#define SIM_IMAGE bot12
+#include "SimImage.h"
+
+#undef SIM_IMAGE
+#define SIM_IMAGE bot13
+#include "SimImage.h"
+
+#undef SIM_IMAGE
+#define SIM_IMAGE bot14
+#include "SimImage.h"
+
+#undef SIM_IMAGE
+#define SIM_IMAGE bot15
+#include "SimImage.h"
+
+#undef SIM_IMAGE
+#define SIM_IMAGE bot16
+#include "SimImage.h"
+
+#undef SIM_IMAGE
+#define SIM_IMAGE bot17
+#include "SimImage.h"
+
+#undef SIM_IMAGE
+#define SIM_IMAGE bot18
+#include "SimImage.h"
+
+#undef SIM_IMAGE
+#define SIM_IMAGE bot19
+#include "SimImage.h"
+
+#undef SIM_IMAGE
+#define SIM_IMAGE bot20
+#include "SimImage.h"
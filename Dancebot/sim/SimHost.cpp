@@ -0,0 +1,554 @@
+/* SimHost.cpp
+ * UT Austin RAS Demobots
+ * The fleet simulator's Arduino and ESP-IDF stand-ins (sim/host), all of them act on the node that is running
+ */
+
+#include <stdarg.h>
+#include <stdlib.h>
+#include <Arduino.h>
+#include <WiFi.h>
+#include <ESPmDNS.h>
+#include <WebServer.h>
+#include <ESP32Servo.h>
+#include <esp_now.h>
+#include <esp_wifi.h>
+#include <esp_timer.h>
+#include <esp_system.h>
+#include <driver/i2s.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include "SimWorld.h"
+
+Print Serial;
+WiFiClass WiFi;
+MDNSResponder MDNS;
+
+
+//TIME
+
+unsigned long millis() {return simWorld.localClock() / 1000;}
+unsigned long micros() {return simWorld.localClock();}
+//in a task they let the node's loop() and timers run meanwhile, like the other core would
+static void sleepTask(uint64_t us);
+void delay(unsigned long ms) {sleepTask((uint64_t) ms * 1000);}
+void delayMicroseconds(unsigned int us) {sleepTask(us);}
+void yield() {}
+
+int64_t esp_timer_get_time() {return simWorld.localClock();}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* handle) {
+  SimTimer* timer = simWorld.createTimer(args->callback, args->arg);
+  if (timer == NULL) {
+    return ESP_ERR_NO_MEM;
+  }
+  *handle = (esp_timer_handle_t) timer;
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t handle, uint64_t period) {
+  SimTimer* timer = (SimTimer*) handle;
+  if (timer->running) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  timer->running = true;
+  timer->periodic = true;
+  timer->period = period;
+  simWorld.scheduleTimer(timer, simWorld.localClock() + period);
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t handle, uint64_t timeout) {
+  SimTimer* timer = (SimTimer*) handle;
+  if (timer->running) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  timer->running = true;
+  timer->periodic = false;
+  simWorld.scheduleTimer(timer, simWorld.localClock() + timeout);
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t handle) {
+  SimTimer* timer = (SimTimer*) handle;
+  if (!timer->running) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  timer->running = false;
+  return ESP_OK;
+}
+
+
+//FREERTOS
+
+//the task being started, makecontext() can only pass ints
+static SimTask* startingTask;
+
+static void taskMain() {
+  SimTask* task = startingTask;
+  task->function(task->arg);
+  simWorld.log("ERROR a task returned");
+  while (true) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+  }
+}
+
+//stop the running task until its wake timer goes off after us (0 = never), or a notification if notifications is set
+static void blockTask(SimTask* task, uint64_t us, bool notifications) {
+  esp_timer_stop((esp_timer_handle_t) task->wake);
+  if (us > 0) {esp_timer_start_once((esp_timer_handle_t) task->wake, us);}
+  task->waiting = notifications;
+  swapcontext(&task->context, &task->caller);
+  esp_timer_stop((esp_timer_handle_t) task->wake);
+}
+
+//outside a task the node's clock just moves on
+static void sleepTask(uint64_t us) {
+  SimNode* node = simWorld.current();
+  if (node != NULL && node->runningTask != NULL) {
+    if (us > 0) {blockTask(node->runningTask, us, false);}
+    return;
+  }
+  simWorld.advance(us);
+}
+
+//run a task until it waits again
+static void resumeTask(SimTask* task) {
+  SimNode* node = simWorld.current();
+  SimTask* resumer = node->runningTask;
+  node->runningTask = task;
+  task->waiting = false;
+  swapcontext(&task->caller, &task->context);
+  node->runningTask = resumer;
+}
+
+static void wakeTask(void* arg) {
+  resumeTask((SimTask*) arg);
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stackSize, void* arg,
+                                   int priority, TaskHandle_t* handle, BaseType_t core) {
+  SimNode* node = simWorld.current();
+  SimTask* task = NULL;
+  for (int i = 0; node != NULL && i < SIM_MAX_TASKS && task == NULL; i++) {
+    if (!node->tasks[i].used) {task = &node->tasks[i];}
+  }
+  SimTimer* wake = task == NULL ? NULL : simWorld.createTimer(wakeTask, task);
+  if (wake == NULL) {
+    return pdFALSE;
+  }
+  wake->pinned = core == APP_CPU_NUM;
+
+  task->used = true;
+  task->function = function;
+  task->arg = arg;
+  task->wake = wake;
+  task->stack = (char*) malloc(SIM_TASK_STACK);
+  getcontext(&task->context);
+  task->context.uc_stack.ss_sp = task->stack;
+  task->context.uc_stack.ss_size = SIM_TASK_STACK;
+  task->context.uc_link = NULL;
+  makecontext(&task->context, taskMain, 0);
+  if (handle != NULL) {*handle = task;}
+
+  startingTask = task;
+  resumeTask(task);
+  return pdPASS;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+  SimNode* node = simWorld.current();
+  if (node == NULL) {
+    return NULL;
+  }
+  return node->runningTask != NULL ? node->runningTask : &node->loopTask;
+}
+
+//the tick interrupts come on whole milliseconds, the wait ends on the wait-th one from now
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t wait) {
+  SimNode* node = simWorld.current();
+  SimTask* task = node->runningTask;
+  if (task == NULL) {
+    simWorld.log("ERROR ulTaskNotifyTake() outside a task");
+    return 0;
+  }
+  if (task->notified == 0 && wait != 0) {
+    blockTask(task, wait == portMAX_DELAY ? 0 : (simWorld.localClock() / 1000 + wait) * 1000 - simWorld.localClock(), true);
+  }
+  uint32_t notified = task->notified;
+  task->notified = clear ? 0 : (notified > 0 ? notified - 1 : 0);
+  return notified;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+  if (task == NULL || task == &simWorld.current()->loopTask) {
+    return pdPASS;
+  }
+  task->notified++;
+  if (task->waiting) {
+    resumeTask(task);
+  }
+  return pdPASS;
+}
+
+void vTaskDelay(TickType_t ticks) {
+  sleepTask((simWorld.localClock() / 1000 + ticks) * 1000 - simWorld.localClock());
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() {
+  SimMutex* mutex = new SimMutex;
+  mutex->depth = 0;
+  mutex->owner = NULL;
+  return mutex;
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t mutex, TickType_t wait) {
+  if (mutex->depth > 0 && mutex->owner != xTaskGetCurrentTaskHandle()) {
+    simWorld.log("ERROR took a mutex another task holds");
+  }
+  mutex->owner = xTaskGetCurrentTaskHandle();
+  mutex->depth++;
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t mutex) {
+  if (mutex->depth == 0) {
+    simWorld.log("ERROR gave a mutex that wasn't held");
+    return pdFALSE;
+  }
+  mutex->depth--;
+  return pdTRUE;
+}
+
+
+//PINS AND POWER
+
+void pinMode(int pin, int mode) {}
+void digitalWrite(int pin, int value) {}
+int digitalRead(int pin) {return LOW;}
+void adcAttachPin(int pin) {}
+
+//every analog pin reads the battery through the bots' voltage divider (see PowerController.cpp), with a little noise
+int analogRead(int pin) {
+  int adc = simWorld.getBatteryMillivolts() * 4095 / 10890 + (int) (simWorld.random() % 5) - 2;
+  return constrain(adc, 0, 4095);
+}
+
+uint32_t analogReadMilliVolts(int pin) {
+  return analogRead(pin) * 3300 / 4095;
+}
+
+bool setCpuFrequencyMhz(uint32_t mhz) {
+  SimNode* node = simWorld.current();
+  if (node != NULL) {node->cpuMhz = mhz;}
+  return true;
+}
+
+uint32_t getCpuFrequencyMhz() {
+  SimNode* node = simWorld.current();
+  return node == NULL ? 240 : node->cpuMhz;
+}
+
+esp_reset_reason_t esp_reset_reason() {return ESP_RST_POWERON;}
+
+
+//MATH
+
+long random(long max) {return max <= 0 ? 0 : simWorld.random() % max;}
+long random(long min, long max) {return max <= min ? min : min + random(max - min);}
+void randomSeed(unsigned long seed) {}
+
+long map(long x, long inMin, long inMax, long outMin, long outMax) {
+  return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+
+//SERIAL
+
+size_t Print::write(uint8_t c) {
+  SimNode* node = simWorld.current();
+  static char simLine[256];
+  static int simLineLength = 0;
+  char* line = node == NULL ? simLine : node->line;
+  int* length = node == NULL ? &simLineLength : &node->lineLength;
+
+  if (c == '\n' || *length == 255) {
+    line[*length] = 0;
+    simWorld.log(line);
+    *length = 0;
+  }
+  if (c != '\n' && c != '\r') {
+    line[(*length)++] = c;
+  }
+  return 1;
+}
+
+size_t Print::write(const uint8_t* data, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    write(data[i]);
+  }
+  return len;
+}
+
+void Print::print(long x, int base) {
+  char buf[40];
+  if (base == 16) {snprintf(buf, sizeof(buf), "%lx", x);}
+  else {snprintf(buf, sizeof(buf), "%ld", x);}
+  put(buf);
+}
+
+void Print::print(unsigned long x, int base) {
+  char buf[40];
+  if (base == 16) {snprintf(buf, sizeof(buf), "%lx", x);}
+  else {snprintf(buf, sizeof(buf), "%lu", x);}
+  put(buf);
+}
+
+void Print::printf(const char* format, ...) {
+  char buf[256];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(buf, sizeof(buf), format, args);
+  va_end(args);
+  put(buf);
+}
+
+
+//WIFI
+
+String WiFiClass::macAddress() {
+  uint8_t mac[6];
+  macAddress(mac);
+  char buf[18];
+  snprintf(buf, sizeof(buf), "%02X:%02X:%02X:%02X:%02X:%02X", mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+  return String(buf);
+}
+
+uint8_t* WiFiClass::macAddress(uint8_t* mac) {
+  SimNode* node = simWorld.current();
+  if (node == NULL) {memset(mac, 0, 6);}
+  else {memcpy(mac, node->mac, 6);}
+  return mac;
+}
+
+esp_err_t esp_wifi_set_ps(wifi_ps_type_t type) {return ESP_OK;}
+esp_err_t esp_wifi_connectionless_module_set_wake_interval(uint16_t interval) {return ESP_OK;}
+
+esp_err_t esp_wifi_set_promiscuous(bool enable) {
+  simWorld.current()->promiscuous = enable;
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_promiscuous_rx_cb(wifi_promiscuous_cb_t cb) {
+  simWorld.current()->promiscuousCallback = cb;
+  return ESP_OK;
+}
+
+
+//ESP-NOW
+
+esp_err_t esp_now_init() {
+  simWorld.current()->espNowInit = true;
+  return ESP_OK;
+}
+
+esp_err_t esp_now_deinit() {
+  SimNode* node = simWorld.current();
+  node->espNowInit = false;
+  node->numPeers = 0;
+  return ESP_OK;
+}
+
+esp_err_t esp_now_register_send_cb(esp_now_send_cb_t cb) {
+  simWorld.current()->sendCallback = cb;
+  return ESP_OK;
+}
+
+esp_err_t esp_now_register_recv_cb(esp_now_recv_cb_t cb) {
+  simWorld.current()->recvCallback = cb;
+  return ESP_OK;
+}
+
+esp_err_t esp_now_add_peer(const esp_now_peer_info_t* peer) {
+  SimNode* node = simWorld.current();
+  if (!node->espNowInit) {
+    return ESP_ERR_ESPNOW_NOT_INIT;
+  }
+  if (simWorld.isPeer(node, peer->peer_addr)) {
+    return ESP_ERR_ESPNOW_EXIST;
+  }
+  if (node->numPeers == ESP_NOW_MAX_TOTAL_PEER_NUM) {
+    return ESP_ERR_ESPNOW_FULL;
+  }
+  memcpy(node->peers[node->numPeers++], peer->peer_addr, 6);
+  return ESP_OK;
+}
+
+esp_err_t esp_now_del_peer(const uint8_t* peer_addr) {
+  SimNode* node = simWorld.current();
+  for (int i = 0; i < node->numPeers; i++) {
+    if (memcmp(node->peers[i], peer_addr, 6) == 0) {
+      memcpy(node->peers[i], node->peers[--node->numPeers], 6);
+      return ESP_OK;
+    }
+  }
+  return ESP_ERR_ESPNOW_NOT_FOUND;
+}
+
+bool esp_now_is_peer_exist(const uint8_t* peer_addr) {
+  return simWorld.isPeer(simWorld.current(), peer_addr);
+}
+
+esp_err_t esp_now_send(const uint8_t* peer_addr, const uint8_t* data, size_t len) {
+  return simWorld.send(peer_addr, data, len);
+}
+
+esp_err_t esp_now_set_wake_window(uint16_t window) {return ESP_OK;}
+
+
+//I2S
+
+//no microphone in the simulator, the mothership runs without music
+esp_err_t i2s_driver_install(i2s_port_t port, const i2s_config_t* config, int queue_size, void* queue) {return ESP_FAIL;}
+esp_err_t i2s_driver_uninstall(i2s_port_t port) {return ESP_OK;}
+esp_err_t i2s_set_pin(i2s_port_t port, const i2s_pin_config_t* pins) {return ESP_FAIL;}
+
+esp_err_t i2s_read(i2s_port_t port, void* dest, size_t size, size_t* bytes_read, uint32_t ticks_to_wait) {
+  *bytes_read = 0;
+  return ESP_FAIL;
+}
+
+
+//SERVOS
+
+Servo::Servo() {
+  pin = -1;
+  minUs = 544;
+  maxUs = 2400;
+  angle = 90;
+}
+
+int Servo::attach(int _pin, int _minUs, int _maxUs) {
+  pin = _pin;
+  minUs = _minUs;
+  maxUs = _maxUs;
+  return 1;
+}
+
+void Servo::detach() {pin = -1;}
+bool Servo::attached() {return pin != -1;}
+int Servo::read() {return angle;}
+
+void Servo::write(int _angle) {
+  if (pin == -1) {
+    return;
+  }
+  angle = constrain(_angle, 0, 180);
+  simWorld.servoWrite(pin, angle);
+}
+
+void Servo::writeMicroseconds(int us) {
+  write(map(constrain(us, minUs, maxUs), minUs, maxUs, 0, 180));
+}
+
+
+//WEB SERVER
+
+WebServer::WebServer(int port) {
+  numHandlers = 0;
+  notFound = NULL;
+  lastRequest = NULL;
+  requestMethod = HTTP_GET;
+  numArgs = 0;
+}
+
+void WebServer::on(const char* uri, HTTPMethod method, THandlerFunction handler) {
+  if (numHandlers == WEBSERVER_MAX_HANDLERS) {
+    return;
+  }
+  handlers[numHandlers].uri = uri;
+  handlers[numHandlers].method = method;
+  handlers[numHandlers].handler = handler;
+  numHandlers++;
+}
+
+String WebServer::arg(const char* name) {
+  for (int i = 0; i < numArgs; i++) {
+    if (argNames[i] == name) {
+      return argValues[i];
+    }
+  }
+  return String();
+}
+
+bool WebServer::hasArg(const char* name) {
+  for (int i = 0; i < numArgs; i++) {
+    if (argNames[i] == name) {
+      return true;
+    }
+  }
+  return false;
+}
+
+//decode one url encoded argument name or value
+static String urlDecode(const char* s, int len) {
+  String decoded;
+  for (int i = 0; i < len; i++) {
+    if (s[i] == '+') {
+      decoded += ' ';
+    }
+    else if (s[i] == '%' && i + 2 < len) {
+      char hex[3] = {s[i + 1], s[i + 2], 0};
+      decoded += (char) strtol(hex, NULL, 16);
+      i += 2;
+    }
+    else {
+      decoded += s[i];
+    }
+  }
+  return decoded;
+}
+
+void WebServer::handleClient() {
+  SimRequest* request = simWorld.nextRequest();
+  if (request == NULL) {
+    return;
+  }
+
+  //split "/path?a=1&b=2"
+  const char* query = strchr(request->uri, '?');
+  int pathLength = query == NULL ? strlen(request->uri) : query - request->uri;
+  requestUri = String(std::string(request->uri, pathLength));
+  requestMethod = request->post ? HTTP_POST : HTTP_GET;
+  numArgs = 0;
+  while (query != NULL && numArgs < WEBSERVER_MAX_ARGS) {
+    const char* start = query + 1;
+    query = strchr(start, '&');
+    int length = query == NULL ? strlen(start) : query - start;
+    const char* equals = (const char*) memchr(start, '=', length);
+    int nameLength = equals == NULL ? length : equals - start;
+    argNames[numArgs] = urlDecode(start, nameLength);
+    argValues[numArgs] = equals == NULL ? String() : urlDecode(equals + 1, length - nameLength - 1);
+    numArgs++;
+  }
+
+  lastRequest = request;
+  simWorld.requestStarted(request);
+  for (int i = 0; i < numHandlers; i++) {
+    if (handlers[i].uri == requestUri && (handlers[i].method == HTTP_ANY || handlers[i].method == requestMethod)) {
+      handlers[i].handler();
+      return;
+    }
+  }
+  if (notFound != NULL) {
+    notFound();
+  }
+}
+
+void WebServer::send(int code, const char* contentType, const String& content) {
+  simWorld.requestHandled(lastRequest, code, code == 200 ? "" : content.c_str());
+}
+
+void WebServer::send_P(int code, const char* contentType, const char* content, size_t len) {
+  simWorld.requestHandled(lastRequest, code, "");
+}
@@ -0,0 +1,82 @@
+/* SimImage.h
+ * UT Austin RAS Demobots
+ * One whole firmware image for the fleet simulator, in its own namespace
+ *
+ * Define SIM_IMAGE (the namespace and node name) and a DANCEBOT_PROFILE_ before including this,
+ * every include gives another node with its own copy of the firmware's globals (see SimBots.cpp).
+ * There is no include guard on purpose, and the firmware's own guards are cleared below so
+ * its headers are read again inside each namespace. Add the guard of any new header in src to the list.
+ */
+
+//the host stand-ins and the C library stay outside the namespaces
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WiFiClient.h>
+#include <WebServer.h>
+#include <ESPmDNS.h>
+#include <ESP32Servo.h>
+#include <Adafruit_NeoPixel.h>
+#include <esp_err.h>
+#include <esp_now.h>
+#include <esp_wifi.h>
+#include <esp_timer.h>
+#include <esp_system.h>
+#include <driver/i2s.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include "SimWorld.h"
+
+#undef HARDWAREPROFILE
+#undef MESSAGES
+#undef TRACERECORDER
+#undef LOOPSCHEDULER
+#undef BEATCLOCK
+#undef BEATTRACKER
+#undef MICROPHONE
+#undef KINEMATICS
+#undef MOVEALGEBRA
+#undef OSCILLATOR
+#undef DANCINGSERVOS
+#undef POWERCONTROLLER
+#undef ROUTINESTORE
+#undef TRIMSTORE
+#undef RELIABLELINK
+#undef FLEETREGISTRY
+#undef FLEETTELEMETRY
+#undef BOTCONTROLLER
+#undef WEBCONTROLLER
+
+#define SIM_STRING(x) SIM_STRING2(x)
+#define SIM_STRING2(x) #x
+#define SIM_REGISTRAR(x) SIM_REGISTRAR2(x)
+#define SIM_REGISTRAR2(x) x##Registrar
+
+namespace SIM_IMAGE {
+#include "../src/TraceRecorder.cpp"
+#include "../src/LoopScheduler.cpp"
+#include "../src/BeatClock.cpp"
+#include "../src/BeatTracker.cpp"
+#include "../src/Microphone.cpp"
+#include "../src/Kinematics.cpp"
+#include "../src/Oscillator.cpp"
+#include "../src/DancingServos.cpp"
+#include "../src/PowerController.cpp"
+#include "../src/RoutineStore.cpp"
+#include "../src/TrimStore.cpp"
+#include "../src/ReliableLink.cpp"
+#include "../src/FleetRegistry.cpp"
+#include "../src/FleetTelemetry.cpp"
+#include "../src/WebController.cpp"
+#include "../src/BotController.cpp"
+#include "../src/DemobotLegsESP32.ino"
+}
+
+static SimImageRegistrar SIM_REGISTRAR(SIM_IMAGE)(SIM_STRING(SIM_IMAGE), SIM_IMAGE::setup, SIM_IMAGE::loop,
+                                                 SIM_IMAGE::dancebotProfile.pins, IS_MOTHERSHIP);
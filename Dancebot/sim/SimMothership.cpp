@@ -0,0 +1,8 @@
+/* SimMothership.cpp
+ * UT Austin RAS Demobots
+ * The fleet simulator's mothership, node 0 (see SimImage.h)
+ */
+
+#define DANCEBOT_PROFILE_MOTHERSHIP
+#define SIM_IMAGE mothership
+#include "SimImage.h"
@@ -0,0 +1,747 @@
+/* SimWorld.cpp
+ * UT Austin RAS Demobots
+ * Fleet simulator clock, radio and recorders, see SimWorld.h
+ */
+
+#include <string.h>
+#include <math.h>
+#include "SimWorld.h"
+#include "Messages.h"
+
+SimWorld simWorld;
+
+//IMAGES
+
+//function static so images in other files can register before main()
+static SimImage* getImages(int** numImages) {
+  static SimImage images[SIM_MAX_NODES];
+  static int count = 0;
+  *numImages = &count;
+  return images;
+}
+
+SimImageRegistrar::SimImageRegistrar(const char* name, void (*setup)(), void (*loop)(), const int* pins, bool isMothership) {
+  int* numImages;
+  SimImage* images = getImages(&numImages);
+  if (*numImages == SIM_MAX_NODES) {
+    return;
+  }
+  SimImage* image = &images[(*numImages)++];
+  image->name = name;
+  image->setup = setup;
+  image->loop = loop;
+  image->pins = pins;
+  image->isMothership = isMothership;
+}
+
+
+//SETUP
+
+SimWorld::SimWorld() {
+  numNodes = 0;
+  currentNode = -1;
+  now = 0;
+  rng = 0;
+  numFrames = 0;
+  frameOrder = 0;
+  framesDropped = 0;
+  numEvents = 0;
+  nextEvent = 0;
+  numCommands = 0;
+  nextSyncSample = 0;
+}
+
+bool SimWorld::begin(const SimConfig* _config) {
+  config = *_config;
+
+  //splitmix64 to spread the seed over the generator's state
+  rng = config.seed + 0x9E3779B97F4A7C15ull;
+  rng = (rng ^ (rng >> 30)) * 0xBF58476D1CE4E5B9ull;
+  rng = (rng ^ (rng >> 27)) * 0x94D049BB133111EBull;
+  rng = rng ^ (rng >> 31);
+  if (rng == 0) {rng = 1;}
+
+  int* numImages;
+  SimImage* images = getImages(&numImages);
+  const SimImage* mothership = NULL;
+  const SimImage* bots[SIM_MAX_BOTS];
+  int numBots = 0;
+  for (int i = 0; i < *numImages; i++) {
+    if (images[i].isMothership) {mothership = &images[i];}
+    else if (numBots < SIM_MAX_BOTS) {bots[numBots++] = &images[i];}
+  }
+  if (mothership == NULL || config.numBots < 0 || config.numBots > numBots) {
+    fprintf(stderr, "Only %d bot images (SIM_MAX_BOTS %d), asked for %d\n", numBots, SIM_MAX_BOTS, config.numBots);
+    return false;
+  }
+
+  numNodes = config.numBots + 1;
+  for (int id = 0; id < numNodes; id++) {
+    SimNode* node = &nodes[id];
+    memset(node, 0, sizeof(SimNode));
+    node->image = id == 0 ? mothership : bots[id - 1];
+    //Espressif's OUI, the last byte is the node id
+    uint8_t mac[6] = {0x24, 0x0A, 0xC4, 0x00, 0x00, (uint8_t) id};
+    memcpy(node->mac, mac, 6);
+    node->bootUs = id == 0 || config.bootSpreadUs == 0 ? 0 : random() % config.bootSpreadUs;
+    node->clockPpm = id == 0 || config.clockPpm == 0 ? 0 : (int) (random() % (2 * config.clockPpm + 1)) - config.clockPpm;
+    node->cpuMhz = 240;
+
+    for (int i = 0; i < SIM_MAX_JOINTS; i++) {
+      node->pins[i] = i < 4 ? node->image->pins[i] : -1;
+      node->angles[i] = -1;
+    }
+
+    if (config.traceDir != NULL) {
+      char path[256];
+      snprintf(path, sizeof(path), "%s/%s.csv", config.traceDir, node->image->name);
+      node->trace = fopen(path, "w");
+      if (node->trace == NULL) {
+        fprintf(stderr, "Could not open %s\n", path);
+        return false;
+      }
+      fprintf(node->trace, "t_us,joint,angle\n");
+    }
+  }
+  return true;
+}
+
+bool SimWorld::request(uint64_t t, int node, const char* uri, bool post) {
+  if (numEvents == SIM_MAX_COMMANDS * 2 || node < 0 || node >= numNodes) {
+    return false;
+  }
+  //keep the events sorted by time, same times in the order they were added
+  int i = numEvents++;
+  while (i > 0 && events[i - 1].t > t) {
+    events[i] = events[i - 1];
+    i--;
+  }
+  events[i].t = t;
+  events[i].node = node;
+  snprintf(events[i].request.uri, sizeof(events[i].request.uri), "%s", uri);
+  events[i].request.post = post;
+  return true;
+}
+
+
+//MAIN LOOP
+
+//run every node until durationUs, one event at a time in time order
+//ties go to web requests, then frames, then timers, then loop() calls by node id
+void SimWorld::run() {
+  while (true) {
+    uint64_t t = config.durationUs;
+    int kind = -1;
+    int which = -1;
+    SimTimer* timer = NULL;
+
+    if (nextEvent < numEvents && events[nextEvent].t < t) {
+      t = events[nextEvent].t;
+      kind = 0;
+    }
+    if (numFrames > 0 && frames[0].t < t) {
+      t = frames[0].t;
+      kind = 1;
+    }
+    for (int id = 0; id < numNodes; id++) {
+      if (!nodes[id].booted) {continue;}
+      for (int i = 0; i < SIM_MAX_TIMERS; i++) {
+        SimTimer* candidate = &nodes[id].timers[i];
+        if (candidate->running && candidate->fire < t) {
+          t = candidate->fire;
+          kind = 2;
+          which = id;
+          timer = candidate;
+        }
+      }
+    }
+    for (int id = 0; id < numNodes; id++) {
+      uint64_t next = nodes[id].booted ? nodes[id].nextLoopUs : nodes[id].bootUs;
+      if (next < t) {
+        t = next;
+        kind = 3;
+        which = id;
+      }
+    }
+    if (kind == -1) {
+      break;
+    }
+
+    while (nextSyncSample <= t) {
+      now = nextSyncSample;
+      sampleSync();
+      nextSyncSample += SIM_SYNC_SAMPLE_US;
+    }
+    now = t;
+
+    if (kind == 0) {
+      SimEvent* event = &events[nextEvent++];
+      SimNode* node = &nodes[event->node];
+      int next = (node->requestTail + 1) % SIM_MAX_REQUESTS;
+      if (next != node->requestHead) {
+        node->requests[node->requestTail] = event->request;
+        node->requestTail = next;
+      }
+    }
+    else if (kind == 1) {
+      SimFrame frame;
+      popFrame(&frame);
+      deliver(&frame);
+    }
+    else if (kind == 2) {
+      runTimer(which, timer);
+    }
+    else if (nodes[which].booted) {
+      runLoop(which);
+    }
+    else {
+      bootNode(which);
+    }
+  }
+  now = config.durationUs;
+
+  for (int id = 0; id < numNodes; id++) {
+    if (nodes[id].trace != NULL) {
+      fclose(nodes[id].trace);
+      nodes[id].trace = NULL;
+    }
+  }
+}
+
+//the node's clock carries on from the last call, delay() moves it forward
+bool SimWorld::runAs(const char* image, void (*function)()) {
+  for (int id = 0; id < numNodes; id++) {
+    if (strcmp(nodes[id].image->name, image) == 0) {
+      enter(id, now);
+      function();
+      now = nodes[id].clock;
+      leave();
+      return true;
+    }
+  }
+  return false;
+}
+
+void SimWorld::enter(int id, uint64_t t) {
+  currentNode = id;
+  nodes[id].clock = t;
+}
+
+void SimWorld::leave() {
+  currentNode = -1;
+}
+
+void SimWorld::bootNode(int id) {
+  SimNode* node = &nodes[id];
+  node->booted = true;
+  enter(id, now);
+  node->image->setup();
+  node->nextLoopUs = node->clock + config.loopUs;
+  leave();
+}
+
+void SimWorld::runLoop(int id) {
+  SimNode* node = &nodes[id];
+  enter(id, now);
+  node->image->loop();
+  node->nextLoopUs = node->clock + config.loopUs;
+  leave();
+}
+
+void SimWorld::runTimer(int id, SimTimer* timer) {
+  enter(id, now);
+  if (timer->periodic) {scheduleTimer(timer, timer->next + timer->period);}
+  else {timer->running = false;}
+  timer->callback(timer->arg);
+  leave();
+}
+
+
+//RADIO
+
+uint32_t SimWorld::random() {
+  //xorshift64*
+  rng ^= rng >> 12;
+  rng ^= rng << 25;
+  rng ^= rng >> 27;
+  return (rng * 0x2545F4914F6CDD1Dull) >> 32;
+}
+
+uint64_t SimWorld::frameDelay() {
+  uint64_t delay = config.latencyUs + (config.jitterUs == 0 ? 0 : random() % (config.jitterUs + 1));
+  if (config.reorderPercent > 0 && (int) (random() % 100) < config.reorderPercent) {
+    delay += config.latencyUs + config.jitterUs + SIM_RETRY_US;
+  }
+  return delay;
+}
+
+int SimWorld::findNode(const uint8_t* mac) {
+  for (int id = 0; id < numNodes; id++) {
+    if (memcmp(nodes[id].mac, mac, 6) == 0) {
+      return id;
+    }
+  }
+  return -1;
+}
+
+bool SimWorld::isPeer(SimNode* node, const uint8_t* mac) {
+  for (int i = 0; i < node->numPeers; i++) {
+    if (memcmp(node->peers[i], mac, 6) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+//the same for every run, between -35 and -74 dBm
+int8_t SimWorld::linkRssi(int from, int to) {
+  return -35 - (from * 31 + to * 17) % 40;
+}
+
+//esp_now_send() for the current node
+esp_err_t SimWorld::send(const uint8_t* mac, const uint8_t* data, size_t length) {
+  SimNode* node = current();
+  if (node == NULL || !node->espNowInit) {
+    return ESP_ERR_ESPNOW_NOT_INIT;
+  }
+  if (length == 0 || length > ESP_NOW_MAX_DATA_LEN) {
+    return ESP_ERR_ESPNOW_ARG;
+  }
+  //NULL sends to every peer
+  if (mac == NULL) {
+    esp_err_t result = ESP_OK;
+    for (int i = 0; i < node->numPeers; i++) {
+      if (send(node->peers[i], data, length) != ESP_OK) {result = ESP_FAIL;}
+    }
+    return result;
+  }
+  if (!isPeer(node, mac)) {
+    return ESP_ERR_ESPNOW_NOT_FOUND;
+  }
+
+  SimFrame frame;
+  frame.from = currentNode;
+  frame.length = length;
+  memcpy(frame.data, data, length);
+  node->framesSent++;
+
+  //follow the mothership's dance move commands for the sync report
+  if (currentNode == 0 && numCommands > 0 && commands[numCommands - 1].seq == 0 && length == sizeof(struct_message)) {
+    const struct_message* message = (const struct_message*) data;
+    if ((message->status == None || message->status == QueueMove) && message->seq != 0) {
+      commands[numCommands - 1].seq = message->seq;
+    }
+  }
+
+  static const uint8_t broadcast[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+  if (memcmp(mac, broadcast, 6) == 0) {
+    for (int to = 0; to < numNodes; to++) {
+      if (to == currentNode) {continue;}
+      if ((int) (random() % 100) < config.lossPercent) {
+        nodes[to].framesLost++;
+        continue;
+      }
+      frame.t = node->clock + frameDelay();
+      frame.sendStatus = false;
+      frame.to = to;
+      queueFrame(&frame);
+    }
+    //broadcasts aren't acked, the callback always says they went out
+    frame.t = node->clock + config.latencyUs;
+    frame.sendStatus = true;
+    frame.success = true;
+    frame.to = currentNode;
+    queueFrame(&frame);
+    return ESP_OK;
+  }
+
+  //the radio retries a unicast until the receiver acks it
+  int to = findNode(mac);
+  uint64_t t = node->clock;
+  frame.success = false;
+  for (int i = 0; i < SIM_UNICAST_TRIES && to != -1; i++) {
+    if ((int) (random() % 100) < config.lossPercent) {
+      nodes[to].framesLost++;
+      t += SIM_RETRY_US;
+      continue;
+    }
+    frame.t = t + frameDelay();
+    frame.sendStatus = false;
+    frame.to = to;
+    queueFrame(&frame);
+    frame.success = true;
+    t = frame.t;
+    break;
+  }
+  frame.t = frame.success ? t : t + config.latencyUs;
+  frame.sendStatus = true;
+  frame.to = currentNode;
+  queueFrame(&frame);
+  return ESP_OK;
+}
+
+void SimWorld::deliver(SimFrame* frame) {
+  SimNode* node = &nodes[frame->to];
+  SimNode* from = &nodes[frame->from];
+  if (!node->booted) {
+    return;
+  }
+  enter(frame->to, now);
+
+  if (frame->sendStatus) {
+    if (node->sendCallback != NULL) {
+      //the callback gets the address the frame was sent to, close enough for the firmware's logging
+      node->sendCallback(node->mac, frame->success ? ESP_NOW_SEND_SUCCESS : ESP_NOW_SEND_FAIL);
+    }
+    leave();
+    return;
+  }
+  if (!node->espNowInit) {
+    leave();
+    return;
+  }
+
+  node->framesReceived++;
+  if (node->promiscuous && node->promiscuousCallback != NULL) {
+    //802.11 action frame header, the sender's MAC is the second address
+    static uint8_t buffer[sizeof(wifi_promiscuous_pkt_t) + 24 + ESP_NOW_MAX_DATA_LEN];
+    memset(buffer, 0, sizeof(buffer));
+    wifi_promiscuous_pkt_t* pkt = (wifi_promiscuous_pkt_t*) buffer;
+    pkt->rx_ctrl.rssi = linkRssi(frame->from, frame->to);
+    memcpy(pkt->payload + 4, node->mac, 6);
+    memcpy(pkt->payload + 10, from->mac, 6);
+    memcpy(pkt->payload + 24, frame->data, frame->length);
+    node->promiscuousCallback(buffer, WIFI_PKT_MGMT);
+  }
+
+  //a bot got the last dance move command, its first servo write after this is when it started
+  if (frame->from == 0 && frame->length == sizeof(struct_message)) {
+    const struct_message* message = (const struct_message*) frame->data;
+    for (int i = numCommands - 1; i >= 0; i--) {
+      if (commands[i].seq != 0 && commands[i].seq == message->seq) {
+        if (commands[i].armed[frame->to] == 0) {commands[i].armed[frame->to] = now;}
+        break;
+      }
+    }
+  }
+
+  if (node->recvCallback != NULL) {
+    node->recvCallback(from->mac, frame->data, frame->length);
+  }
+  leave();
+}
+
+void SimWorld::queueFrame(const SimFrame* frame) {
+  if (numFrames == SIM_MAX_FRAMES) {
+    framesDropped++;
+    return;
+  }
+  int i = numFrames++;
+  frames[i] = *frame;
+  frames[i].order = frameOrder++;
+  //sift up
+  while (i > 0) {
+    int parent = (i - 1) / 2;
+    SimFrame* a = &frames[parent];
+    SimFrame* b = &frames[i];
+    if (a->t < b->t || (a->t == b->t && a->order < b->order)) {break;}
+    SimFrame swap = *a;
+    *a = *b;
+    *b = swap;
+    i = parent;
+  }
+}
+
+void SimWorld::popFrame(SimFrame* frame) {
+  *frame = frames[0];
+  frames[0] = frames[--numFrames];
+  //sift down
+  int i = 0;
+  while (true) {
+    int smallest = i;
+    for (int child = 2 * i + 1; child <= 2 * i + 2 && child < numFrames; child++) {
+      SimFrame* a = &frames[child];
+      SimFrame* b = &frames[smallest];
+      if (a->t < b->t || (a->t == b->t && a->order < b->order)) {smallest = child;}
+    }
+    if (smallest == i) {break;}
+    SimFrame swap = frames[i];
+    frames[i] = frames[smallest];
+    frames[smallest] = swap;
+    i = smallest;
+  }
+}
+
+
+//HOST STAND-IN HOOKS
+
+SimNode* SimWorld::current() {
+  return currentNode == -1 ? NULL : &nodes[currentNode];
+}
+
+uint64_t SimWorld::clock() {
+  return currentNode == -1 ? now : nodes[currentNode].clock;
+}
+
+uint64_t SimWorld::localClock() {
+  SimNode* node = current();
+  return node == NULL ? now : toLocal(node, node->clock);
+}
+
+uint64_t SimWorld::toLocal(SimNode* node, uint64_t t) {
+  if (node == NULL || node->clockPpm == 0) {
+    return t;
+  }
+  return t + (int64_t) t * node->clockPpm / 1000000;
+}
+
+//the first time on the simulator's clock that the node's clock reads local, so a timer never goes off early and stalls
+uint64_t SimWorld::toGlobal(SimNode* node, uint64_t local) {
+  if (node == NULL || node->clockPpm == 0) {
+    return local;
+  }
+  uint64_t t = local - (int64_t) local * node->clockPpm / 1000000;
+  while (toLocal(node, t) < local) {t++;}
+  return t;
+}
+
+void SimWorld::advance(uint64_t us) {
+  if (currentNode != -1) {
+    nodes[currentNode].clock += us - (int64_t) us * nodes[currentNode].clockPpm / 1000000;
+  }
+}
+
+int SimWorld::getBatteryMillivolts() {
+  return config.batteryMillivolts;
+}
+
+SimTimer* SimWorld::createTimer(esp_timer_cb_t callback, void* arg) {
+  SimNode* node = current();
+  if (node == NULL) {
+    return NULL;
+  }
+  for (int i = 0; i < SIM_MAX_TIMERS; i++) {
+    if (!node->timers[i].used) {
+      SimTimer* timer = &node->timers[i];
+      memset(timer, 0, sizeof(SimTimer));
+      timer->used = true;
+      timer->callback = callback;
+      timer->arg = arg;
+      return timer;
+    }
+  }
+  return NULL;
+}
+
+//the timer is due at t on the node's clock, it runs up to timerJitterUs after that
+void SimWorld::scheduleTimer(SimTimer* timer, uint64_t t) {
+  timer->next = t;
+  timer->fire = toGlobal(current(), t) + (config.timerJitterUs == 0 || timer->pinned ? 0 : random() % (config.timerJitterUs + 1));
+}
+
+SimRequest* SimWorld::nextRequest() {
+  SimNode* node = current();
+  if (node == NULL || node->requestHead == node->requestTail) {
+    return NULL;
+  }
+  SimRequest* request = &node->requests[node->requestHead];
+  node->requestHead = (node->requestHead + 1) % SIM_MAX_REQUESTS;
+  return request;
+}
+
+//a dance move request to the mothership is followed from before its handler sends the command
+void SimWorld::requestStarted(const SimRequest* request) {
+  SimNode* node = current();
+  if (currentNode == 0 && strncmp(request->uri, "/danceM", 7) == 0 && numCommands < SIM_MAX_COMMANDS) {
+    SimCommand* command = &commands[numCommands++];
+    memset(command, 0, sizeof(SimCommand));
+    snprintf(command->uri, sizeof(command->uri), "%s", request->uri);
+    command->handled = node->clock;
+    command->armed[0] = node->clock;
+  }
+}
+
+void SimWorld::requestHandled(const SimRequest* request, int code, const char* content) {
+  SimNode* node = current();
+  if (code == 200) {
+    return;
+  }
+  node->httpErrors++;
+  fprintf(stderr, "%10.3f %s: %s returned %d %s\n", node->clock / 1000.0, node->image->name, request->uri, code, content);
+  if (currentNode == 0 && numCommands > 0 && commands[numCommands - 1].handled == node->clock &&
+      strcmp(commands[numCommands - 1].uri, request->uri) == 0) {
+    numCommands--;
+  }
+}
+
+void SimWorld::servoWrite(int pin, int angle) {
+  SimNode* node = current();
+  if (node == NULL) {
+    return;
+  }
+  node->servoWrites++;
+
+  int joint = -1;
+  for (int i = 0; i < SIM_MAX_JOINTS; i++) {
+    if (node->pins[i] == pin) {
+      joint = i;
+      break;
+    }
+    if (node->pins[i] == -1) {
+      node->pins[i] = pin;      //the hat, or anything else
+      joint = i;
+      break;
+    }
+  }
+  if (joint == -1) {
+    return;
+  }
+  node->angles[joint] = angle;
+  writeTrace(node, joint, angle);
+
+  if (joint == 0) {
+    uint64_t gap = node->clock - node->lastSample;
+    if (node->lastSample != 0 && gap < SIM_TICK_GAP_US) {
+      if (node->sampleMin == 0 || gap < node->sampleMin) {node->sampleMin = gap;}
+      if (gap > node->sampleMax) {node->sampleMax = gap;}
+    }
+    measureTick(node);
+    node->lastSample = node->clock;
+  }
+
+  for (int i = 0; i < numCommands; i++) {
+    SimCommand* command = &commands[i];
+    if (command->armed[currentNode] != 0 && command->moved[currentNode] == 0) {
+      command->moved[currentNode] = node->clock;
+    }
+  }
+}
+
+//a bot's sample against the mothership's samples, once both are moving and have had half the run to settle
+void SimWorld::measureTick(SimNode* node) {
+  SimNode* mothership = &nodes[0];
+  if (node == mothership || node->clock < config.durationUs / 2 || mothership->lastSample == 0 ||
+      node->clock - mothership->lastSample > SIM_TICK_GAP_US) {
+    return;
+  }
+  //the mothership's last sample can be up to a frame before, or right after when this one is early
+  int64_t offset = (int64_t) ((node->clock - mothership->lastSample) % SIM_FRAME_US);
+  if (offset > SIM_FRAME_US / 2) {offset -= SIM_FRAME_US;}
+  uint64_t error = offset < 0 ? -offset : offset;
+  node->tickErrorSum += error;
+  if (error > node->tickErrorMax) {node->tickErrorMax = error;}
+  node->tickErrors++;
+}
+
+void SimWorld::writeTrace(SimNode* node, int joint, int angle) {
+  if (node->trace == NULL) {
+    return;
+  }
+  static const char* jointNames[4] = {"hipL", "hipR", "ankleL", "ankleR"};
+  if (joint < 4) {
+    fprintf(node->trace, "%llu,%s,%d\n", (unsigned long long) node->clock, jointNames[joint], angle);
+  }
+  else {
+    fprintf(node->trace, "%llu,pin%d,%d\n", (unsigned long long) node->clock, node->pins[joint], angle);
+  }
+}
+
+void SimWorld::log(const char* line) {
+  if (config.verbose) {
+    SimNode* node = current();
+    printf("%10.3f %s: %s\n", clock() / 1000.0, node == NULL ? "sim" : node->image->name, line);
+  }
+}
+
+
+//REPORT
+
+bool SimWorld::allBotsCommanded() {
+  for (int id = 1; id < numNodes; id++) {
+    bool commanded = false;
+    for (int i = 0; i < numCommands; i++) {
+      if (commands[i].armed[id] != 0) {commanded = true;}
+    }
+    if (!commanded) {
+      return false;
+    }
+  }
+  return true;
+}
+
+uint64_t SimWorld::maxSampleGap() {
+  uint64_t worst = 0;
+  for (int id = 0; id < numNodes; id++) {
+    if (nodes[id].sampleMax > worst) {worst = nodes[id].sampleMax;}
+  }
+  return worst;
+}
+
+//compare each bot's legs with the first bot's, they run the same profile so their angles should match
+void SimWorld::sampleSync() {
+  if (numNodes < 3) {
+    return;
+  }
+  SimNode* reference = &nodes[1];
+  for (int id = 2; id < numNodes; id++) {
+    SimNode* node = &nodes[id];
+    for (int i = 0; i < 4; i++) {
+      if (node->angles[i] == -1 || reference->angles[i] == -1) {continue;}
+      double difference = node->angles[i] - reference->angles[i];
+      node->syncSquares += difference * difference;
+      node->syncSamples++;
+    }
+  }
+}
+
+void SimWorld::report(FILE* out) {
+  fprintf(out, "%d bots, %.1f s, seed %u, latency %u+%u us, loss %d%%, reorder %d%%, timer jitter %u us, clocks within %d ppm\n",
+          numNodes - 1, config.durationUs / 1e6, config.seed, config.latencyUs, config.jitterUs, config.lossPercent, config.reorderPercent,
+          config.timerJitterUs, config.clockPpm);
+  if (framesDropped > 0) {
+    fprintf(out, "WARNING %lu frames dropped, more than SIM_MAX_FRAMES in the air\n", framesDropped);
+  }
+
+  //sample_ms: shortest and longest time between servo samples while moving, a move that interrupts another starts with a short one
+  //tick_ms: average and worst time between a bot's samples and the mothership's, over the second half of the run
+  fprintf(out, "\n%-12s %8s %8s %8s %8s %8s %13s %10s %13s %6s\n", "node", "sent", "received", "lost", "writes", "http_err", "sample_ms",
+          "rms_deg", "tick_ms", "ppm");
+  for (int id = 0; id < numNodes; id++) {
+    SimNode* node = &nodes[id];
+    fprintf(out, "%-12s %8lu %8lu %8lu %8lu %8lu", node->image->name, node->framesSent, node->framesReceived,
+            node->framesLost, node->servoWrites, node->httpErrors);
+    if (node->sampleMax > 0) {fprintf(out, " %6.2f-%6.2f", node->sampleMin / 1000.0, node->sampleMax / 1000.0);}
+    else {fprintf(out, " %13s", "-");}
+    if (node->syncSamples > 0) {fprintf(out, " %10.2f", sqrt(node->syncSquares / node->syncSamples));}
+    else {fprintf(out, " %10s", "-");}
+    if (node->tickErrors > 0) {fprintf(out, " %6.2f-%6.2f", node->tickErrorSum / node->tickErrors / 1000.0, node->tickErrorMax / 1000.0);}
+    else {fprintf(out, " %13s", "-");}
+    fprintf(out, " %6d\n", node->clockPpm);
+  }
+
+  //how long after the mothership each bot started each move
+  fprintf(out, "\n%-40s %10s %6s %12s %12s\n", "command", "t_ms", "bots", "skew_avg_ms", "skew_max_ms");
+  for (int i = 0; i < numCommands; i++) {
+    SimCommand* command = &commands[i];
+    uint64_t start[SIM_MAX_NODES];
+    for (int id = 0; id < numNodes; id++) {
+      start[id] = command->armed[id];
+      if (command->moved[id] != 0 && command->moved[id] - command->armed[id] <= SIM_START_WINDOW_US) {
+        start[id] = command->moved[id];
+      }
+    }
+    int reached = 0;
+    double sum = 0;
+    double worst = 0;
+    for (int id = 1; id < numNodes; id++) {
+      if (command->armed[id] == 0) {continue;}
+      double skew = ((double) start[id] - (double) start[0]) / 1000.0;
+      sum += skew;
+      if (reached == 0 || skew > worst) {worst = skew;}
+      reached++;
+    }
+    fprintf(out, "%-40s %10.1f %3d/%-2d", command->uri, command->handled / 1000.0, reached, numNodes - 1);
+    if (reached > 0) {fprintf(out, " %12.2f %12.2f\n", sum / reached, worst);}
+    else {fprintf(out, " %12s %12s\n", "-", "-");}
+  }
+}
@@ -0,0 +1,263 @@
+/* SimWorld.h
+ * UT Austin RAS Demobots
+ * The fleet simulator's virtual clock, radio and recorders, see FleetSim.cpp
+ *
+ * Each node runs a whole firmware image (setup() and loop() from DemobotLegsESP32.ino, see SimImage.h).
+ * Nodes take turns on one virtual clock: a loop() call takes loopUs, delay() moves the node's clock forward,
+ * and frames, timers and web requests are delivered between loop() calls in time order.
+ * Node 0 is the mothership, nodes 1..numBots are bots.
+ *
+ * The radio delivers every ESP-NOW frame after latencyUs plus up to jitterUs.
+ * Each receiver loses a frame with lossPercent, unicasts are retried by the "radio" like real ESP-NOW.
+ * reorderPercent of the frames are held back long enough for the next ones to overtake them.
+ * Timers keep their schedule, but each call can run up to timerJitterUs late, like the esp_timer task on a busy ESP32.
+ * Each bot's crystal can be off by up to clockPpm: millis(), micros(), esp_timer and FreeRTOS waits all run on the node's
+ * local clock, the mothership's is exact.
+ * FreeRTOS tasks are coroutines (see sim/host/freertos/task.h), the ones pinned to APP_CPU wake on time:
+ * that core has nothing from the radio on it.
+ *
+ * All randomness comes from one generator seeded with the config's seed,
+ * so the same config always gives the same run, down to every servo write.
+ */
+
+#ifndef SIMWORLD
+#define SIMWORLD
+
+#include <stdint.h>
+#include <stdio.h>
+#include <ucontext.h>
+#include <esp_now.h>
+#include <esp_timer.h>
+#include <esp_wifi.h>
+
+#define SIM_MAX_BOTS 20
+#define SIM_MAX_NODES (SIM_MAX_BOTS + 1)
+#define SIM_MAX_TIMERS 4
+#define SIM_MAX_TASKS 2             //FreeRTOS tasks each node can create
+#define SIM_TASK_STACK (256 * 1024) //bytes of host stack for each task, whatever the firmware asks for
+#define SIM_MAX_FRAMES 4096         //frames in the air at once
+#define SIM_MAX_REQUESTS 8          //web requests waiting for a node's handleClient()
+#define SIM_MAX_COMMANDS 64         //dance move requests followed for the sync report
+#define SIM_MAX_JOINTS 8            //servo pins traced for each node, the first 4 are the profile's legs
+#define SIM_UNICAST_TRIES 5         //the radio retries an unacked unicast this many times
+#define SIM_RETRY_US 1000           //between retries
+#define SIM_START_WINDOW_US 100000  //a node that hasn't moved this long after a command is counted as starting right away (Stop)
+#define SIM_SYNC_SAMPLE_US 10000    //how often joint angles are compared for the sync report
+#define SIM_TICK_GAP_US 100000      //servo samples further apart than this are a new move, not a late tick
+#define SIM_FRAME_US 20000          //the servo frame (SERVO_FRAME_MS), for the tick phase report
+
+//one firmware image, registered by SimImage.h
+typedef struct SimImage {
+  const char* name;
+  void (*setup)();
+  void (*loop)();
+  const int* pins;          //leg servo pins, [hipL, hipR, ankleL, ankleR]
+  bool isMothership;
+} SimImage;
+
+class SimImageRegistrar {
+public:
+  SimImageRegistrar(const char* name, void (*setup)(), void (*loop)(), const int* pins, bool isMothership);
+};
+
+typedef struct SimConfig {
+  uint32_t seed;
+  int numBots;
+  uint64_t durationUs;
+  uint32_t loopUs;          //time one loop() call takes
+  uint32_t bootSpreadUs;    //bots power on at random times up to this
+  uint32_t latencyUs;
+  uint32_t jitterUs;
+  uint32_t timerJitterUs;   //timer callbacks run up to this late
+  int clockPpm;             //each bot's clock is off by up to this
+  int lossPercent;
+  int reorderPercent;
+  int batteryMillivolts;    //what the bots' battery monitors read
+  const char* traceDir;     //joint angle traces, NULL = none
+  bool verbose;             //print every node's Serial output
+} SimConfig;
+
+typedef struct SimTimer {
+  bool used;
+  bool running;
+  bool periodic;
+  uint64_t next;            //when it is due, on the node's clock
+  uint64_t fire;            //when it runs, next plus up to timerJitterUs, on the simulator's clock
+  uint64_t period;
+  esp_timer_cb_t callback;
+  void* arg;
+  bool pinned;              //wakes a task pinned to APP_CPU, never late
+} SimTimer;
+
+//a FreeRTOS task, a coroutine with its own stack
+typedef struct SimTask {
+  bool used;
+  void (*function)(void* arg);
+  void* arg;
+  char* stack;
+  ucontext_t context;
+  ucontext_t caller;        //the loop(), timer or task that resumed it, it goes back there when it waits
+  SimTimer* wake;           //ends its wait
+  bool waiting;             //for a notification
+  uint32_t notified;        //xTaskNotifyGive() count
+} SimTask;
+
+typedef struct SimRequest {
+  char uri[160];            //path and arguments, "/danceM?dance_move=Walk"
+  bool post;
+} SimRequest;
+
+typedef struct SimNode {
+  const SimImage* image;
+  uint8_t mac[6];
+  bool booted;
+  uint64_t bootUs;
+  uint64_t nextLoopUs;
+  uint64_t clock;           //the node's time while it runs, on the simulator's clock
+  int clockPpm;             //how far off its crystal is
+  uint32_t cpuMhz;
+
+  //radio
+  bool espNowInit;
+  esp_now_send_cb_t sendCallback;
+  esp_now_recv_cb_t recvCallback;
+  bool promiscuous;
+  wifi_promiscuous_cb_t promiscuousCallback;
+  uint8_t peers[ESP_NOW_MAX_TOTAL_PEER_NUM][6];
+  int numPeers;
+
+  SimTimer timers[SIM_MAX_TIMERS];
+
+  SimTask tasks[SIM_MAX_TASKS];
+  SimTask loopTask;               //stands for the task that runs setup() and loop(), only its handle is used
+  SimTask* runningTask;           //NULL = loopTask (or a timer)
+
+  SimRequest requests[SIM_MAX_REQUESTS];
+  int requestHead;
+  int requestTail;
+
+  //servos
+  int pins[SIM_MAX_JOINTS];
+  int angles[SIM_MAX_JOINTS];     //-1 = not written yet
+  FILE* trace;
+  uint64_t lastSample;            //last write to the first joint, the servos are written together each sample
+  uint64_t sampleMin;             //shortest and longest time between samples while moving
+  uint64_t sampleMax;
+
+  //Serial output, one line at a time
+  char line[256];
+  int lineLength;
+
+  //counts for the report
+  unsigned long framesSent;
+  unsigned long framesReceived;
+  unsigned long framesLost;
+  unsigned long servoWrites;
+  unsigned long httpErrors;
+  double syncSquares;             //squared angle differences from the first bot
+  unsigned long syncSamples;
+  double tickErrorSum;            //how far its samples are from the mothership's, over the second half of the run
+  uint64_t tickErrorMax;
+  unsigned long tickErrors;
+} SimNode;
+
+//a frame in the air, or the send callback for one
+typedef struct SimFrame {
+  uint64_t t;
+  uint32_t order;           //breaks ties so runs are repeatable
+  bool sendStatus;          //true = call the sender's send callback instead of delivering
+  bool success;
+  int from;
+  int to;
+  int length;
+  uint8_t data[ESP_NOW_MAX_DATA_LEN];
+} SimFrame;
+
+//a web request to the mothership that sends a dance move to the bots
+typedef struct SimCommand {
+  char uri[160];
+  uint64_t handled;               //when the mothership's handler ran
+  uint16_t seq;                   //seq of the command message the mothership sent, 0 = none yet
+  uint64_t armed[SIM_MAX_NODES];  //when the node got the command, 0 = never
+  uint64_t moved[SIM_MAX_NODES];  //first servo write after that, 0 = none
+} SimCommand;
+
+typedef struct SimEvent {
+  uint64_t t;
+  int node;
+  SimRequest request;
+} SimEvent;
+
+class SimWorld {
+public:
+  SimWorld();
+
+  bool begin(const SimConfig* config);
+  bool request(uint64_t t, int node, const char* uri, bool post);   //schedule a web request
+  void run();
+  bool runAs(const char* image, void (*function)());  //call function as the node running that image, instead of run() (see sim/tests)
+  void report(FILE* out);
+  bool allBotsCommanded();     //every bot got at least one dance move
+  uint64_t maxSampleGap();      //longest time between servo samples while moving, worst node
+
+  //for the host stand-ins (SimHost.cpp)
+  SimNode* current();
+  uint64_t clock();
+  uint64_t localClock();        //the running node's own clock, off by its clockPpm
+  void advance(uint64_t us);    //on the node's own clock
+  uint32_t random();
+  int getBatteryMillivolts();
+
+  esp_err_t send(const uint8_t* mac, const uint8_t* data, size_t length);
+  bool isPeer(SimNode* node, const uint8_t* mac);
+  SimTimer* createTimer(esp_timer_cb_t callback, void* arg);
+  void scheduleTimer(SimTimer* timer, uint64_t t);    //t on the node's own clock
+
+  SimRequest* nextRequest();
+  void requestStarted(const SimRequest* request);
+  void requestHandled(const SimRequest* request, int code, const char* content);
+  void servoWrite(int pin, int angle);
+  void log(const char* line);
+
+private:
+  void bootNode(int id);
+  void runLoop(int id);
+  void runTimer(int id, SimTimer* timer);
+  void deliver(SimFrame* frame);
+  void sampleSync();
+  void queueFrame(const SimFrame* frame);
+  void popFrame(SimFrame* frame);
+  uint64_t frameDelay();
+  int findNode(const uint8_t* mac);
+  int8_t linkRssi(int from, int to);
+  void enter(int id, uint64_t t);
+  void leave();
+  void writeTrace(SimNode* node, int joint, int angle);
+  void measureTick(SimNode* node);
+  uint64_t toLocal(SimNode* node, uint64_t t);
+  uint64_t toGlobal(SimNode* node, uint64_t local);
+
+  SimConfig config;
+  SimNode nodes[SIM_MAX_NODES];
+  int numNodes;
+  int currentNode;          //-1 = the simulator itself
+  uint64_t now;
+  uint64_t rng;
+
+  SimFrame frames[SIM_MAX_FRAMES];    //binary heap ordered by (t, order)
+  int numFrames;
+  uint32_t frameOrder;
+  unsigned long framesDropped;        //the heap was full
+
+  SimEvent events[SIM_MAX_COMMANDS * 2];
+  int numEvents;
+  int nextEvent;
+
+  SimCommand commands[SIM_MAX_COMMANDS];
+  int numCommands;
+  uint64_t nextSyncSample;
+};
+
+extern SimWorld simWorld;
+
+#endif
@@ -0,0 +1,29 @@
+/* Adafruit_NeoPixel.h
+ * UT Austin RAS Demobots
+ * Fleet simulator stand-in for the NeoPixel library, the LEDs aren't simulated
+ */
+
+#ifndef SIMADAFRUITNEOPIXEL
+#define SIMADAFRUITNEOPIXEL
+
+#include <Arduino.h>
+
+#define NEO_GRB 0x52
+#define NEO_KHZ800 0x0000
+
+class Adafruit_NeoPixel {
+public:
+  Adafruit_NeoPixel(uint16_t n = 0, int16_t pin = -1, int type = NEO_GRB + NEO_KHZ800) : n(n) {}
+  void begin() {}
+  void show() {}
+  void clear() {}
+  void setBrightness(uint8_t b) {}
+  void setPixelColor(uint16_t i, uint32_t c) {}
+  void setPixelColor(uint16_t i, uint8_t r, uint8_t g, uint8_t b) {}
+  uint16_t numPixels() const {return n;}
+  static uint32_t Color(uint8_t r, uint8_t g, uint8_t b) {return ((uint32_t) r << 16) | ((uint32_t) g << 8) | b;}
+private:
+  uint16_t n;
+};
+
+#endif
@@ -0,0 +1,138 @@
+/* Arduino.h
+ * UT Austin RAS Demobots
+ * Fleet simulator stand-in for the Arduino core, see FleetSim.cpp
+ *
+ * Time comes from the simulator's virtual clock, Serial goes to the simulator's log.
+ * ESP_PLATFORM is not defined, so RoutineStore and TrimStore use their RAM stand-ins.
+ */
+
+#ifndef SIMARDUINO
+#define SIMARDUINO
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include <type_traits>
+
+#define PI 3.1415926535897932384626433832795
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define IRAM_ATTR
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+//std::string with the Arduino String methods the firmware uses
+class String {
+public:
+  String() {}
+  String(const char* c) : s(c ? c : "") {}
+  String(const std::string& x) : s(x) {}
+  String(char c) : s(1, c) {}
+  String(int v) : s(std::to_string(v)) {}
+  String(unsigned int v) : s(std::to_string(v)) {}
+  String(long v) : s(std::to_string(v)) {}
+  String(unsigned long v) : s(std::to_string(v)) {}
+  String(float v, int decimals = 2) {format(v, decimals);}
+  String(double v, int decimals = 2) {format(v, decimals);}
+
+  const char* c_str() const {return s.c_str();}
+  unsigned int length() const {return s.size();}
+  char charAt(unsigned int i) const {return i < s.size() ? s[i] : 0;}
+  char operator[](unsigned int i) const {return charAt(i);}
+  bool equals(const String& o) const {return s == o.s;}
+  bool operator==(const String& o) const {return s == o.s;}
+  bool operator==(const char* o) const {return s == o;}
+  bool operator!=(const String& o) const {return s != o.s;}
+  bool operator!=(const char* o) const {return s != o;}
+  String& operator+=(const String& o) {s += o.s; return *this;}
+  String& operator+=(const char* o) {s += o; return *this;}
+  String& operator+=(char o) {s += o; return *this;}
+  long toInt() const {return atol(s.c_str());}
+  float toFloat() const {return atof(s.c_str());}
+  int indexOf(char c, unsigned int from = 0) const {size_t p = s.find(c, from); return p == std::string::npos ? -1 : p;}
+  int indexOf(const String& o, unsigned int from = 0) const {size_t p = s.find(o.s, from); return p == std::string::npos ? -1 : p;}
+  String substring(unsigned int from) const {return from < s.size() ? String(s.substr(from)) : String();}
+  String substring(unsigned int from, unsigned int to) const {return from < s.size() && to > from ? String(s.substr(from, to - from)) : String();}
+  void reserve(unsigned int n) {s.reserve(n);}
+  void trim() {
+    size_t a = s.find_first_not_of(" \t\r\n");
+    size_t b = s.find_last_not_of(" \t\r\n");
+    s = a == std::string::npos ? std::string() : s.substr(a, b - a + 1);
+  }
+
+  std::string s;
+
+private:
+  void format(double v, int decimals) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.*f", decimals, v);
+    s = buf;
+  }
+};
+inline String operator+(const String& a, const String& b) {return String(a.s + b.s);}
+inline String operator+(const String& a, const char* b) {return String(a.s + b);}
+inline String operator+(const char* a, const String& b) {return String(a + b.s);}
+inline String operator+(const String& a, char b) {return String(a.s + b);}
+
+//Serial, each line is logged with the node's name and time (see simLog in SimWorld.h)
+class Print {
+public:
+  void begin(unsigned long baud) {}
+  void flush() {}
+  int available() {return 0;}
+  int read() {return -1;}
+  size_t write(uint8_t c);
+  size_t write(const uint8_t* data, size_t len);
+
+  void print(const String& x) {put(x.c_str());}
+  void print(const char* x) {put(x);}
+  void print(char x) {write(x);}
+  void print(int x, int base = 10) {print((long) x, base);}
+  void print(unsigned int x, int base = 10) {print((unsigned long) x, base);}
+  void print(long x, int base = 10);
+  void print(unsigned long x, int base = 10);
+  void print(double x, int decimals = 2) {print(String(x, decimals));}
+  template<class T> void println(T x) {print(x); put("\n");}
+  template<class T> void println(T x, int format) {print(x, format); put("\n");}
+  void println() {put("\n");}
+  void printf(const char* format, ...);
+
+private:
+  void put(const char* x) {write((const uint8_t*) x, strlen(x));}
+};
+extern Print Serial;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+void pinMode(int pin, int mode);
+void digitalWrite(int pin, int value);
+int digitalRead(int pin);
+int analogRead(int pin);
+uint32_t analogReadMilliVolts(int pin);
+void adcAttachPin(int pin);
+
+bool setCpuFrequencyMhz(uint32_t mhz);
+uint32_t getCpuFrequencyMhz();
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+long map(long x, long inMin, long inMax, long outMin, long outMax);
+
+template<class T> T constrain(T x, T a, T b) {return x < a ? a : (x > b ? b : x);}
+//by value, decltype(a < b ? a : b) would be a reference to a or b
+template<class T, class U> typename std::common_type<T, U>::type min(T a, U b) {return a < b ? a : b;}
+template<class T, class U> typename std::common_type<T, U>::type max(T a, U b) {return a > b ? a : b;}
+
+#endif
@@ -0,0 +1,27 @@
+/* ESP32Servo.h
+ * UT Austin RAS Demobots
+ * Fleet simulator stand-in for the ESP32Servo library, every write goes to the node's joint trace (see SimWorld.h)
+ */
+
+#ifndef SIMESP32SERVO
+#define SIMESP32SERVO
+
+class Servo {
+public:
+  Servo();
+  void setPeriodHertz(int hz) {}
+  int attach(int pin, int minUs = 544, int maxUs = 2400);
+  void detach();
+  bool attached();
+  void write(int angle);
+  void writeMicroseconds(int us);
+  int read();
+
+private:
+  int pin;
+  int minUs;
+  int maxUs;
+  int angle;
+};
+
+#endif
@@ -0,0 +1,15 @@
+/* ESPmDNS.h
+ * UT Austin RAS Demobots
+ * Fleet simulator stand-in for mDNS
+ */
+
+#ifndef SIMESPMDNS
+#define SIMESPMDNS
+
+class MDNSResponder {
+public:
+  bool begin(const char* hostName) {return true;}
+};
+extern MDNSResponder MDNS;
+
+#endif
@@ -0,0 +1,68 @@
+/* WebServer.h
+ * UT Austin RAS Demobots
+ * Fleet simulator stand-in for the Arduino WebServer
+ *
+ * The simulator queues requests for a node (see simRequest in SimWorld.h),
+ * handleClient() runs the handler for one of them like the real server would.
+ */
+
+#ifndef SIMWEBSERVER
+#define SIMWEBSERVER
+
+#include <Arduino.h>
+
+#define CONTENT_LENGTH_UNKNOWN ((size_t) -1)
+#define WEBSERVER_MAX_HANDLERS 16
+#define WEBSERVER_MAX_ARGS 8
+
+enum HTTPMethod {HTTP_ANY, HTTP_GET, HTTP_POST};
+
+struct SimRequest;
+
+class WebServer {
+public:
+  typedef void (*THandlerFunction)();
+
+  WebServer(int port);
+  void on(const char* uri, THandlerFunction handler) {on(uri, HTTP_ANY, handler);}
+  void on(const char* uri, HTTPMethod method, THandlerFunction handler);
+  void onNotFound(THandlerFunction handler) {notFound = handler;}
+  void begin() {}
+  void handleClient();
+
+  //the current request
+  String uri() {return requestUri;}
+  HTTPMethod method() {return requestMethod;}
+  int args() {return numArgs;}
+  String arg(int i) {return i < numArgs ? argValues[i] : String();}
+  String argName(int i) {return i < numArgs ? argNames[i] : String();}
+  String arg(const char* name);
+  bool hasArg(const char* name);
+
+  //the response, the simulator logs it
+  void send(int code, const char* contentType, const String& content);
+  void send(int code, const char* contentType, const char* content) {send(code, contentType, String(content));}
+  void send_P(int code, const char* contentType, const char* content, size_t len);
+  void setContentLength(size_t len) {}
+  void sendContent(const String& content) {}
+  void sendContent(const char* content, size_t len) {}
+
+private:
+  struct Handler {
+    String uri;
+    HTTPMethod method;
+    THandlerFunction handler;
+  };
+  Handler handlers[WEBSERVER_MAX_HANDLERS];
+  int numHandlers;
+  THandlerFunction notFound;
+
+  const SimRequest* lastRequest;
+  String requestUri;
+  HTTPMethod requestMethod;
+  String argNames[WEBSERVER_MAX_ARGS];
+  String argValues[WEBSERVER_MAX_ARGS];
+  int numArgs;
+};
+
+#endif
@@ -0,0 +1,39 @@
+/* WiFi.h
+ * UT Austin RAS Demobots
+ * Fleet simulator stand-in for the Arduino WiFi library, each node gets a MAC address from the simulator
+ */
+
+#ifndef SIMWIFI
+#define SIMWIFI
+
+#include <Arduino.h>
+
+#define WIFI_OFF 0
+#define WIFI_STA 1
+#define WIFI_AP 2
+#define WIFI_AP_STA 3
+#define WL_CONNECTED 3
+
+class IPAddress {
+public:
+  IPAddress() : a(0), b(0), c(0), d(0) {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : a(a), b(b), c(c), d(d) {}
+  String toString() const {return String(a) + "." + String(b) + "." + String(c) + "." + String(d);}
+private:
+  int a, b, c, d;
+};
+
+class WiFiClass {
+public:
+  void mode(int m) {}
+  String macAddress();
+  uint8_t* macAddress(uint8_t* mac);
+  bool softAP(const char* ssid, const char* pass = NULL) {return true;}
+  IPAddress softAPIP() {return IPAddress(192, 168, 4, 1);}
+  int begin(const char* ssid, const char* pass = NULL) {return WL_CONNECTED;}
+  int status() {return WL_CONNECTED;}
+  IPAddress localIP() {return IPAddress(192, 168, 4, 1);}
+};
+extern WiFiClass WiFi;
+
+#endif
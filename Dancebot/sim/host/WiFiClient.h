@@ -0,0 +1,11 @@
+/* WiFiClient.h
+ * UT Austin RAS Demobots
+ * Fleet simulator stand-in, nothing in the firmware uses WiFiClient directly
+ */
+
+#ifndef SIMWIFICLIENT
+#define SIMWIFICLIENT
+
+#include "WiFi.h"
+
+#endif
@@ -0,0 +1,45 @@
+/* i2s.h
+ * UT Austin RAS Demobots
+ * Fleet simulator stand-in for the ESP-IDF I2S driver, there is no microphone so the driver never installs
+ */
+
+#ifndef SIMI2S
+#define SIMI2S
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../esp_err.h"
+
+#define I2S_PIN_NO_CHANGE -1
+
+typedef enum {I2S_NUM_0, I2S_NUM_1} i2s_port_t;
+typedef enum {I2S_MODE_MASTER = 1, I2S_MODE_SLAVE = 2, I2S_MODE_TX = 4, I2S_MODE_RX = 8} i2s_mode_t;
+typedef enum {I2S_BITS_PER_SAMPLE_16BIT = 16, I2S_BITS_PER_SAMPLE_32BIT = 32} i2s_bits_per_sample_t;
+typedef enum {I2S_CHANNEL_FMT_RIGHT_LEFT, I2S_CHANNEL_FMT_ONLY_RIGHT = 3, I2S_CHANNEL_FMT_ONLY_LEFT} i2s_channel_fmt_t;
+typedef enum {I2S_COMM_FORMAT_STAND_I2S = 1} i2s_comm_format_t;
+
+typedef struct {
+  i2s_mode_t mode;
+  uint32_t sample_rate;
+  i2s_bits_per_sample_t bits_per_sample;
+  i2s_channel_fmt_t channel_format;
+  i2s_comm_format_t communication_format;
+  int intr_alloc_flags;
+  int dma_buf_count;
+  int dma_buf_len;
+  bool use_apll;
+} i2s_config_t;
+
+typedef struct {
+  int bck_io_num;
+  int ws_io_num;
+  int data_out_num;
+  int data_in_num;
+} i2s_pin_config_t;
+
+esp_err_t i2s_driver_install(i2s_port_t port, const i2s_config_t* config, int queue_size, void* queue);
+esp_err_t i2s_driver_uninstall(i2s_port_t port);
+esp_err_t i2s_set_pin(i2s_port_t port, const i2s_pin_config_t* pins);
+esp_err_t i2s_read(i2s_port_t port, void* dest, size_t size, size_t* bytes_read, uint32_t ticks_to_wait);
+
+#endif
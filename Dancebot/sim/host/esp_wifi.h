@@ -0,0 +1,43 @@
+/* esp_wifi.h
+ * UT Austin RAS Demobots
+ * Fleet simulator stand-in for the ESP-IDF WiFi driver calls the firmware makes
+ */
+
+#ifndef SIMESPWIFI
+#define SIMESPWIFI
+
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef enum {
+  WIFI_PS_NONE,
+  WIFI_PS_MIN_MODEM,
+  WIFI_PS_MAX_MODEM,
+} wifi_ps_type_t;
+
+typedef enum {
+  WIFI_PKT_MGMT,
+  WIFI_PKT_CTRL,
+  WIFI_PKT_DATA,
+  WIFI_PKT_MISC,
+} wifi_promiscuous_pkt_type_t;
+
+typedef struct {
+  signed rssi:8;
+  unsigned rate:5;
+  unsigned :19;
+} wifi_pkt_rx_ctrl_t;
+
+typedef struct {
+  wifi_pkt_rx_ctrl_t rx_ctrl;
+  uint8_t payload[0];       //802.11 frame
+} wifi_promiscuous_pkt_t;
+
+typedef void (*wifi_promiscuous_cb_t)(void* buf, wifi_promiscuous_pkt_type_t type);
+
+esp_err_t esp_wifi_set_ps(wifi_ps_type_t type);
+esp_err_t esp_wifi_connectionless_module_set_wake_interval(uint16_t interval);
+esp_err_t esp_wifi_set_promiscuous(bool enable);
+esp_err_t esp_wifi_set_promiscuous_rx_cb(wifi_promiscuous_cb_t cb);
+
+#endif
@@ -0,0 +1,19 @@
+/* FreeRTOS.h
+ * UT Austin RAS Demobots
+ * Fleet simulator stand-in for FreeRTOS, a node's loop() and timers never run at the same time (see SimWorld.h)
+ */
+
+#ifndef SIMFREERTOS
+#define SIMFREERTOS
+
+#include <stdint.h>
+
+typedef int BaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdPASS pdTRUE
+#define portMAX_DELAY ((TickType_t) 0xffffffff)
+
+#endif
@@ -0,0 +1,25 @@
+/* semphr.h
+ * UT Austin RAS Demobots
+ * Fleet simulator stand-in for FreeRTOS semaphores
+ *
+ * Nothing ever has to wait, but the mutexes count how deep they are held and which task holds them,
+ * so giving one that isn't held, or taking one another task holds (a real ESP32 would wait there), is logged (see --verbose).
+ */
+
+#ifndef SIMSEMPHR
+#define SIMSEMPHR
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+typedef struct SimMutex {
+  int depth;
+  TaskHandle_t owner;
+} SimMutex;
+typedef SimMutex* SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex();
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t mutex, TickType_t wait);
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t mutex);
+
+#endif
@@ -0,0 +1,33 @@
+/* task.h
+ * UT Austin RAS Demobots
+ * Fleet simulator stand-in for FreeRTOS tasks
+ *
+ * A task is a coroutine on the node's virtual clock (see SimTask in SimWorld.h).
+ * It runs until it waits for a notification, then the node's loop() or timer that woke it carries on.
+ * xTaskNotifyGive() runs a waiting task right away, like a higher priority task on the other core would.
+ * The tick is 1 ms and starts on whole milliseconds of the node's clock, so a wait can end up to a tick early.
+ */
+
+#ifndef SIMTASK
+#define SIMTASK
+
+#include "FreeRTOS.h"
+
+struct SimTask;
+typedef SimTask* TaskHandle_t;
+typedef void (*TaskFunction_t)(void* arg);
+
+#define configMAX_PRIORITIES 25
+#define PRO_CPU_NUM 0
+#define APP_CPU_NUM 1
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t) (ms) / portTICK_PERIOD_MS)
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stackSize, void* arg,
+                                   int priority, TaskHandle_t* handle, BaseType_t core);
+TaskHandle_t xTaskGetCurrentTaskHandle();
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t wait);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+
+#endif
@@ -0,0 +1,9 @@
+/* BigBotTests.cpp
+ * UT Austin RAS Demobots
+ * The host tests on the big dancebot's firmware (see ImageTests.h), the only profile with the hat joint
+ */
+
+#define DANCEBOT_PROFILE_BIGBOT
+#define SIM_IMAGE bigbot
+#include "../SimImage.h"
+#include "ImageTests.h"
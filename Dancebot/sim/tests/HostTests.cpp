@@ -0,0 +1,75 @@
+/* HostTests.cpp
+ * UT Austin RAS Demobots
+ * Host test driver: runs the firmware's test functions on a PC, on each profile that has an image here
+ *
+ * Build from the Dancebot folder (no ESP32 toolchain needed):
+ *    g++ -std=gnu++11 -O2 -Wall -Isim/host -Isrc sim/tests/HostTests.cpp sim/tests/MothershipTests.cpp
+ *        sim/tests/BigBotTests.cpp sim/tests/SmallBotTests.cpp sim/tests/Joints8Tests.cpp sim/tests/Joints16Tests.cpp
+ *        sim/SimHost.cpp sim/SimWorld.cpp -o hosttests
+ *
+ * Run:
+ *    ./hosttests       runs every test, exits with 1 if any failed
+ *
+ * Each image is a whole firmware image like the fleet simulator's (see SimImage.h), and its tests run as that
+ * image's node on the simulator's virtual clock (SimWorld::runAs), so delay() and millis() work without waiting.
+ * The tests print with Serial, each line starts with the node's time and the image's name.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "HostTests.h"
+#include "../SimWorld.h"
+
+#define HOST_MAX_IMAGES 6
+
+typedef struct HostSuite {
+  const char* image;
+  void (*run)();
+} HostSuite;
+
+static HostSuite suites[HOST_MAX_IMAGES];
+static int numSuites = 0;
+static int numTests = 0;
+static int numFailed = 0;
+
+HostTestRegistrar::HostTestRegistrar(const char* image, void (*run)()) {
+  if (numSuites < HOST_MAX_IMAGES) {
+    suites[numSuites].image = image;
+    suites[numSuites].run = run;
+    numSuites++;
+  }
+}
+
+void hostTest(const char* name, bool passed) {
+  numTests++;
+  if (!passed) {
+    numFailed++;
+    printf("FAILED %s on %s\n", name, simWorld.current()->image->name);
+  }
+}
+
+unsigned long hostMicros() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (unsigned long) now.tv_sec * 1000000UL + now.tv_nsec / 1000;
+}
+
+int main() {
+  SimConfig config;
+  memset(&config, 0, sizeof(config));
+  config.seed = 1;
+  config.numBots = numSuites - 1;
+  config.loopUs = 1000;
+  config.batteryMillivolts = 8000;
+  config.verbose = true;
+  if (!simWorld.begin(&config)) {
+    return 2;
+  }
+
+  for (int i = 0; i < numSuites; i++) {
+    simWorld.runAs(suites[i].image, suites[i].run);
+  }
+  printf("\n%d tests, %d failed\n", numTests, numFailed);
+  return numFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,21 @@
+/* HostTests.h
+ * UT Austin RAS Demobots
+ * The host test driver's registry, see HostTests.cpp
+ */
+
+#ifndef HOSTTESTS
+#define HOSTTESTS
+
+//one image's tests, ImageTests.h makes one for each image
+class HostTestRegistrar {
+public:
+  HostTestRegistrar(const char* image, void (*run)());
+};
+
+//count one test's result, the tests print their own PASSED or FAILED
+void hostTest(const char* name, bool passed);
+
+//us on the PC's monotonic clock, for benchmarks, micros() is the simulator's virtual clock
+unsigned long hostMicros();
+
+#endif
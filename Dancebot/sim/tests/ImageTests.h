@@ -0,0 +1,54 @@
+/* ImageTests.h
+ * UT Austin RAS Demobots
+ * The firmware's test functions, run on one image (see HostTests.cpp)
+ *
+ * Include it right after SimImage.h with SIM_IMAGE still defined, the tests then run on that image's profile.
+ * There is no include guard on purpose, like SimImage.h.
+ * To add a test, call it here with hostTest(), inside #if when it only runs on some profiles.
+ */
+
+#include "HostTests.h"
+
+#define SIM_TESTS(x) SIM_TESTS2(x)
+#define SIM_TESTS2(x) x##Tests
+
+namespace SIM_IMAGE {
+static void runTests() {
+  const int* pins = dancebotProfile.pins;
+  DancingServos* bot = new DancingServos(pins[0], pins[1], pins[2], pins[3]);
+#if HAS_HAT
+  bot->attachJoint(HAT_JOINT, HAT_PIN);
+#endif
+  //the host's clock is virtual, the benchmark is timed with a real one
+  hostTest("jointBenchmark", jointBenchmark(bot, hostMicros));
+#if EXTRA_JOINTS == 0
+  //images built with extra joints only time the motion tick, their profile's own image runs the rest
+  hostTest("moveQueueTest", moveQueueTest(bot));
+  hostTest("dancingServosTest", dancingServosTest(bot));
+  hostTest("danceScriptTest", danceScriptTest(bot));
+  hostTest("tempoTest", tempoTest(bot));
+  hostTest("powerTierTest", powerTierTest(bot));
+  hostTest("kinematicsTest", kinematicsTest());
+
+#if HAS_POWER_CONTROLLER
+  hostTest("batterySagTest", batterySagTest());
+  hostTest("batteryTraceTest", batteryTraceTest());
+#endif
+
+#if IS_MOTHERSHIP
+  //the same on every profile, so they only run once
+  hostTest("loopSchedulerTest", loopSchedulerTest());
+  hostTest("beatClockTest", beatClockTest());
+  hostTest("beatTrackerTest", beatTrackerTest());
+  hostTest("fleetRegistryTest", fleetRegistryTest());
+  hostTest("reliableLinkTest", reliableLinkTest());
+  hostTest("fleetTelemetryTest", fleetTelemetryTest());
+  hostTest("routineStoreTest", routineStoreTest(bot));
+  hostTest("trimStoreTest", trimStoreTest());
+  hostTest("traceRecorderTest", traceRecorderTest());
+#endif
+#endif
+}
+}
+
+static HostTestRegistrar SIM_TESTS(SIM_IMAGE)(SIM_STRING(SIM_IMAGE), SIM_IMAGE::runTests);
@@ -0,0 +1,10 @@
+/* Joints16Tests.cpp
+ * UT Austin RAS Demobots
+ * The joint benchmark on the small dancebot's firmware built with 16 joints (see ImageTests.h)
+ */
+
+#define DANCEBOT_PROFILE_SMALLBOT
+#define EXTRA_JOINTS 12
+#define SIM_IMAGE joints16
+#include "../SimImage.h"
+#include "ImageTests.h"
@@ -0,0 +1,10 @@
+/* Joints8Tests.cpp
+ * UT Austin RAS Demobots
+ * The joint benchmark on the small dancebot's firmware built with 8 joints (see ImageTests.h)
+ */
+
+#define DANCEBOT_PROFILE_SMALLBOT
+#define EXTRA_JOINTS 4
+#define SIM_IMAGE joints8
+#include "../SimImage.h"
+#include "ImageTests.h"
@@ -0,0 +1,9 @@
+/* MothershipTests.cpp
+ * UT Austin RAS Demobots
+ * The host tests on the mothership's firmware (see ImageTests.h)
+ */
+
+#define DANCEBOT_PROFILE_MOTHERSHIP
+#define SIM_IMAGE mothership
+#include "../SimImage.h"
+#include "ImageTests.h"
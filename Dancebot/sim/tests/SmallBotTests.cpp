@@ -0,0 +1,9 @@
+/* SmallBotTests.cpp
+ * UT Austin RAS Demobots
+ * The host tests on the small dancebot's firmware (see ImageTests.h)
+ */
+
+#define DANCEBOT_PROFILE_SMALLBOT
+#define SIM_IMAGE smallbot
+#include "../SimImage.h"
+#include "ImageTests.h"
@@ -0,0 +1,318 @@
+//BeatClock.cpp
+//UT Austin RAS Demobots
+
+#include <string.h>
+#include "BeatClock.h"
+
+BeatClock::BeatClock(int64_t (*_clock)()) {
+  clock = _clock;
+  memset(&model, 0, sizeof(model));
+  model.beatPeriod = 60000000L / tempo;
+  writeModel();
+}
+
+
+//FLEET TIME
+
+int64_t BeatClock::now() {
+  return toFleet(clock());
+}
+
+int64_t BeatClock::toFleet(int64_t local) {
+  BeatModel m;
+  readModel(&m);
+  int64_t elapsed = local - m.localBase;
+  return m.fleetBase + elapsed + (int64_t) llround(elapsed * m.drift);
+}
+
+int64_t BeatClock::toLocal(int64_t fleet) {
+  BeatModel m;
+  readModel(&m);
+  int64_t elapsed = fleet - m.fleetBase;
+  return m.localBase + (int64_t) llround(elapsed / (1 + m.drift));
+}
+
+//loop() is the only writer, it keeps its own copy so it doesn't have to read the published one
+void BeatClock::writeModel() {
+  modelSeq++;
+  __sync_synchronize();
+  published = model;
+  __sync_synchronize();
+  modelSeq++;
+}
+
+void BeatClock::readModel(BeatModel* out) {
+  uint32_t seq;
+  do {
+    seq = modelSeq;
+    __sync_synchronize();
+    *out = published;
+    __sync_synchronize();
+  } while ((seq & 1) != 0 || seq != modelSeq);
+}
+
+
+//BEAT GRID
+
+void BeatClock::setTempo(int bpm) {
+  if (bpm <= 0) {
+    return;
+  }
+  uint32_t last = getBeat(now());
+  model.beatTime = getBeatTime(last);
+  model.beat = last;
+  model.beatPeriod = 60000000L / bpm;
+  tempo = bpm;
+  writeModel();
+}
+
+//at most half a beat either way, so the beat numbers in the beacons don't skip or repeat by more than one
+void BeatClock::alignBeat(int64_t fleet) {
+  uint32_t nearest = getBeat(fleet + model.beatPeriod / 2);
+  model.beatTime = fleet;
+  model.beat = nearest;
+  writeModel();
+}
+
+int BeatClock::getTempo() {
+  return tempo;
+}
+
+uint32_t BeatClock::getBeat(int64_t fleet) {
+  BeatModel m;
+  readModel(&m);
+  //round down, also before beatTime
+  int64_t since = fleet - m.beatTime;
+  int64_t beats = since >= 0 ? since / m.beatPeriod : -((-since + m.beatPeriod - 1) / m.beatPeriod);
+  return m.beat + (uint32_t) beats;
+}
+
+int64_t BeatClock::getBeatTime(uint32_t beat) {
+  BeatModel m;
+  readModel(&m);
+  return m.beatTime + (int64_t) (int32_t) (beat - m.beat) * m.beatPeriod;
+}
+
+void BeatClock::makeBeacon(struct_beat* beacon) {
+  memset(beacon, 0, sizeof(*beacon));
+  beacon->status = Beat;
+  beacon->beat = getBeat(now());
+  beacon->beatTime = getBeatTime(beacon->beat);
+  beacon->tempo = tempo;
+  beacon->time = now();
+}
+
+
+//PLL
+
+void BeatClock::beacon(const struct_beat* beacon, int64_t received) {
+  beacons++;
+  int64_t predicted = toFleet(received);
+  long error = beacon->time - predicted;
+
+  if (!locked || skippedInRow >= BEAT_PLL_RELOCK) {
+    lock(beacon, received);
+    return;
+  }
+  lastError = error;
+  if (labs(error) > BEAT_PLL_MAX_ERROR_US) {
+    skipped++;
+    skippedInRow++;
+    return;
+  }
+  skippedInRow = 0;
+  if (labs(error) > maxError) {maxError = labs(error);}
+  errorSum += labs(error);
+  errorCount++;
+
+  //a little of the error comes out of the phase now, and a little goes into the rate so it doesn't build up again
+  int64_t elapsed = received - model.localBase;
+  if (elapsed > 0) {
+    model.drift += BEAT_PLL_KI * error / elapsed;
+    model.drift = constrain(model.drift, -BEAT_PLL_MAX_PPM / 1e6, BEAT_PLL_MAX_PPM / 1e6);
+  }
+  model.fleetBase = predicted + (int64_t) llround(BEAT_PLL_KP * error);
+  model.localBase = received;
+  if (beacon->tempo != 0) {
+    model.beatTime = beacon->beatTime;
+    model.beat = beacon->beat;
+    model.beatPeriod = 60000000L / beacon->tempo;
+    tempo = beacon->tempo;
+  }
+  writeModel();
+}
+
+//take the beacon's time as it is, the first beacon or after the mothership restarted
+void BeatClock::lock(const struct_beat* beacon, int64_t received) {
+  model.fleetBase = beacon->time;
+  model.localBase = received;
+  model.drift = 0;
+  if (beacon->tempo != 0) {
+    model.beatTime = beacon->beatTime;
+    model.beat = beacon->beat;
+    model.beatPeriod = 60000000L / beacon->tempo;
+    tempo = beacon->tempo;
+  }
+  locked = true;
+  skippedInRow = 0;
+  writeModel();
+}
+
+bool BeatClock::isLocked() {
+  return locked;
+}
+
+
+//STATS
+
+long BeatClock::getLastError() {
+  return lastError;
+}
+
+long BeatClock::getMaxError() {
+  return maxError;
+}
+
+long BeatClock::getAvgError() {
+  return errorCount == 0 ? 0 : lround(errorSum / errorCount);
+}
+
+double BeatClock::getDriftPpm() {
+  return model.drift * 1e6;
+}
+
+unsigned long BeatClock::getBeacons() {
+  return beacons;
+}
+
+unsigned long BeatClock::getSkipped() {
+  return skipped;
+}
+
+void BeatClock::printStats(Print* out) {
+  out->println("beat clock: " + String(locked ? "locked" : "not locked") + " beacons: " + String(beacons) +
+               " skipped: " + String(skipped) + " error last: " + String(lastError) + " avg: " + String(getAvgError()) +
+               " max: " + String(maxError) + " us drift: " + String(getDriftPpm()) + " ppm tempo: " + String(tempo));
+}
+
+void BeatClock::resetStats() {
+  maxError = 0;
+  errorSum = 0;
+  errorCount = 0;
+  beacons = 0;
+  skipped = 0;
+}
+
+
+/* Test
+ * a mothership and a bot on a virtual clock, the bot's crystal off by ppm, beacons every beat with radio latency,
+ * jitter and loss, checks how far the bot's fleet time is from the mothership's once it has settled
+ */
+
+static int64_t testTime = 0;      //the mothership's clock
+static int64_t testStart = 0;     //the bot's clock at testTime 0
+static long testPpm = 0;
+static int64_t testMothershipClock() {return testTime;}
+static int64_t testBotTime(int64_t t) {return testStart + t + t * testPpm / 1000000;}
+static int64_t testBotClock() {return testBotTime(testTime);}
+static int64_t testRestartedClock() {return testTime - 9000000;}   //a mothership that restarted 9 s after the first
+
+static uint32_t testRandom = 1;
+static uint32_t testNext() {
+  testRandom = testRandom * 1103515245 + 12345;
+  return testRandom >> 8;
+}
+
+#define TEST_LATENCY_US 2000
+#define TEST_JITTER_US 1000
+
+//run for seconds, the phase error is measured every 20 ms over the second half, returns false if the bot isn't locked at the end
+static bool testRun(long ppm, int lossPercent, int seconds, long* bias, long* wander) {
+  testTime = 0;
+  testStart = 123456789;
+  testPpm = ppm;
+  BeatClock mothership(testMothershipClock);
+  BeatClock bot(testBotClock);
+
+  //beacons in the air, at most one per beat is sent and they arrive within a beat
+  struct_beat inAir;
+  int64_t arrives = -1;
+  uint32_t lastBeat = 0xFFFFFFFF;
+  double sum = 0;
+  long count = 0;
+  long low = 0;
+  long high = 0;
+  for (testTime = 0; testTime < seconds * 1000000LL; testTime += 1000) {
+    uint32_t beat = mothership.getBeat(mothership.now());
+    if (beat != lastBeat) {
+      lastBeat = beat;
+      mothership.makeBeacon(&inAir);
+      arrives = (int) (testNext() % 100) < lossPercent ? -1 : testTime + TEST_LATENCY_US + testNext() % (TEST_JITTER_US + 1);
+    }
+    if (arrives != -1 && testTime >= arrives) {
+      bot.beacon(&inAir, testBotTime(arrives));
+      arrives = -1;
+    }
+    if (testTime >= seconds * 500000LL && testTime % 20000 == 0) {
+      long error = bot.now() - testTime;
+      if (count == 0 || error < low) {low = error;}
+      if (count == 0 || error > high) {high = error;}
+      sum += error;
+      count++;
+    }
+  }
+  *bias = lround(sum / count);
+  *wander = high - low;
+  Serial.println("ppm " + String(ppm) + " loss " + String(lossPercent) + "%: behind by " + String(-*bias) +
+                 " us, wanders " + String(*wander) + " us, drift " + String(bot.getDriftPpm()) + " ppm, skipped " +
+                 String(bot.getSkipped()) + " of " + String(bot.getBeacons()));
+  return bot.isLocked();
+}
+
+bool beatClockTest() {
+  bool passed = true;
+  //the bots should be behind by the average latency, and wander less than the jitter
+  long ppms[] = {0, 40, -100, 500};
+  int losses[] = {0, 30, 30, 60};
+  for (int i = 0; i < 4; i++) {
+    long bias;
+    long wander;
+    if (!testRun(ppms[i], losses[i], 60, &bias, &wander)) {passed = false;}
+    if (labs(-bias - (TEST_LATENCY_US + TEST_JITTER_US / 2)) > 300 || wander > TEST_JITTER_US) {passed = false;}
+  }
+
+  //the beat grid comes across with the beacons
+  testTime = 0;
+  BeatClock mothership(testMothershipClock);
+  BeatClock bot(testBotClock);
+  testTime = 1250000;
+  mothership.setTempo(90);
+  testTime = 2000000;
+  struct_beat beacon;
+  mothership.makeBeacon(&beacon);
+  bot.beacon(&beacon, testBotClock());
+  if (bot.getTempo() != 90 || bot.getBeat(bot.now()) != mothership.getBeat(testTime) ||
+      bot.getBeatTime(3) != mothership.getBeatTime(3) || mothership.getBeatTime(2) != 1000000 ||
+      mothership.getBeatTime(3) != 1000000 + 666666) {
+    passed = false;
+  }
+
+  //the music's beat moves the grid, the beat nearest it keeps its number
+  int64_t beat5 = mothership.getBeatTime(5);
+  mothership.alignBeat(beat5 + 200000);
+  if (mothership.getBeatTime(5) != beat5 + 200000 || mothership.getBeat(beat5 + 200000) != 5) {passed = false;}
+  mothership.alignBeat(beat5 - 100000);
+  if (mothership.getBeatTime(5) != beat5 - 100000) {passed = false;}
+
+  //the mothership restarts, the bot skips BEAT_PLL_RELOCK beacons that are far off and starts over from the next one
+  BeatClock restarted(testRestartedClock);
+  for (int i = 0; i <= BEAT_PLL_RELOCK; i++) {
+    testTime = 10000000 + i * 500000;
+    restarted.makeBeacon(&beacon);
+    bot.beacon(&beacon, testBotClock());
+  }
+  if (bot.getSkipped() != BEAT_PLL_RELOCK || labs(bot.now() - restarted.now()) > 1) {passed = false;}
+
+  Serial.println(passed ? "beat clock test PASSED" : "beat clock test FAILED");
+  return passed;
+}
@@ -0,0 +1,106 @@
+/* BeatClock.h
+ * UT Austin RAS Demobots
+ * The fleet clock and beat grid, the bots follow the mothership's with a software PLL
+ *
+ * Fleet time is the mothership's esp_timer time (us). Each beat the mothership broadcasts a beacon (struct_beat in Messages.h)
+ * with the fleet time it was sent at and where the beat grid is. A bot's BeatClock turns its own esp_timer time into
+ * fleet time with fleet = fleetBase + (local - localBase) * (1 + drift), and every beacon corrects that a little:
+ *    error = beacon time - fleet time the bot thinks it is
+ *    the base moves by BEAT_PLL_KP of the error and the drift (the crystals' rate difference) by BEAT_PLL_KI of it,
+ *    so one late beacon barely moves the clock and a steady rate difference is soon tracked with no error left
+ *    a beacon more than BEAT_PLL_MAX_ERROR_US off was held up somewhere and is skipped, BEAT_PLL_RELOCK of those in a row
+ *    and the bot starts over from the next beacon (the mothership restarted)
+ * The first beacon sets the clock outright. Lost beacons don't matter much, the drift carries the clock across the gap.
+ *
+ * The beacon's time is when the mothership handed it to the radio, so the bots run behind the mothership by the radio's latency.
+ * That is about the same for every bot, so they stay together, they are only all a little behind the mothership.
+ *
+ * The mothership's BeatClock gets no beacons, its fleet time is its own clock.
+ * DancingServos ticks on multiples of the sample period of fleet time when it has a BeatClock (see setBeatClock()),
+ * so the whole fleet samples its servos at the same moments.
+ *
+ * beacon() and setTempo() are called from loop() only, the motion task reads the clock through a sequence lock
+ * like DancingServos' MotionStatus.
+ * Time comes from esp_timer_get_time(), or the clock given to the constructor, so it can be tested on a virtual clock (see beatClockTest).
+ */
+
+#ifndef BEATCLOCK
+#define BEATCLOCK
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include "Messages.h"
+
+#define BEAT_PLL_KP 0.2               //share of a beacon's error taken out of the phase right away
+#define BEAT_PLL_KI 0.02              //share of it taken into the drift, per beacon interval
+#define BEAT_PLL_MAX_PPM 500          //the drift is kept within this, ESP32 crystals are within tens of ppm
+#define BEAT_PLL_MAX_ERROR_US 4000    //a beacon further off than this was held up, skip it
+#define BEAT_PLL_RELOCK 4             //skipped beacons in a row before starting over
+
+//the clock model, loop() writes it and the motion task reads it
+typedef struct BeatModel {
+  int64_t fleetBase;        //fleet time at localBase
+  int64_t localBase;        //esp_timer time
+  double drift;             //fleet us per local us, minus 1
+  int64_t beatTime;         //fleet time of beat number beat
+  uint32_t beat;
+  int32_t beatPeriod;       //us
+} BeatModel;
+
+class BeatClock {
+public:
+  BeatClock(int64_t (*_clock)() = esp_timer_get_time);
+
+  //fleet time (us)
+  int64_t now();
+  int64_t toFleet(int64_t local);
+  int64_t toLocal(int64_t fleet);
+
+  //the beat grid
+  void setTempo(int bpm);           //the mothership's, the next beat is one beat at the new tempo after the last one
+  void alignBeat(int64_t fleet);    //the mothership's, moves the grid so a beat falls at fleet time, the nearest beat keeps its number
+  int getTempo();
+  uint32_t getBeat(int64_t fleet);  //number of the latest beat at fleet time
+  int64_t getBeatTime(uint32_t beat);
+
+  //mothership
+  void makeBeacon(struct_beat* beacon);   //a beacon for the latest beat, with the time now
+
+  //bots
+  void beacon(const struct_beat* beacon, int64_t received);   //received = esp_timer time it arrived
+  bool isLocked();
+
+  //phase error of the beacons after the first one, since resetStats()
+  long getLastError();              //us
+  long getMaxError();               //us, of the ones that weren't skipped
+  long getAvgError();               //us, average size
+  double getDriftPpm();
+  unsigned long getBeacons();
+  unsigned long getSkipped();
+  void printStats(Print* out);
+  void resetStats();
+
+private:
+  int64_t (*clock)();
+  void readModel(BeatModel* out);
+  void writeModel();
+  void lock(const struct_beat* beacon, int64_t received);
+
+  BeatModel model;                  //loop()'s copy
+  BeatModel published;              //the motion task's copy, behind the sequence lock
+  volatile uint32_t modelSeq = 0;   //odd while loop() writes published
+  int tempo = 120;
+  bool locked = false;
+  int skippedInRow = 0;
+
+  long lastError = 0;
+  long maxError = 0;
+  double errorSum = 0;
+  unsigned long errorCount = 0;
+  unsigned long beacons = 0;
+  unsigned long skipped = 0;
+};
+
+bool beatClockTest();
+
+#endif
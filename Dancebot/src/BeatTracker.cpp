@@ -0,0 +1,351 @@
+//BeatTracker.cpp
+//UT Austin RAS Demobots
+
+#include <math.h>
+#include <string.h>
+#include "BeatTracker.h"
+#ifdef BEAT_TRACKER_HOST
+#include <stdio.h>
+#else
+#include <Arduino.h>
+#endif
+
+//Q15 tables shared by every tracker: the Hann window, and the FFT's twiddles
+static int16_t hannTable[BEAT_FFT_SIZE];
+static int16_t cosTable[BEAT_FFT_SIZE / 2];
+static int16_t sinTable[BEAT_FFT_SIZE / 2];
+static bool tablesReady = false;
+
+static void makeTables() {
+  if (tablesReady) {
+    return;
+  }
+  for (int i = 0; i < BEAT_FFT_SIZE; i++) {
+    hannTable[i] = (int16_t) lround(32767 * 0.5 * (1 - cos(2 * M_PI * i / BEAT_FFT_SIZE)));
+  }
+  for (int i = 0; i < BEAT_FFT_SIZE / 2; i++) {
+    cosTable[i] = (int16_t) lround(32767 * cos(2 * M_PI * i / BEAT_FFT_SIZE));
+    sinTable[i] = (int16_t) lround(32767 * sin(2 * M_PI * i / BEAT_FFT_SIZE));
+  }
+  tablesReady = true;
+}
+
+//log2(x) with 8 fraction bits, straight lines between the powers of 2
+static int32_t log2Q8(uint32_t x) {
+  if (x == 0) {
+    return 0;
+  }
+  int msb = 31 - __builtin_clz(x);
+  uint32_t fraction = msb >= 8 ? (x >> (msb - 8)) & 0xFF : (x << (8 - msb)) & 0xFF;
+  return msb * 256 + fraction;
+}
+
+BeatTracker::BeatTracker() {
+  makeTables();
+  reset();
+}
+
+void BeatTracker::reset() {
+  memset(input, 0, sizeof(input));
+  memset(lastLogMag, 0, sizeof(lastLogMag));
+  memset(onsets, 0, sizeof(onsets));
+  inputPos = 0;
+  hopCount = 0;
+  sampleCount = 0;
+  fluxAverage = 0;
+  frameCount = 0;
+  tempo = 0;
+  candidate = 0;
+  confidence = 0;
+  beatPeriod = 0;
+  beatFrame = -1;
+  tempoUpdates = 0;
+}
+
+void BeatTracker::addSamples(const int16_t* samples, int count) {
+  for (int i = 0; i < count; i++) {
+    input[inputPos] = samples[i];
+    inputPos = (inputPos + 1) & (BEAT_FFT_SIZE - 1);
+    sampleCount++;
+    if (++hopCount == BEAT_HOP) {
+      hopCount = 0;
+      processFrame();
+    }
+  }
+}
+
+
+//ONSETS
+
+//the spectral flux of the last BEAT_FFT_SIZE samples, less its recent average
+void BeatTracker::processFrame() {
+  for (int i = 0; i < BEAT_FFT_SIZE; i++) {
+    re[i] = ((int32_t) input[(inputPos + i) & (BEAT_FFT_SIZE - 1)] * hannTable[i]) >> 15;
+    im[i] = 0;
+  }
+  fft();
+
+  int32_t flux = 0;
+  for (int k = 1; k <= BEAT_FLUX_BINS; k++) {
+    //|X| within 7% without a square root: the larger part plus 3/8 of the smaller
+    uint32_t a = re[k] < 0 ? -re[k] : re[k];
+    uint32_t b = im[k] < 0 ? -im[k] : im[k];
+    uint32_t magnitude = a > b ? a + (b * 3 >> 3) : b + (a * 3 >> 3);
+    int16_t logMag = log2Q8(magnitude + 1);
+    if (logMag > lastLogMag[k - 1]) {flux += logMag - lastLogMag[k - 1];}
+    lastLogMag[k - 1] = logMag;
+  }
+
+  //the first frame has nothing before it, everything in it looks new
+  float strength = 0;
+  if (frameCount > 0) {
+    if (flux > fluxAverage) {strength = (flux - fluxAverage) / 256.0f;}
+    fluxAverage += (flux - fluxAverage) / 16;
+  }
+  onsets[frameCount % BEAT_HISTORY] = strength;
+  frameCount++;
+
+  if (frameCount >= BEAT_HISTORY / 2 && frameCount % BEAT_TEMPO_FRAMES == 0) {
+    updateTempo();
+  }
+}
+
+//radix 2 FFT of re and im in place, the Q15 twiddles keep every stage in 32 bits (input 16 bits, 9 bits of growth)
+void BeatTracker::fft() {
+  //bit reversed order
+  for (int i = 1, j = 0; i < BEAT_FFT_SIZE; i++) {
+    int bit = BEAT_FFT_SIZE >> 1;
+    for (; j & bit; bit >>= 1) {j ^= bit;}
+    j ^= bit;
+    if (i < j) {
+      int32_t swap = re[i];
+      re[i] = re[j];
+      re[j] = swap;
+      swap = im[i];
+      im[i] = im[j];
+      im[j] = swap;
+    }
+  }
+
+  for (int size = 2; size <= BEAT_FFT_SIZE; size <<= 1) {
+    int half = size >> 1;
+    int step = BEAT_FFT_SIZE / size;
+    for (int i = 0; i < BEAT_FFT_SIZE; i += size) {
+      for (int j = 0; j < half; j++) {
+        int32_t wr = cosTable[j * step];
+        int32_t wi = -sinTable[j * step];
+        int a = i + j;
+        int b = a + half;
+        int32_t tr = (int32_t) (((int64_t) re[b] * wr - (int64_t) im[b] * wi) >> 15);
+        int32_t ti = (int32_t) (((int64_t) re[b] * wi + (int64_t) im[b] * wr) >> 15);
+        re[b] = re[a] - tr;
+        im[b] = im[a] - ti;
+        re[a] += tr;
+        im[a] += ti;
+      }
+    }
+  }
+}
+
+float BeatTracker::onset(int age) {
+  return onsets[(frameCount - 1 - age) % BEAT_HISTORY];
+}
+
+
+//TEMPO
+
+//how alike the onsets are lag frames apart, over the history with its average taken out
+float BeatTracker::autocorrelation(int lag) {
+  if (lag >= historyFrames) {
+    return 0;
+  }
+  float sum = 0;
+  for (int i = lag; i < historyFrames; i++) {
+    sum += history[i] * history[i - lag];
+  }
+  return sum / (historyFrames - lag);
+}
+
+//the autocorrelation at lag and its multiples, each counting less. The beat period is seldom a whole number of frames,
+//so the m-th multiple takes the best of the lags within m/2 frames of m * lag
+float BeatTracker::combScore(int lag) {
+  float score = 0;
+  for (int m = 1; m <= BEAT_COMB; m++) {
+    float peak = acf[m * lag];
+    for (int l = m * lag - m / 2; l <= m * lag + m / 2; l++) {
+      if (acf[l] > peak) {peak = acf[l];}
+    }
+    score += peak / m;
+  }
+  return score;
+}
+
+void BeatTracker::updateTempo() {
+  //the history oldest first with its average taken out, so the loops below don't wrap around the ring
+  int frames = frameCount < BEAT_HISTORY ? frameCount : BEAT_HISTORY;
+  float mean = 0;
+  for (int age = 0; age < frames; age++) {
+    mean += onset(age);
+  }
+  mean /= frames;
+  for (int age = 0; age < frames; age++) {
+    history[frames - 1 - age] = onset(age) - mean;
+  }
+  historyFrames = frames;
+  for (int lag = 0; lag < BEAT_ACF_LAGS; lag++) {
+    acf[lag] = autocorrelation(lag);
+  }
+  float energy = acf[0];
+  if (energy <= 0) {
+    return;
+  }
+  tempoUpdates++;
+
+  //the best beat period, leaning towards 120 BPM: half as likely an octave away
+  float scores[BEAT_MAX_LAG + 1];
+  int best = BEAT_MIN_LAG;
+  for (int lag = BEAT_MIN_LAG; lag <= BEAT_MAX_LAG; lag++) {
+    float octaves = log2f(60 * BEAT_FRAME_RATE / lag / 120);
+    scores[lag] = combScore(lag) * expf(-0.69f * octaves * octaves);
+    if (scores[lag] > scores[best]) {best = lag;}
+  }
+  float weights = 0;
+  for (int m = 1; m <= BEAT_COMB; m++) {
+    weights += 1.0f / m;
+  }
+  confidence = (int) (100 * combScore(best) / (energy * weights));
+  if (confidence < BEAT_MIN_CONFIDENCE) {
+    return;
+  }
+
+  //between whole frames, from a parabola through the best score and its neighbours
+  float lag = best;
+  if (best > BEAT_MIN_LAG && best < BEAT_MAX_LAG) {
+    float left = scores[best - 1];
+    float right = scores[best + 1];
+    float curve = left - 2 * scores[best] + right;
+    if (curve < 0) {lag += 0.5f * (left - right) / curve;}
+  }
+  float bpm = 60 * BEAT_FRAME_RATE / lag;
+
+  //a tempo close to the one we have nudges it, a different one has to come up twice
+  if (tempo == 0 || fabsf(bpm / tempo - 1) < 0.04f) {
+    tempo = tempo == 0 ? bpm : tempo + (bpm - tempo) / 4;
+    candidate = 0;
+  }
+  else if (candidate != 0 && fabsf(bpm / candidate - 1) < 0.04f) {
+    tempo = bpm;
+    candidate = 0;
+    beatFrame = -1;
+  }
+  else {
+    candidate = bpm;
+  }
+  beatPeriod = 60 * BEAT_FRAME_RATE / tempo;
+
+  //where the beats fall: the phase whose comb over the last few beats has the most onset strength
+  int phases = (int) beatPeriod;
+  int bestPhase = 0;
+  float bestSum = -1e30f;
+  for (int phase = 0; phase < phases; phase++) {
+    float sum = 0;
+    for (int k = 0; k < BEAT_COMB; k++) {
+      int age = phase + (int) lroundf(k * beatPeriod);
+      if (age < frames) {sum += history[frames - 1 - age];}
+    }
+    if (sum > bestSum) {
+      bestSum = sum;
+      bestPhase = phase;
+    }
+  }
+  float observed = (float) (frameCount - 1 - bestPhase);
+
+  //move the grid halfway to it, so one misplaced onset doesn't throw the beat off
+  if (beatFrame < 0) {
+    beatFrame = observed;
+  }
+  else {
+    float predicted = beatFrame + roundf((observed - beatFrame) / beatPeriod) * beatPeriod;
+    beatFrame = predicted + (observed - predicted) / 2;
+  }
+}
+
+
+//RESULTS
+
+bool BeatTracker::hasTempo() {
+  return tempo != 0;
+}
+
+float BeatTracker::getTempo() {
+  return tempo;
+}
+
+int BeatTracker::getConfidence() {
+  return confidence;
+}
+
+float BeatTracker::getBeatPeriod() {
+  return beatPeriod * BEAT_HOP;
+}
+
+//frame n is centred on sample n * BEAT_HOP (it ends BEAT_FFT_SIZE / 2 samples later)
+int64_t BeatTracker::getLastBeat() {
+  if (beatFrame < 0 || frameCount == 0) {
+    return -1;
+  }
+  float beats = floorf((frameCount - 1 - beatFrame) / beatPeriod);
+  return (int64_t) llroundf((beatFrame + beats * beatPeriod) * BEAT_HOP);
+}
+
+int64_t BeatTracker::getSampleCount() {
+  return sampleCount;
+}
+
+unsigned long BeatTracker::getFrameCount() {
+  return frameCount;
+}
+
+unsigned long BeatTracker::getTempoUpdates() {
+  return tempoUpdates;
+}
+
+
+/* Test
+ * 12 s of clicks at 100 BPM over quiet noise, the tracker should find the tempo and put the beats on the clicks
+ * tools/BeatBench.cpp builds it with BEAT_TRACKER_HOST, it prints with printf there
+ */
+
+#define TEST_BPM 100
+
+bool beatTrackerTest() {
+  static BeatTracker tracker;
+  tracker.reset();
+  uint32_t random = 1;
+  int64_t clickPeriod = BEAT_SAMPLE_RATE * 60 / TEST_BPM;
+  int16_t chunk[160];
+  for (int64_t t = 0; t < 12 * BEAT_SAMPLE_RATE; t += 160) {
+    for (int i = 0; i < 160; i++) {
+      random = random * 1103515245 + 12345;
+      int noise = (int) ((random >> 16) & 0x3FF) - 512;
+      int64_t sinceClick = (t + i) % clickPeriod;
+      int click = sinceClick < 320 ? (int) (noise * 24 * (320 - sinceClick) / 320) : 0;
+      chunk[i] = (int16_t) (noise / 8 + click);
+    }
+    tracker.addSamples(chunk, 160);
+  }
+
+  int64_t beat = tracker.getLastBeat();
+  int64_t offClick = beat % clickPeriod;
+  if (offClick > clickPeriod / 2) {offClick -= clickPeriod;}
+  bool passed = tracker.hasTempo() && fabsf(tracker.getTempo() - TEST_BPM) < 2 && llabs(offClick) < BEAT_SAMPLE_RATE * 30 / 1000;
+#ifdef BEAT_TRACKER_HOST
+  printf("tempo %.2f BPM, confidence %d%%, beat %lld samples off the click\n", tracker.getTempo(), tracker.getConfidence(), (long long) offClick);
+  printf(passed ? "beat tracker test PASSED\n" : "beat tracker test FAILED\n");
+#else
+  Serial.println("tempo " + String(tracker.getTempo()) + " BPM, confidence " + String(tracker.getConfidence()) +
+                 "%, beat " + String((long) offClick) + " samples off the click");
+  Serial.println(passed ? "beat tracker test PASSED" : "beat tracker test FAILED");
+#endif
+  return passed;
+}
@@ -0,0 +1,96 @@
+/* BeatTracker.h
+ * UT Austin RAS Demobots
+ * Finds the tempo and the beats of music as it streams in, the mothership uses it on its microphone (see Microphone.h)
+ *
+ * Samples come in as 16 bit mono at BEAT_SAMPLE_RATE. Every BEAT_HOP samples the last BEAT_FFT_SIZE are windowed and
+ * put through a fixed point FFT, and the onset strength of that frame is the spectral flux: how much louder each
+ * frequency got since the frame before, on a log scale, added up. Drums and note starts make peaks in it.
+ * Every BEAT_TEMPO_FRAMES frames the last BEAT_HISTORY frames of onset strength are autocorrelated, and a comb filter
+ * (the autocorrelation at a beat period plus at 2, 3 and 4 times it) picks the beat period between BEAT_MIN_BPM and
+ * BEAT_MAX_BPM, leaning towards tempos near 120 BPM so it doesn't pick half or double the tempo.
+ * Then another comb over the onsets at that period finds where the beats fall, and the beat grid is moved towards it.
+ * A new tempo has to come up twice in a row before it replaces the old one, so one odd bar doesn't change it.
+ *
+ * Times are sample numbers since the tracker started, the caller knows when the samples were taken.
+ * Nothing is allocated, everything is in fixed tables. No Arduino functions are used, so tools/BeatBench.cpp
+ * can run it on a PC against WAV files, see there for how well it does and what each frame costs.
+ */
+
+#ifndef BEATTRACKER
+#define BEATTRACKER
+
+#include <stdint.h>
+
+#define BEAT_SAMPLE_RATE 16000
+#define BEAT_FFT_BITS 9
+#define BEAT_FFT_SIZE (1 << BEAT_FFT_BITS)     //32 ms
+#define BEAT_HOP 256                           //16 ms between frames
+#define BEAT_FLUX_BINS 128                     //bins up to 4 kHz count for the onsets
+#define BEAT_HISTORY 512                       //frames of onset strength kept for the tempo, about 8 s
+#define BEAT_TEMPO_FRAMES 32                   //frames between tempo updates, about 0.5 s
+#define BEAT_MIN_BPM 60
+#define BEAT_MAX_BPM 180
+#define BEAT_COMB 4                            //multiples of the beat period in the combs
+#define BEAT_MIN_CONFIDENCE 30                 //share of the onset strength that repeats at the beat period, %, to count as a tempo
+
+//frames per second and the beat periods searched, in frames
+#define BEAT_FRAME_RATE ((float) BEAT_SAMPLE_RATE / BEAT_HOP)
+#define BEAT_MIN_LAG ((int) (60 * BEAT_FRAME_RATE / BEAT_MAX_BPM))
+#define BEAT_MAX_LAG ((int) (60 * BEAT_FRAME_RATE / BEAT_MIN_BPM + 1))
+#define BEAT_ACF_LAGS (BEAT_COMB * BEAT_MAX_LAG + BEAT_COMB / 2 + 1)
+
+class BeatTracker {
+public:
+  BeatTracker();
+  void reset();
+
+  void addSamples(const int16_t* samples, int count);
+
+  bool hasTempo();                //a confident tempo was found
+  float getTempo();               //BPM, 0 = none yet
+  int getConfidence();            //%, see BEAT_MIN_CONFIDENCE
+  float getBeatPeriod();          //samples
+  int64_t getLastBeat();          //sample number of the latest beat so far, -1 = none yet
+  int64_t getSampleCount();       //samples added since reset()
+  unsigned long getFrameCount();
+  unsigned long getTempoUpdates();
+
+private:
+  void processFrame();
+  void fft();
+  void updateTempo();
+  float combScore(int lag);
+  float autocorrelation(int lag);
+  float onset(int age);           //onset strength age frames ago
+
+  //the last BEAT_FFT_SIZE samples
+  int16_t input[BEAT_FFT_SIZE];
+  int inputPos = 0;               //next sample goes here
+  int hopCount = 0;               //samples since the last frame
+  int64_t sampleCount = 0;
+
+  //FFT work space and the last frame's log magnitudes
+  int32_t re[BEAT_FFT_SIZE];
+  int32_t im[BEAT_FFT_SIZE];
+  int16_t lastLogMag[BEAT_FLUX_BINS];
+  int32_t fluxAverage = 0;        //Q8
+
+  //onset strength of each frame, a ring buffer
+  float onsets[BEAT_HISTORY];
+  unsigned long frameCount = 0;
+  float history[BEAT_HISTORY];    //updateTempo()'s copy of the onsets, oldest first, less their average
+  int historyFrames = 0;
+  float acf[BEAT_ACF_LAGS];        //autocorrelation of the onsets, by lag
+
+  //tempo and beat grid
+  float tempo = 0;
+  float candidate = 0;            //a tempo that came up once
+  int confidence = 0;
+  float beatPeriod = 0;           //frames
+  float beatFrame = -1;           //frame of a beat on the grid, -1 = none yet
+  unsigned long tempoUpdates = 0;
+};
+
+bool beatTrackerTest();
+
+#endif
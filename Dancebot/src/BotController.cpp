@@ -0,0 +1,615 @@
+/* ESP32 Bot Controller for DanceBot
+ *
+ * Used by every dancebot except the mothership (see HardwareProfile.h)
+ * Receives dance moves, dance routines, servo trims and live tuning changes from the mothership over ESP-NOW,
+ * and answers battery level requests
+ *
+ * Once joined it sends the mothership telemetry every TELEMETRY_INTERVAL_MS (see FleetTelemetry.h),
+ * and its motion clock follows the mothership's beat beacons (see BeatClock.h)
+ *
+ * The bot finds the mothership by itself: it broadcasts a hello until the mothership sends back its id,
+ * then only takes dance moves from that mothership (see Messages.h)
+ *
+ * Resources
+ *
+ * Arduino ESP32 and ESP32Servo Docs
+ * https://github.com/espressif/arduino-esp32
+ * https://www.arduinolibraries.info/libraries/esp32-servo
+ *
+ * ESP-NOW
+ * https://docs.espressif.com/projects/esp-idf/en/latest/esp32/api-reference/network/esp_now.html
+ */
+ 
+#include "HardwareProfile.h"
+#if !IS_MOTHERSHIP
+
+#include <WiFi.h>
+#include <esp_now.h>
+#include <esp_wifi.h>
+#include <esp_system.h>
+#include "BotController.h"
+#include "DancingServos.h"
+#include "PowerController.h"
+#include "RoutineStore.h"
+#include "TrimStore.h"
+#include "ReliableLink.h"
+
+
+void receiveRoutineChunk(const uint8_t *incomingData);
+void storeReceivedRoutine();
+void sendBatteryLevel();
+void loopJoin();
+void loopBeat();
+void loopTune();
+
+int dancebotID;
+
+/* Data Transmission*/
+esp_now_peer_info_t peerInfo;
+uint8_t broadcastAddress[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+uint8_t address[6];             //mothership ESP32 MAC address, from its SetID message
+uint8_t myAddress[6];           //this bot's MAC address
+struct_message transmitMessage; //contains info that will be transmitted
+struct_message receivedMessage; //contains info that will be received
+int rcvFlag; //high when we received a message
+int setIDOnce = 1;
+int reportedPowerTier = POWER_FULL;  //last power tier sent to the mothership
+
+//joining the mothership's fleet
+#define HELLO_INTERVAL_MS 1000          //hello broadcasts while looking for the mothership
+#define HEARTBEAT_INTERVAL_MS 5000      //hellos to the mothership after joining, well under FLEET_TIMEOUT_MS
+volatile bool idReceived = false;       //SetID arrived, loopJoin() adds the mothership as a peer
+bool joined = false;
+unsigned long lastHello = 0;
+
+//the radio keeps listening while the mothership's beacons come, see PowerController.h
+#define FLEET_LISTEN_MS 5000
+unsigned long lastHeard = 0;            //when we joined or the last beacon came
+
+//the mothership resends commands until we ack them, drop the copies
+DuplicateFilter duplicates;
+
+//fleet tempo, from the newest command that had one, so a resent older command doesn't change it back
+volatile int joinTempo = 0;             //tempo in the SetID, loopJoin() sets it
+uint16_t tempoSeq = 0;                  //seq of the command the tempo came from, 0 = none yet
+
+//beat beacons from onDataRecv with when they arrived, loopBeat() gives them to the BeatClock
+#define BEACON_QUEUE_SIZE 4
+typedef struct BeaconInfo {
+  struct_beat beacon;
+  int64_t received;             //esp_timer time
+} BeaconInfo;
+BeaconInfo beaconQueue[BEACON_QUEUE_SIZE];
+volatile int beaconHead = 0;
+volatile int beaconTail = 0;
+
+//live tuning frames from onDataRecv, loopTune() applies them (see the mothership's "/tune")
+#define TUNE_QUEUE_SIZE 4
+struct_tune tuneQueue[TUNE_QUEUE_SIZE];
+volatile int tuneHead = 0;
+volatile int tuneTail = 0;
+MoveShape tunedShape = {{0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, BEATS(4)};   //the mothership's, as far as we heard
+uint16_t tuneSeq = 0;                   //seq of the last frame taken
+bool tuneSeqValid = false;
+bool tuningMove = false;                //dancing the tuned move, the changes go to it until another command comes
+
+//telemetry, the worst of each TELEMETRY_INTERVAL_MS
+unsigned long lastTelemetry = 0;
+unsigned long lastLoop = 0;
+unsigned long maxLoopGap = 0;           //ms between handleDanceMove() calls
+volatile unsigned long receivedMillis = 0;  //when the last command arrived
+unsigned long maxCommandLag = 0;        //ms from a command arriving to starting it
+volatile int8_t mothershipRssi = 0;     //dBm of the last frame from the mothership
+int currentMove = STOP;
+
+//DancingServos object
+DancingServos* dance_bot;
+
+//PowerController object
+PowerController* power;
+
+//saved servo trims
+TrimStore* trimStore;
+
+//uploaded dance routines
+RoutineStore* routineStore;
+uint8_t receivedRoutine[ROUTINE_MAX_SIZE];
+uint32_t receivedRoutineCrc = 0;
+uint32_t receivedRoutineChunks = 0;     //bit i set when chunk i has arrived
+int routineReady = 0;                   //length of a whole routine that arrived and passed its crc, 0 = none
+
+void printMACAddress(){
+  Serial.println(WiFi.macAddress());
+}
+
+//ESP-NOW sends since boot and the ones that weren't delivered, counted in the Wi-Fi task and printed from loop() ('j' over Serial)
+//printing each one from the callback would fill Serial at 115200 baud
+volatile uint32_t sendCount = 0;
+volatile uint32_t sendFailures = 0;
+uint32_t sendCountReset = 0;      //the counts at resetSendStats(), only the Wi-Fi task writes the counts
+uint32_t sendFailuresReset = 0;
+
+//callback when data is sent
+void onDataSent(const uint8_t *mac_addr, esp_now_send_status_t status) {
+  sendCount++;
+  if (status != ESP_NOW_SEND_SUCCESS) {
+    sendFailures++;
+  }
+}
+
+void printSendStats(Print* out) {
+  out->println("ESP-NOW sends: " + String(sendCount - sendCountReset) + " not delivered: " + String(sendFailures - sendFailuresReset));
+}
+
+void resetSendStats() {
+  sendCountReset = sendCount;
+  sendFailuresReset = sendFailures;
+}
+
+//sees every frame the radio receives, keeps the signal strength of the mothership's
+//ESP-NOW frames are 802.11 action frames, the sender's MAC starts at byte 10
+void onPromiscuousRecv(void* buf, wifi_promiscuous_pkt_type_t type) {
+  if (type != WIFI_PKT_MGMT || !joined) {
+    return;
+  }
+  const wifi_promiscuous_pkt_t* pkt = (const wifi_promiscuous_pkt_t*) buf;
+  if (memcmp(pkt->payload + 10, address, 6) == 0) {
+    mothershipRssi = pkt->rx_ctrl.rssi;
+  }
+}
+
+//when called, takes in received data from transmitter and sets flag (used for dance moves)
+void onDataRecv(const uint8_t * mac, const uint8_t *incomingData, int len){
+  //tune frames only have the deltas they use, no other message starts with status Tune and has that length
+  int status = None;
+  memcpy(&status, incomingData, min(len, (int) sizeof(status)));
+  if (len >= (int) TUNE_HEADER_SIZE && len <= (int) sizeof(struct_tune) && status == Tune) {
+    int next = (tuneTail + 1) % TUNE_QUEUE_SIZE;
+    if (joined && memcmp(mac, address, 6) == 0 && next != tuneHead &&
+        len == (int) (TUNE_HEADER_SIZE + incomingData[offsetof(struct_tune, count)] * sizeof(TuneDelta))) {
+      memset(&tuneQueue[tuneTail], 0, sizeof(struct_tune));
+      memcpy(&tuneQueue[tuneTail], incomingData, len);
+      tuneTail = next;
+    }
+    return;
+  }
+  //the time first, the beacon's phase error is measured from it
+  if (len == sizeof(struct_beat)) {
+    int64_t received = esp_timer_get_time();
+    int next = (beaconTail + 1) % BEACON_QUEUE_SIZE;
+    if (joined && memcmp(mac, address, 6) == 0 && next != beaconHead) {
+      memcpy(&beaconQueue[beaconTail].beacon, incomingData, sizeof(struct_beat));
+      beaconQueue[beaconTail].received = received;
+      beaconTail = next;
+    }
+    return;
+  }
+  if (len == sizeof(struct_routine_chunk)) {
+    if (joined && memcmp(mac, address, 6) == 0) {
+      receiveRoutineChunk(incomingData);
+    }
+    return;
+  }
+  if (len != sizeof(struct_message)) {
+    return;
+  }
+
+  //the other bots' hellos and messages for them are broadcast too
+  struct_message message;
+  memcpy(&message, incomingData, sizeof(message));
+  if (message.status == Hello) {
+    return;
+  }
+  if (memcmp(message.target, broadcastAddress, 6) != 0 && memcmp(message.target, myAddress, 6) != 0) {
+    return;
+  }
+
+  if(message.status == SetID){
+    Serial.print("I set my own ID: "); Serial.println(message.id);
+    dancebotID = message.id;
+    memcpy(address, mac, 6);
+    duplicates.reset();         //a new SetID means the mothership started over, so do its seqs
+    joinTempo = message.tempo;
+    setIDOnce = 0;
+    idReceived = true;
+    return;
+  }
+  //only take dance moves from our mothership
+  if (!joined || memcmp(mac, address, 6) != 0) {
+    return;
+  }
+
+  //ack every copy, the ack for the first one may have been lost
+  if (message.seq != 0) {
+    struct_message ack;
+    memset(&ack, 0, sizeof(ack));
+    ack.id = dancebotID;
+    ack.status = Ack;
+    ack.seq = message.seq;
+    esp_now_send(address, (uint8_t *) &ack, sizeof(ack));
+  }
+  if (!duplicates.accept(&message)) {
+    return;
+  }
+
+  memcpy(&receivedMessage, &message, sizeof(receivedMessage));
+  Serial.println("Received message...");
+  Serial.print("Bytes received: ");
+  Serial.println(len);
+  Serial.print("Status is: ");
+  Serial.println(receivedMessage.status);
+  Serial.println("Message is: ");
+  Serial.println(receivedMessage.character);
+  Serial.println();
+
+  //if transmitter requested battery level, send value, our ID, and acknowledgement
+  if(receivedMessage.batteryFlag){
+    sendBatteryLevel();
+  }
+  receivedMillis = millis();
+  rcvFlag = 1;
+}
+
+//send battery level, power tier and our ID to the mothership
+void sendBatteryLevel() {
+  Serial.println("Sending battery level...");
+  transmitMessage.id = dancebotID;
+#if HAS_POWER_CONTROLLER
+  transmitMessage.batteryLevel = power->getBatteryPercentage();
+#else
+  transmitMessage.batteryLevel = 100;
+#endif
+  transmitMessage.powerTier = dance_bot->getPowerTier();
+  transmitMessage.status = BattLevel;
+  esp_now_send(address, (uint8_t *) &transmitMessage, sizeof(transmitMessage));
+}
+
+/* loopJoin
+ * broadcast a hello every HELLO_INTERVAL_MS until the mothership sends our id,
+ * then say hello to the mothership every HEARTBEAT_INTERVAL_MS so it knows we are still here
+ * if the mothership restarts it answers the next hello with a new id
+ */
+void loopJoin() {
+  if (idReceived) {
+    idReceived = false;
+    if (!esp_now_is_peer_exist(address)) {
+      memcpy(peerInfo.peer_addr, address, sizeof(peerInfo.peer_addr));
+      peerInfo.channel = 0; 
+      peerInfo.encrypt = false;
+      if (esp_now_add_peer(&peerInfo) != ESP_OK){
+        Serial.println("Failed to add mothership peer");
+        return;
+      }
+    }
+    joined = true;
+    lastHeard = millis();
+    tempoSeq = 0;
+    if (joinTempo != 0) {dance_bot->setTempo(joinTempo);}
+    Serial.println("Joined the mothership as Dancebot " + String(dancebotID));
+  }
+
+  unsigned long t = millis();
+  if (t - lastHello >= (joined ? HEARTBEAT_INTERVAL_MS : HELLO_INTERVAL_MS)) {
+    lastHello = t;
+    struct_message hello;
+    memset(&hello, 0, sizeof(hello));
+    hello.id = joined ? dancebotID : -1;
+    hello.status = Hello;
+    esp_now_send(joined ? address : broadcastAddress, (uint8_t *) &hello, sizeof(hello));
+  }
+}
+
+bool isFollowingFleet() {
+  return joined && millis() - lastHeard < FLEET_LISTEN_MS;
+}
+
+//follow the mothership's beat beacons
+void loopBeat() {
+  BeatClock* clock = dance_bot->getBeatClock();
+  while (beaconHead != beaconTail) {
+    BeaconInfo* info = &beaconQueue[beaconHead];
+    if (clock != NULL && info->beacon.status == Beat) {
+      clock->beacon(&info->beacon, info->received);
+      lastHeard = millis();
+    }
+    beaconHead = (beaconHead + 1) % BEACON_QUEUE_SIZE;
+  }
+}
+
+/* loopTune
+ * apply the mothership's tuning frames for this bot: each delta changes tunedShape, and the move that is playing
+ * if it is the tuned move, from its next sample (see DancingServos::tuneMove())
+ * a start frame has every parameter and starts the tuned move, also after a mothership restart, so its seq is always taken
+ */
+void loopTune() {
+  while (tuneHead != tuneTail) {
+    struct_tune* frame = &tuneQueue[tuneHead];
+    bool start = (frame->flags & TUNE_START) != 0;
+    bool forUs = dancebotID >= 0 && dancebotID < (int) (8 * sizeof(frame->bots)) && (frame->bots >> dancebotID & 1) != 0;
+    if (forUs && (start || !tuneSeqValid || (int16_t) (frame->seq - tuneSeq) > 0)) {
+      tuneSeq = frame->seq;
+      tuneSeqValid = true;
+      for (int i = 0; i < frame->count && i < TUNE_MAX_DELTAS; i++) {
+        //a MoveShape only has the leg joints, the first NUM_LEG_JOINTS of the bot's NUM_JOINTS
+        //values from the radio are clamped like the mothership's sliders, a period of 0 would stop the motion task
+        TuneDelta* delta = &frame->deltas[i];
+        if (delta->joint >= NUM_LEG_JOINTS) {
+          continue;
+        }
+        int value = clampTuneValue(delta->param, delta->value);
+        switch (delta->param) {
+          case TUNE_AMP:    tunedShape.amp[delta->joint] = value; break;
+          case TUNE_OFF:    tunedShape.off[delta->joint] = value; break;
+          case TUNE_PH0:    tunedShape.ph0[delta->joint] = value; break;
+          case TUNE_PERIOD: tunedShape.period = value; break;
+          default:          continue;
+        }
+        if (tuningMove && !start) {
+          dance_bot->tuneMove(delta->joint, delta->param, value);
+        }
+      }
+      if (start) {
+        tuningMove = true;
+        dance_bot->enableDanceRoutine(false);
+        dance_bot->setQueueMoves(false);
+        dance_bot->startShape(tunedShape, -1);
+      }
+    }
+    tuneHead = (tuneHead + 1) % TUNE_QUEUE_SIZE;
+  }
+}
+
+/* loopTelemetry
+ * send what handleDanceMove() measured to the mothership every TELEMETRY_INTERVAL_MS
+ */
+void loopTelemetry() {
+  unsigned long t = millis();
+  if (!joined || t - lastTelemetry < TELEMETRY_INTERVAL_MS) {
+    return;
+  }
+  lastTelemetry = t;
+
+  struct_telemetry telemetry;
+  memset(&telemetry, 0, sizeof(telemetry));
+  telemetry.status = Telemetry;
+  telemetry.id = dancebotID;
+#if HAS_POWER_CONTROLLER
+  telemetry.sample.battery = power->getBatteryPercentage();
+#else
+  telemetry.sample.battery = 100;
+#endif
+  telemetry.sample.danceMove = currentMove;
+  telemetry.sample.rssi = mothershipRssi;
+  telemetry.sample.jitter = maxLoopGap > 255 ? 255 : maxLoopGap;
+  telemetry.sample.lag = maxCommandLag > 65535 ? 65535 : maxCommandLag;
+  telemetry.sample.powerTier = dance_bot->getPowerTier();
+  telemetry.sample.resetReason = esp_reset_reason();
+  esp_now_send(address, (uint8_t *) &telemetry, sizeof(telemetry));
+
+  maxLoopGap = 0;
+  maxCommandLag = 0;
+}
+
+//put a routine chunk in place, storing the routine in flash is left to the main loop
+void receiveRoutineChunk(const uint8_t *incomingData) {
+  static struct_routine_chunk chunk;
+  memcpy(&chunk, incomingData, sizeof(chunk));
+
+  if (routineReady || chunk.status != RoutineChunk) {
+    return;
+  }
+  if (chunk.routineLength > ROUTINE_MAX_SIZE || chunk.length > ROUTINE_CHUNK_SIZE ||
+      chunk.offset + chunk.length > chunk.routineLength || chunk.offset % ROUTINE_CHUNK_SIZE != 0 ||
+      routineCrc32(chunk.data, chunk.length) != chunk.chunkCrc) {
+    Serial.println("Dropped bad routine chunk");
+    return;
+  }
+
+  //a different routine crc means a new upload
+  if (chunk.routineCrc != receivedRoutineCrc) {
+    receivedRoutineCrc = chunk.routineCrc;
+    receivedRoutineChunks = 0;
+  }
+  memcpy(receivedRoutine + chunk.offset, chunk.data, chunk.length);
+  receivedRoutineChunks |= 1 << (chunk.offset / ROUTINE_CHUNK_SIZE);
+
+  int numChunks = (chunk.routineLength + ROUTINE_CHUNK_SIZE - 1) / ROUTINE_CHUNK_SIZE;
+  if (receivedRoutineChunks == (1u << numChunks) - 1) {
+    if (routineCrc32(receivedRoutine, chunk.routineLength) == receivedRoutineCrc) {
+      routineReady = chunk.routineLength;
+    }
+    receivedRoutineChunks = 0;
+    receivedRoutineCrc = 0;
+  }
+}
+
+//store a received routine and add it to the dance routines
+void storeReceivedRoutine() {
+  const RoutineHeader* stored = routineStore->storeRoutine(receivedRoutine, routineReady, dance_bot);
+  if (stored != NULL) {
+    Serial.println("Stored routine " + String(stored->name) + " in " + String(routineStore->getLastWriteMicros()) + " us");
+  }
+  else {
+    Serial.println("Failed to store received routine");
+  }
+  routineReady = 0;
+}
+
+/* Setup Functions */
+
+/* setupESPNOW
+ * Sets up transmit and receive communication with Mothership
+ */
+int setupESPNOW(DancingServos* _dance_bot, PowerController* _power, RoutineStore* _routineStore, TrimStore* _trimStore){
+  WiFi.mode(WIFI_STA);
+  // Init ESP-NOW
+  if (esp_now_init() != ESP_OK) {
+    Serial.println("Error initializing ESP-NOW");
+    return 0;
+  }
+  
+  esp_now_register_send_cb(onDataSent); //func called when we send data
+  esp_now_register_recv_cb(onDataRecv); //func called when we receive data
+
+  //hellos are broadcast until we know the mothership's address
+  memcpy(peerInfo.peer_addr, broadcastAddress, sizeof(peerInfo.peer_addr));
+  peerInfo.channel = 0; 
+  peerInfo.encrypt = false;
+  WiFi.macAddress(myAddress);
+
+  //signal strength for telemetry
+  esp_wifi_set_promiscuous(true);
+  esp_wifi_set_promiscuous_rx_cb(onPromiscuousRecv);
+
+  // Add peer       
+  if (esp_now_add_peer(&peerInfo) != ESP_OK){
+    Serial.println("Failed to add peer");
+    return 0;
+  }
+
+  //dance_bot and power object in this file points to object in main file
+  dance_bot = _dance_bot; 
+  power = _power;
+  routineStore = _routineStore;
+  trimStore = _trimStore;
+
+  Serial.println("Finished ESPNOW init");
+  return 1;
+}
+
+/* Main Loop */
+
+//start the dance move received from the mothership, call this each loop()
+void handleDanceMove() {
+  unsigned long t = millis();
+  if (lastLoop != 0 && t - lastLoop > maxLoopGap) {
+    maxLoopGap = t - lastLoop;
+  }
+  lastLoop = t;
+
+  loopJoin();
+  loopBeat();
+  loopTune();
+
+  if (routineReady) {
+    storeReceivedRoutine();
+  }
+
+  //let the mothership know when the battery gets low enough to change how we dance
+  if (joined && dance_bot->getPowerTier() != reportedPowerTier) {
+    reportedPowerTier = dance_bot->getPowerTier();
+    sendBatteryLevel();
+  }
+
+  //if we have received a message, do corresponding dance move
+  if(rcvFlag){
+    rcvFlag = 0;
+    unsigned long lag = millis() - receivedMillis;
+    if (lag > maxCommandLag) {maxCommandLag = lag;}
+
+    //the tempo changes before the move starts, so the move starts at it
+    if (receivedMessage.tempo != 0 && (tempoSeq == 0 || (int16_t) (receivedMessage.seq - tempoSeq) > 0)) {
+      tempoSeq = receivedMessage.seq;
+      dance_bot->setTempo(receivedMessage.tempo);
+    }
+    if (receivedMessage.status == SetTempo) {
+      return;
+    }
+
+    //new trims from the mothership, the next setPos() uses them
+    if (receivedMessage.status == SetTrims) {
+      int* trims = receivedMessage.trims;
+      dance_bot->setTrims(trims[0], trims[1], trims[2], trims[3]);
+      trimStore->saveTrims(trims);
+      if (!dance_bot->isOscillating()) {
+        dance_bot->position0();
+      }
+      return;
+    }
+
+    //the mothership deleted an uploaded routine, the name is in character
+    if (receivedMessage.status == DeleteRoutine) {
+      receivedMessage.character[sizeof(receivedMessage.character) - 1] = 0;
+      routineStore->deleteRoutine(receivedMessage.character, dance_bot);
+      return;
+    }
+
+    tuningMove = false;
+    dance_bot->setQueueMoves(receivedMessage.status == QueueMove);
+    currentMove = receivedMessage.danceMove;
+    switch(receivedMessage.danceMove) {
+      case STOP:
+        dance_bot->stopOscillation();
+        dance_bot->enableDanceRoutine(false);
+        break;
+
+      case RESET: 
+        dance_bot->position0();
+        break;
+    
+      case WALK: 
+        dance_bot->walk(-1, 1500, false);
+        break;
+    
+      case HOP: 
+        dance_bot->hop(25, -1);
+        break;
+    
+      case WIGGLE: 
+        dance_bot->wiggle(30, -1);
+        break;
+    
+      case ANKLES: 
+        dance_bot->themAnkles(-1);
+        break;
+
+    
+    // dev notes: new moves below:
+      case LEFT_HEELTOE: 
+        dance_bot->heel_toe(-1, true);
+        break;
+
+      case RIGHT_HEELTOE: 
+        dance_bot->heel_toe(-1, false);
+        break;
+
+      case LEFT_STANK: 
+        dance_bot->stank(-1, true);
+        break;
+
+      case RIGHT_STANK: 
+        dance_bot->stank(-1, false);
+        break;
+
+      case BWALK: 
+        dance_bot->walk(-1, 1500, false);
+        break;
+
+      case WAVE: 
+        dance_bot->wave(40, -1);
+        break;
+
+      default:
+        //dance routines are sent as DEMO1 + index with the routine name in character
+        if (receivedMessage.danceMove >= DEMO1) {
+          receivedMessage.character[sizeof(receivedMessage.character) - 1] = 0;
+          int routine = dance_bot->findDanceRoutine(receivedMessage.character);
+          if (routine == -1) {routine = receivedMessage.danceMove - DEMO1;}
+          if (routine < dance_bot->getNumDanceRoutines()) {
+            dance_bot->setDanceRoutine(routine);
+            dance_bot->enableDanceRoutine(true);
+            break;
+          }
+        }
+        Serial.println("Dance move not recognized, ERROR too lit for this robot");
+        break;
+    }
+    dance_bot->setQueueMoves(false);
+  }
+//   else {
+//     Serial.println("Dance move not recognized, ERROR too lit for this robot");
+//     return;
+//   }
+}
+
+#endif
@@ -0,0 +1,25 @@
+/* BotController.h
+ * UT Austin RAS Demobots
+ * Every dancebot except the mothership: receives dance moves, routines and trims from the mothership over ESP-NOW
+ *
+ * Call handleDanceMove each loop() to start the last move that was received,
+ * and loopTelemetry often enough to report to the mothership every TELEMETRY_INTERVAL_MS.
+ */
+
+#ifndef BOTCONTROLLER
+#define BOTCONTROLLER
+
+#include "DancingServos.h"
+#include "PowerController.h"
+#include "RoutineStore.h"
+#include "TrimStore.h"
+#include "Messages.h"
+
+int setupESPNOW(DancingServos* _dance_bot, PowerController* _power, RoutineStore* _routineStore, TrimStore* _trimStore);
+void handleDanceMove();
+void loopTelemetry();
+bool isFollowingFleet();    //joined, and a beat beacon came in the last FLEET_LISTEN_MS
+void printSendStats(Print* out);    //ESP-NOW sends and how many weren't delivered, since resetSendStats()
+void resetSendStats();
+
+#endif
@@ -0,0 +1,1546 @@
+/* DancingServos.cpp
+ * UT Austin RAS Demobots
+ * TO PROGRAM NEW DANCE MOVE FUNCTION
+ *    pick the parameters for the oscillating movement
+ *    call startOscillation()
+ *    (look at walk() for an example)
+ */
+
+#include <Arduino.h>
+#include "DancingServos.h"
+
+#if HAS_NEOPIXEL
+// Which pin on the Arduino is connected to the NeoPixels?
+#define LED_PIN1     25
+#define LED_PIN2     26
+
+// How many NeoPixels are attached to the Arduino?
+#define LED_COUNT  1
+
+// NeoPixel brightness, 0 (min) to 255 (max)
+#define BRIGHTNESS 50 // Set BRIGHTNESS to about 1/5 (max = 255)
+
+Adafruit_NeoPixel pixels;
+#endif
+
+//copy startOscillation() inputs into a DanceMove
+static void setMove(DanceMove* move, int amp[NUM_JOINTS], int off[NUM_JOINTS], double ph0[NUM_JOINTS], int period, float cycles) {
+  for (int i = 0; i < NUM_JOINTS; i++) {
+    move->amp[i] = amp[i];
+    move->off[i] = off[i];
+    move->ph0[i] = ph0[i];
+  }
+  move->period = period;
+  move->cycles = cycles;
+  move->taskSpace = false;
+}
+
+#define NUM_STEPS(steps) (sizeof(steps) / sizeof(DanceStep))
+
+//DANCE ROUTINES
+//{move, arg, cycles}, see DanceStep
+//to add a dance routine, add its steps here and an entry in builtinRoutines
+
+static constexpr DanceStep demo1Steps[] = {
+  {ANKLES, 0, 1},
+  {WIGGLE, 30, 2},
+  {HOP, 25, 1},
+  {WALK, BEATS(3), 4},
+  {HOP, 18, 1},
+  {BWALK, BEATS(3), 2},
+};
+
+static constexpr DanceStep demo2Steps[] = {
+  {WALK, BEATS(3), 2},
+  {BWALK, BEATS(3), 2},
+  {ANKLES, 0, 1},
+  {WIGGLE, 30, 1},
+  {HOP, 25, 2},
+};
+
+// dev notes: new demos for showcase?
+static constexpr DanceStep demo3Steps[] = {
+  // dev notes: walk is now reverse?
+  {WALK, BEATS(3), 2},
+  {LEFT_HEELTOE, 0, 1},
+  {RIGHT_HEELTOE, 0, 1},
+  {BWALK, BEATS(3), 2},
+  {LEFT_STANK, 0, 1},
+  {RIGHT_STANK, 0, 1},
+  {WAVE, 40, 1},
+  {HOP, 40, 2},
+  {WIGGLE, 30, 2},
+};
+
+static constexpr DanceStep demo4Steps[] = {
+  {WALK, BEATS(3), 1},
+  {BWALK, BEATS(3), 1},
+  {WIGGLE, 30, 2},
+  {WAVE, 40, 2},
+  {HOP, 40, 2},
+  {ANKLES, 0, 1},
+};
+
+//dance scripts, see DanceScript in DancingServos.h
+//walks faster each time round, and keeps the hops small once the battery is low
+static bool demo5Script(DanceScript* s) {
+  SCRIPT_BEGIN(s);
+  for (s->i = 0; s->i < 3; s->i++) {
+    SCRIPT_MOVE(s, WALK, BEATS(3) - s->i * 250, 2);
+    SCRIPT_MOVE(s, WIGGLE, 30, 1);
+  }
+  SCRIPT_MOVE(s, HOP, s->powerTier == POWER_FULL ? 40 : 20, 2);
+  SCRIPT_MOVE(s, WAVE, 40, 1);
+  SCRIPT_MOVE(s, BWALK, BEATS(3), 3);
+  SCRIPT_END(s);
+}
+
+static constexpr DanceRoutine builtinRoutines[] = {
+  {"Demo 1", demo1Steps, NUM_STEPS(demo1Steps), NULL},
+  {"Demo 2", demo2Steps, NUM_STEPS(demo2Steps), NULL},
+  {"Demo 3", demo3Steps, NUM_STEPS(demo3Steps), NULL},
+  {"Demo 4", demo4Steps, NUM_STEPS(demo4Steps), NULL},
+  {"Demo 5", NULL, 0, demo5Script},
+};
+
+//POWER TIERS
+//moves are scaled when they start: amplitudes by ampPercent, periods by periodPercent
+//smaller, slower moves turn the servos slower, so they draw less current (see getLoadCurrent)
+typedef struct PowerTier {
+  int minBattery;       //% battery level where this tier starts
+  int ampPercent;
+  int periodPercent;
+  bool ankles;          //false = ankles hold their offset
+} PowerTier;
+
+static constexpr PowerTier powerTiers[] = {
+  {40, 100, 100, true},     //POWER_FULL
+  {20, 80, 120, true},      //POWER_SAVE
+  {10, 60, 150, true},      //POWER_LOW
+  {0, 60, 150, false},      //POWER_CRITICAL
+};
+
+//SETUP FUNCTIONS
+DancingServos::DancingServos(int hL, int hR, int aL, int aR) {
+  isOsc = false;
+  pins[0] = hL;
+  pins[1] = hR;
+  pins[2] = aL;
+  pins[3] = aR;
+  for (int i = 0; i < NUM_JOINTS; i++) {
+    osc[i] = new Oscillator();
+    if (i < NUM_LEG_JOINTS) {
+      osc[i]->attach(pins[i]);
+    }
+    else {
+      pins[i] = -1;
+    }
+    osc[i]->setJoint(i);
+  }
+  samplePeriod = osc[0]->getSamplePeriod();
+  kinematics = new Kinematics(&dancebotProfile);
+  motionLock = xSemaphoreCreateRecursiveMutex();
+
+  for (unsigned int i = 0; i < sizeof(builtinRoutines) / sizeof(DanceRoutine); i++) {
+    const DanceRoutine* routine = &builtinRoutines[i];
+    addRoutine(routine->name, routine->steps, routine->numSteps, routine->script);
+  }
+}
+
+void DancingServos::attachJoint(int joint, int pin) {
+  if (joint < NUM_LEG_JOINTS || joint >= NUM_JOINTS) {
+    return;
+  }
+  pins[joint] = pin;
+  osc[joint]->attach(pin);
+}
+
+//set the trims of each motor for calibration
+void DancingServos::setTrims(int tHL, int tHR, int tAL, int tAR) {
+  if (fromOtherTask()) {
+    MotionCommand command = {};
+    command.kind = MOTION_TRIMS;
+    command.values[0] = tHL;
+    command.values[1] = tHR;
+    command.values[2] = tAL;
+    command.values[3] = tAR;
+    sendCommand(&command);
+    return;
+  }
+  osc[0]->setTrim(tHL);
+  osc[1]->setTrim(tHR);
+  osc[2]->setTrim(tAL);
+  osc[3]->setTrim(tAR);
+}
+
+void DancingServos::getTrims(int trims[4]) {
+  for (int i = 0; i < 4; i++) {
+    trims[i] = osc[i]->getTrim();
+  }
+}
+
+//NEOPIXEL LED FUNCTIONS
+#if HAS_NEOPIXEL
+void DancingServos::setupNeopixel(Adafruit_NeoPixel pixels_){
+  pixels = pixels_;
+  pixels.begin();
+  pixels.setBrightness(40); // 1/3 brightness
+}
+
+// Input a value 0 to 255 to get a color value.
+// The colours are a transition r - g - b - back to r.
+uint32_t DancingServos::wheel(int8_t WheelPos) {
+  if(WheelPos < 85) {
+   return pixels.Color(WheelPos * 3, 255 - WheelPos * 3, 0);
+  } else if(WheelPos < 170) {
+   WheelPos -= 85;
+   return pixels.Color(255 - WheelPos * 3, 0, WheelPos * 3);
+  } else {
+   WheelPos -= 170;
+   return pixels.Color(0, WheelPos * 3, 255 - WheelPos * 3);
+  }
+}
+
+void DancingServos::rainbow(uint8_t wait) {
+  uint16_t i, j;
+
+  for(j=0; j<256; j++) {
+    for(i=0; i<pixels.numPixels(); i++) {
+      pixels.setPixelColor(i, wheel((i+j) & 255));
+    }
+    pixels.show();
+    //delay(wait);
+  }
+}
+
+void DancingServos::rainbowCycle(uint8_t wait) {
+  uint16_t r, j;
+
+  for(j=0; j<256*6; j++) { // 6 cycles of all colors on wheel
+    for(r=0; r< pixels.numPixels(); r++) {
+      pixels.setPixelColor(r, wheel(((r * 256 / pixels.numPixels()) + j) & 255));
+    }
+    pixels.show();
+    //delay(wait);
+  }
+}
+void DancingServos::rainbowCycleslow(uint8_t wait) {
+  uint16_t r, j;
+
+  for(j=0; j<256*3; j++) { // 3 cycles of all colors on wheel
+    for(r=0; r< pixels.numPixels(); r++) {
+      pixels.setPixelColor(r, wheel(((r * 256 / pixels.numPixels()) + j) & 255));
+    }
+    pixels.show();
+    //delay(wait);
+  }
+}
+void DancingServos::rainbowHold(uint8_t wait) {
+  uint16_t r, j;
+
+  for(j=0; j<256*1; j++) { // 3 cycles of all colors on wheel
+    for(r=0; r< pixels.numPixels(); r++) {
+      pixels.setPixelColor(r, wheel(((r * 256 / pixels.numPixels()) + j) & 255));
+    }
+    pixels.show();
+    //delay(wait);
+  }
+}
+#endif
+
+
+//DANCE MOVE FUNCTIONS
+
+/* this functions is the basis of all the other dancing functions
+ * set up an oscillation for each of the 4 servos
+ * input format:   [hipL, hipR, ankleL, ankleR]
+ * this interrupts the current move and clears the queue, unless setQueueMoves(true) was called
+ */
+void DancingServos::startOscillation(int amp[NUM_JOINTS], int off[NUM_JOINTS], double ph0[NUM_JOINTS], int period, float cycles) {
+  DanceMove move;
+  setMove(&move, amp, off, ph0, period, cycles);
+  startMove(&move);
+}
+
+/* same as startOscillation, but the sinusoids are in task space instead of servo degrees:
+ * the hips turn the feet out (degrees) and the ankles lift each side of the body (mm)
+ * this bot's Kinematics turns them into servo degrees each sample, so a move written this way works on every kind of dancebot
+ */
+void DancingServos::startFootOscillation(int amp[NUM_JOINTS], int off[NUM_JOINTS], double ph0[NUM_JOINTS], int period, float cycles) {
+  DanceMove move;
+  setMove(&move, amp, off, ph0, period, cycles);
+  move.taskSpace = true;
+  startMove(&move);
+}
+
+void DancingServos::startShape(const MoveShape& shape, float cycles) {
+  int amp[NUM_JOINTS] = {};
+  int off[NUM_JOINTS] = {};
+  double ph0[NUM_JOINTS] = {};
+  for (int i = 0; i < NUM_LEG_JOINTS; i++) {
+    amp[i] = shape.amp[i];
+    off[i] = shape.off[i];
+    ph0[i] = degToRad(shape.ph0[i]);
+  }
+  startOscillation(amp, off, ph0, shape.period, cycles);
+}
+
+//the first shape starts (or is queued) like any other move, the rest are queued after it
+void DancingServos::startShapes(const MoveShape* shapes, int count, float cycles) {
+  bool queueing = fromOtherTask() ? sendQueueMoves : queueMoves;
+  for (int i = 0; i < count; i++) {
+    startShape(shapes[i], cycles);
+    setQueueMoves(true);
+  }
+  setQueueMoves(queueing);
+}
+
+void DancingServos::startMove(DanceMove* move) {
+  startMove(move, fromOtherTask() ? sendQueueMoves : queueMoves);
+}
+
+//queue = true adds it to the queue, false interrupts the current move and clears the queue
+void DancingServos::startMove(DanceMove* move, bool queue) {
+  if (fromOtherTask()) {
+    MotionCommand command = {};
+    command.kind = MOTION_MOVE;
+    command.queue = queue;
+    command.move = *move;
+    sendCommand(&command);
+    return;
+  }
+  lock();
+  if (queue) {
+    queueMove(move);
+  }
+  else {
+    clearQueue();
+    beginMove(move);
+  }
+  unlock();
+}
+
+/* add a move to the end of the move queue
+ * it starts on the sample right after the last queued move ends
+ * a move that oscillates forever (cycles = -1) is ended at the end of its current cycle
+ */
+bool DancingServos::queueOscillation(int amp[NUM_JOINTS], int off[NUM_JOINTS], double ph0[NUM_JOINTS], int period, float cycles) {
+  DanceMove move;
+  setMove(&move, amp, off, ph0, period, cycles);
+  return queueMove(&move);
+}
+
+bool DancingServos::queueMove(DanceMove* move) {
+  //the motion task drops it if its queue is full
+  if (fromOtherTask()) {
+    MotionCommand command = {};
+    command.kind = MOTION_MOVE;
+    command.queue = true;
+    command.move = *move;
+    sendCommand(&command);
+    return true;
+  }
+  lock();
+  //nothing playing, start right away
+  //a move that is playing is never cut off here, even when nothing is queued behind it
+  if (!isOsc) {
+    beginMove(move);
+    unlock();
+    return true;
+  }
+  if (isQueueFull()) {
+    unlock();
+    return false;
+  }
+
+  moveQueue[(queueHead + queueCount) % MOVE_QUEUE_SIZE] = *move;
+  queueCount++;
+
+  //the oscillators all have the move's period, so any of their phases says how far into the cycle it is
+  if (moveSamplesLeft == -1) {
+    double cycleLeft = 1 - osc[0]->getPh() / (2 * PI);
+    moveSamplesLeft = max(1L, lround(cycleLeft * movePeriod / samplePeriod));
+  }
+  unlock();
+  return true;
+}
+
+void DancingServos::loopOscillation() {
+  //the motion timer or task samples the servos instead
+  if (motionTimer != NULL || motionTask != NULL) {
+    return;
+  }
+  if (isOscillating() && checkSampleTime()) {
+    sampleServos();
+  }
+}
+
+void DancingServos::sampleServos() {
+  if (isOsc) {
+    for (int i = 0; i < NUM_JOINTS; i++) {
+      osc[i]->sample();
+    }
+    sampleCount++;
+
+    //switch moves on this sample so the next move's first sample is one sample period later
+    if (moveSamplesLeft > 0) {
+      moveSamplesLeft--;
+      if (moveSamplesLeft == 0) {
+        nextMove();
+      }
+    }
+  }
+}
+
+void DancingServos::stopOscillation() {
+  if (fromOtherTask()) {
+    sendCommand(MOTION_STOP, 0);
+    return;
+  }
+  lock();
+  isOsc = false;
+  moveSamplesLeft = 0;
+  loadCurrent = (NUM_LEG_JOINTS + HAS_HAT) * SERVO_IDLE_MA;
+  clearQueue();
+  for (int i = 0; i < NUM_JOINTS; i++) {
+    osc[i]->stopO();
+    osc[i]->resetPh();
+  }
+  unlock();
+}
+
+void DancingServos::waitOscillation() {
+  while(isOscillating()) {
+    loopOscillation(); 
+    delay(50);
+    yield();
+  }
+}
+
+bool DancingServos::isOscillating() {
+  if (fromOtherTask()) {
+    MotionStatus status;
+    readStatus(&status);
+    return status.oscillating;
+  }
+  return isOsc;
+}
+
+unsigned long DancingServos::getSampleCount() {
+  if (fromOtherTask()) {
+    MotionStatus status;
+    readStatus(&status);
+    return status.sampleCount;
+  }
+  return sampleCount;
+}
+
+/* estimated current draw of the servos, used by PowerController to correct the battery voltage for the load
+ * a servo draws its running current at SERVO_RUNNING_SPEED, scaled by how fast the move turns it (4 * amp per period)
+ */
+int DancingServos::getLoadCurrent() {
+  if (fromOtherTask()) {
+    MotionStatus status;
+    readStatus(&status);
+    return status.loadCurrent;
+  }
+  return loadCurrent;
+}
+
+//pick the power tier for a battery level, the next move that starts uses it
+void DancingServos::setBatteryLevel(int percent) {
+  if (fromOtherTask()) {
+    batteryLevel = percent;
+    return;
+  }
+  int tier = POWER_FULL;
+  while (tier < POWER_CRITICAL && percent < powerTiers[tier].minBattery + (tier < powerTier ? POWER_TIER_HYSTERESIS : 0)) {
+    tier++;
+  }
+  powerTier = tier;
+}
+
+int DancingServos::getPowerTier() {
+  if (fromOtherTask()) {
+    MotionStatus status;
+    readStatus(&status);
+    return status.powerTier;
+  }
+  return powerTier;
+}
+
+//start oscillating with a move's parameters
+void DancingServos::beginMove(DanceMove* move) {
+  //take the first sample on the next loopOscillation()
+  t_lastSample = millis() - samplePeriod;
+  applyMove(move);
+  isOsc = true;
+
+  //or with the motion timer or task, take it now and restart the ticks from it, so a move starts as soon as it arrives
+  if (motionTimer != NULL || motionTask != NULL) {
+    if (motionTimer != NULL) {esp_timer_stop(motionTimer);}
+    sampleServos();
+    int64_t now = esp_timer_get_time();
+    alignTicks(now);
+    //on the fleet clock the next tick is sooner than a sample period, the move only gets that part of a sample until it
+    if (onFleetClock()) {
+      double early = 1 - (nextTick - now) / (samplePeriod * 1000.0);
+      for (int i = 0; i < NUM_JOINTS; i++) {
+        osc[i]->shiftPh(-early);
+      }
+    }
+    if (motionTimer != NULL) {esp_timer_start_periodic(motionTimer, samplePeriod * 1000L);}
+  }
+}
+
+//every move starts from phase 0, also one that interrupts another move, so it starts where it was written to
+void DancingServos::applyMove(DanceMove* move) {
+  //scale the move for the power tier, then for the tempo
+  const PowerTier* tier = &powerTiers[powerTier];
+  moveBasePeriod = move->period * tier->periodPercent / 100;
+  int period = tempoPeriod(moveBasePeriod);
+  for (int i = 0; i < NUM_JOINTS; i++) {
+    moveAmp[i] = move->amp[i] * tier->ampPercent / 100;
+  }
+  if (!tier->ankles) {
+    moveAmp[2] = 0;
+    moveAmp[3] = 0;
+  }
+
+  //set the sinusoid parameters for each of the oscillators, only the legs have kinematics
+  for (int i = 0; i < NUM_JOINTS; i++) {
+    osc[i]->setAmp(moveAmp[i]);
+    osc[i]->setOff(move->off[i]);
+    osc[i]->setPh0(move->ph0[i]);
+    osc[i]->setPer(period);
+    osc[i]->resetPh();
+    osc[i]->setKinematics(move->taskSpace && i < NUM_LEG_JOINTS ? kinematics : NULL);
+    osc[i]->startO();
+  }
+  movePeriod = period;
+  updateLoadCurrent();
+
+  //total oscillation time = (period * cycles), counted in samples
+  if (move->cycles == -1) {
+    moveSamplesLeft = -1;
+  }
+  else {
+    moveSamplesLeft = lround(period * move->cycles / samplePeriod);
+    if (moveSamplesLeft < 1) {moveSamplesLeft = 1;}
+  }
+}
+
+void DancingServos::nextMove() {
+  if (queueCount == 0) {
+    stopOscillation();
+    return;
+  }
+
+  DanceMove* move = &moveQueue[queueHead];
+  queueHead = (queueHead + 1) % MOVE_QUEUE_SIZE;
+  queueCount--;
+  applyMove(move);
+}
+
+//servo speed (deg/s) -> current, hips then ankles, anything else is counted as a hip servo
+void DancingServos::updateLoadCurrent() {
+  int current = 0;
+  for (int i = 0; i < NUM_JOINTS; i++) {
+    if (pins[i] == -1) {
+      continue;
+    }
+    int runningCurrent = i == 2 || i == 3 ? ANKLE_RUNNING_MA : HIP_RUNNING_MA;
+    long speed = 4000L * abs(moveAmp[i]) / (movePeriod > 0 ? movePeriod : 1);
+    current += SERVO_IDLE_MA + min(2L * runningCurrent, runningCurrent * speed / SERVO_RUNNING_SPEED);
+  }
+  loadCurrent = current;
+}
+
+//TEMPO
+
+void DancingServos::setTempo(int bpm) {
+  bpm = constrain(bpm, MIN_BPM, MAX_BPM);
+  if (fromOtherTask()) {
+    sendCommand(MOTION_TEMPO, bpm);
+    return;
+  }
+  lock();
+  if (bpm != tempo) {
+    tempo = bpm;
+    if (isOsc) {retime();}
+  }
+  unlock();
+}
+
+int DancingServos::getTempo() {
+  if (fromOtherTask()) {
+    MotionStatus status;
+    readStatus(&status);
+    return status.tempo;
+  }
+  return tempo;
+}
+
+int DancingServos::tempoPeriod(int period) {
+  //at least a sample, like Oscillator::setPer(), so the moves' sample counts agree with the oscillators
+  return max((long) samplePeriod, (long) period * REFERENCE_BPM / tempo);
+}
+
+/* the oscillators keep their phase and only get a new phase increment, so the next sample carries on from the last one
+ * the samples left are scaled so the move still ends after its cycles, and a queued move starts where it would have
+ * the queued moves get the new tempo when they start
+ */
+void DancingServos::retime() {
+  int period = tempoPeriod(moveBasePeriod);
+  if (period == movePeriod) {
+    return;
+  }
+  for (int i = 0; i < NUM_JOINTS; i++) {
+    osc[i]->setPer(period);
+    osc[i]->startO();     //the trace gets the new period
+  }
+  if (moveSamplesLeft > 0) {
+    moveSamplesLeft = max(1L, lround(double(moveSamplesLeft) * period / movePeriod));
+  }
+  movePeriod = period;
+  updateLoadCurrent();
+}
+
+//TUNING
+
+/* the new value is scaled for the power tier like a move that starts, a new period also for the tempo
+ * the trace gets the new sinusoid, so TracePlot's ideal curve follows the tuning
+ */
+int clampTuneValue(int param, int value) {
+  switch (param) {
+    case TUNE_AMP:
+    case TUNE_OFF:    return constrain(value, -MAX_MOVE_ANGLE, MAX_MOVE_ANGLE);
+    case TUNE_PH0:    return constrain(value, -MAX_MOVE_PH0, MAX_MOVE_PH0);
+    case TUNE_PERIOD: return constrain(value, MIN_MOVE_PERIOD, MAX_MOVE_PERIOD);
+  }
+  return value;
+}
+
+void DancingServos::tuneMove(int joint, int param, int value) {
+  if (fromOtherTask()) {
+    MotionCommand command = {};
+    command.kind = MOTION_TUNE;
+    command.values[0] = joint;
+    command.values[1] = param;
+    command.values[2] = value;
+    sendCommand(&command);
+    return;
+  }
+  if (joint < 0 || joint >= NUM_JOINTS) {
+    return;
+  }
+  lock();
+  if (isOsc) {
+    const PowerTier* tier = &powerTiers[powerTier];
+    switch (param) {
+      case TUNE_AMP:
+        moveAmp[joint] = !tier->ankles && (joint == 2 || joint == 3) ? 0 : value * tier->ampPercent / 100;
+        osc[joint]->setAmp(moveAmp[joint]);
+        osc[joint]->startO();
+        updateLoadCurrent();
+        break;
+      case TUNE_OFF:
+        osc[joint]->setOff(value);
+        osc[joint]->startO();
+        break;
+      case TUNE_PH0:
+        osc[joint]->setPh0(degToRad(value));
+        osc[joint]->startO();
+        break;
+      case TUNE_PERIOD:
+        moveBasePeriod = value * tier->periodPercent / 100;
+        retime();
+        break;
+    }
+  }
+  unlock();
+}
+
+//check if samplePeriod (ms) has passed since the last sample
+bool DancingServos::checkSampleTime() {
+  unsigned long t = millis();
+  if (t - t_lastSample >= (unsigned long)samplePeriod) {
+    t_lastSample += samplePeriod;
+    //don't try to catch up if loop() fell more than a sample behind
+    if (t - t_lastSample >= (unsigned long)samplePeriod) {t_lastSample = t;}
+    return true;
+  }
+  return false;
+}
+
+static void motionTimerCallback(void* arg) {
+  ((DancingServos*) arg)->motionTick();
+}
+
+/* sample the servos from an esp_timer every samplePeriod (one servo PWM frame) instead of in loopOscillation()
+ * the PWM and the timer run off the same crystal, so each sample is picked up by the same point of a PWM frame
+ */
+bool DancingServos::startMotionTimer() {
+  if (motionTimer != NULL) {
+    return true;
+  }
+  esp_timer_create_args_t timerArgs = {};
+  timerArgs.callback = motionTimerCallback;
+  timerArgs.arg = this;
+  timerArgs.name = "motion";
+  esp_timer_handle_t timer;
+  if (esp_timer_create(&timerArgs, &timer) != ESP_OK) {
+    return false;
+  }
+  lock();
+  nextTick = esp_timer_get_time() + samplePeriod * 1000L;
+  bool started = esp_timer_start_periodic(timer, samplePeriod * 1000L) == ESP_OK;
+  if (started) {motionTimer = timer;}
+  unlock();
+  return started;
+}
+
+static void motionTaskMain(void* arg) {
+  ((DancingServos*) arg)->runMotionTask();
+}
+
+/* run the servos from a task pinned to MOTION_TASK_CORE instead of the esp_timer task, which shares PRO_CPU with the radio
+ * call it from loop()'s task, after that loop() is the only other task that may call the move functions (see the top of DancingServos.h)
+ */
+bool DancingServos::startMotionTask() {
+  if (motionTask != NULL) {
+    return true;
+  }
+  publishStatus();
+  alignTicks(esp_timer_get_time());
+  if (xTaskCreatePinnedToCore(motionTaskMain, "motion", MOTION_TASK_STACK, this, MOTION_TASK_PRIORITY, &motionTask, MOTION_TASK_CORE) != pdPASS) {
+    motionTask = NULL;
+    return false;
+  }
+  return true;
+}
+
+void DancingServos::runMotionTask() {
+  while (true) {
+    //sleep for the whole FreeRTOS ticks (1 ms) until the next motion tick, loop() wakes it up early to send a command
+    //the first FreeRTOS tick can come any time, so it wakes up less than a tick early and waits out the rest
+    followFleetClock();
+    long wait = nextTick - esp_timer_get_time();
+    if (wait >= 1000L * portTICK_PERIOD_MS) {
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait / 1000));
+    }
+    else if (wait > 0) {
+      delayMicroseconds(wait);
+    }
+
+    runCommands();
+    int level = batteryLevel;
+    if (level != -1) {setBatteryLevel(level);}
+
+    if (esp_timer_get_time() >= nextTick) {
+      motionTick();
+    }
+    loopDanceRoutines();
+    publishStatus();
+  }
+}
+
+//one tick of the motion timer or task, runs in the esp_timer task or the motion task
+void DancingServos::motionTick() {
+  int64_t now = esp_timer_get_time();
+  lock();
+  //a tick that was waiting for the mutex while beginMove() restarted the timer, the restart took its sample
+  long late = now - nextTick;
+  if (late < -samplePeriod * 500L) {
+    unlock();
+    return;
+  }
+
+  //the timer keeps its schedule, so lateness doesn't add up
+  if (onFleetClock()) {
+    lastTick = nextTick;
+    followFleetClock();
+  }
+  else {
+    nextTick += samplePeriod * 1000L;
+  }
+  if (late > maxTickJitter) {maxTickJitter = late;}
+  if (late > MOTION_TICK_LATE_US) {lateTicks++;}
+  tickCount++;
+
+  sampleServos();
+  unlock();
+}
+
+void DancingServos::setBeatClock(BeatClock* clock) {
+  beatClock = clock;
+}
+
+BeatClock* DancingServos::getBeatClock() {
+  return beatClock;
+}
+
+bool DancingServos::onFleetClock() {
+  return beatClock != NULL && motionTask != NULL;
+}
+
+void DancingServos::alignTicks(int64_t now) {
+  long period = samplePeriod * 1000L;
+  lastTick = now;
+  if (!onFleetClock()) {
+    nextTick = now + period;
+    return;
+  }
+  nextTick = beatClock->toLocal((beatClock->toFleet(now) / period + 1) * period);
+  lastTick = nextTick - period;     //so followFleetClock() keeps this tick
+}
+
+/* followFleetClock
+ * the next tick goes on the multiple of the sample period of fleet time nearest to a period after the last tick
+ * each beacon moves the fleet clock a little, and the first one can move it up to half a period either way:
+ * an earlier tick is taken as it is, a later one only MOTION_SLEW_US later each tick so no two samples are much more than a period apart
+ */
+void DancingServos::followFleetClock() {
+  if (!onFleetClock()) {
+    return;
+  }
+  long period = samplePeriod * 1000L;
+  int64_t due = lastTick + period;
+  int64_t nearest = (beatClock->toFleet(due) + period / 2) / period * period;
+  nextTick = beatClock->toLocal(nearest);
+  if (nextTick > due + MOTION_SLEW_US) {nextTick = due + MOTION_SLEW_US;}
+}
+
+unsigned long DancingServos::getTickCount() {
+  return tickCount;
+}
+
+unsigned long DancingServos::getLateTicks() {
+  return lateTicks;
+}
+
+long DancingServos::getMaxTickJitter() {
+  return maxTickJitter;
+}
+
+void DancingServos::resetTickStats() {
+  lateTicks = 0;
+  maxTickJitter = 0;
+}
+
+void DancingServos::lock() {
+  xSemaphoreTakeRecursive(motionLock, portMAX_DELAY);
+}
+
+void DancingServos::unlock() {
+  xSemaphoreGiveRecursive(motionLock);
+}
+
+bool DancingServos::isMotionRunning() {
+  return motionTask != NULL || motionTimer != NULL;
+}
+
+bool DancingServos::fromOtherTask() {
+  return motionTask != NULL && xTaskGetCurrentTaskHandle() != motionTask;
+}
+
+//hand a command to the motion task, loop() is the only task that sends them so the ring buffer needs no lock
+void DancingServos::sendCommand(MotionCommand* command) {
+  int next = (commandTail + 1) % MOTION_COMMAND_QUEUE_SIZE;
+  //the motion task empties the queue every time it wakes up
+  while (next == commandHead) {
+    xTaskNotifyGive(motionTask);
+    vTaskDelay(1);
+  }
+  commandQueue[commandTail] = *command;
+  __sync_synchronize();     //the command is all there before the motion task sees commandTail move
+  commandTail = next;
+  xTaskNotifyGive(motionTask);
+}
+
+void DancingServos::sendCommand(int kind, int value) {
+  MotionCommand command = {};
+  command.kind = kind;
+  command.values[0] = value;
+  sendCommand(&command);
+}
+
+void DancingServos::runCommands() {
+  while (commandHead != commandTail) {
+    __sync_synchronize();   //read the command after seeing commandTail move
+    MotionCommand* command = &commandQueue[commandHead];
+    int* values = command->values;
+    switch (command->kind) {
+      case MOTION_MOVE:
+        startMove(&command->move, command->queue);
+        break;
+      case MOTION_STOP:           stopOscillation(); break;
+      case MOTION_CLEAR_QUEUE:    clearQueue(); break;
+      case MOTION_TRIMS:          setTrims(values[0], values[1], values[2], values[3]); break;
+      case MOTION_DANCE_ROUTINE:  setDanceRoutine(values[0]); break;
+      case MOTION_ENABLE_ROUTINE: enableDanceRoutine(values[0] != 0); break;
+      case MOTION_TEMPO:          setTempo(values[0]); break;
+      case MOTION_TUNE:           tuneMove(values[0], values[1], values[2]); break;
+    }
+    __sync_synchronize();   //done with the command before loop() can reuse its slot
+    commandHead = (commandHead + 1) % MOTION_COMMAND_QUEUE_SIZE;
+  }
+}
+
+//a sequence lock: statusSeq is odd while motionStatus is written, readStatus() reads it again if it changed meanwhile
+void DancingServos::publishStatus() {
+  statusSeq++;
+  __sync_synchronize();
+  motionStatus.oscillating = isOsc;
+  motionStatus.queueCount = queueCount;
+  motionStatus.loadCurrent = loadCurrent;
+  motionStatus.powerTier = powerTier;
+  motionStatus.tempo = tempo;
+  motionStatus.sampleCount = sampleCount;
+  __sync_synchronize();
+  statusSeq++;
+}
+
+void DancingServos::readStatus(MotionStatus* out) {
+  uint32_t seq;
+  do {
+    seq = statusSeq;
+    __sync_synchronize();
+    *out = motionStatus;
+    __sync_synchronize();
+  } while ((seq & 1) != 0 || seq != statusSeq);
+}
+
+
+
+//MOVE QUEUE FUNCTIONS
+
+void DancingServos::setQueueMoves(bool queue) {
+  if (fromOtherTask()) {
+    sendQueueMoves = queue;
+    return;
+  }
+  queueMoves = queue;
+}
+
+void DancingServos::clearQueue() {
+  if (fromOtherTask()) {
+    sendCommand(MOTION_CLEAR_QUEUE, 0);
+    return;
+  }
+  lock();
+  queueHead = 0;
+  queueCount = 0;
+  unlock();
+}
+
+int DancingServos::getQueueCount() {
+  if (fromOtherTask()) {
+    MotionStatus status;
+    readStatus(&status);
+    return status.queueCount;
+  }
+  return queueCount;
+}
+
+bool DancingServos::isQueueFull() {
+  return getQueueCount() == MOVE_QUEUE_SIZE;
+}
+
+
+
+//DANCE ROUTINE FUNCTIONS
+
+void DancingServos::loopDanceRoutines() {
+  //the motion task plays them
+  if (fromOtherTask()) {
+    return;
+  }
+  //keep one step queued ahead so the next move starts without a gap
+  //a script is resumed as the move before its last one ends, so its next move starts on the sample right after that
+  lock();
+  if (doDanceRoutine && getQueueCount() == 0) {
+    const DanceStep* danceStep = nextDanceStep();
+    if (danceStep != NULL) {
+      setQueueMoves(true);
+      startDanceMove(danceStep->move, danceStep->arg, danceStep->cycles);
+      setQueueMoves(false);
+    }
+  }
+  unlock();
+}
+
+const DanceStep* DancingServos::nextDanceStep() {
+  DanceRoutine* routine = &routines[currentDanceRoutine];
+  int* step = &routineSteps[currentDanceRoutine];
+  if (routine->script == NULL) {
+    const DanceStep* danceStep = &routine->steps[*step];
+    *step = (*step + 1) % routine->numSteps;
+    return danceStep;
+  }
+
+  //when the script ends, start it over for the next move
+  DanceScript* script = &scripts[currentDanceRoutine];
+  script->powerTier = powerTier;
+  if (routine->script(script)) {
+    (*step)++;
+    return &script->step;
+  }
+  *step = 0;
+  if (routine->script(script)) {
+    (*step)++;
+    return &script->step;
+  }
+  return NULL;
+}
+
+void DancingServos::enableDanceRoutine(bool dance) {
+  if (fromOtherTask()) {
+    sendCommand(MOTION_ENABLE_ROUTINE, dance);
+    return;
+  }
+  doDanceRoutine = dance;
+}
+
+void DancingServos::setDanceRoutine(int dance) {
+  if (fromOtherTask()) {
+    sendCommand(MOTION_DANCE_ROUTINE, dance);
+    return;
+  }
+  lock();
+  if (dance >= 0 && dance < numDanceRoutines) {
+    //let the current move finish, but drop moves queued by the old routine
+    clearQueue();
+    currentDanceRoutine = dance;
+    routineSteps[dance] = 0;
+    scripts[dance].line = 0;
+  }
+  unlock();
+}
+
+int DancingServos::getDanceRoutineStep() {
+  return routineSteps[currentDanceRoutine];
+}
+
+//a routine with the same name as an existing one replaces it and keeps its index
+//the steps are not copied, they have to stay valid (static arrays or routines mapped from flash)
+//with the motion task running only loop() may add routines, the motion task just reads them
+int DancingServos::addDanceRoutine(const char * name, const DanceStep * steps, int numSteps) {
+  if (numSteps <= 0) {
+    return -1;
+  }
+  return addRoutine(name, steps, numSteps, NULL);
+}
+
+int DancingServos::addDanceScript(const char * name, DanceScriptFunction script) {
+  if (script == NULL) {
+    return -1;
+  }
+  return addRoutine(name, NULL, 0, script);
+}
+
+int DancingServos::addRoutine(const char * name, const DanceStep * steps, int numSteps, DanceScriptFunction script) {
+  lock();
+  int i = findDanceRoutine(name);
+  if (i == -1) {
+    if (numDanceRoutines == MAX_DANCE_ROUTINES) {
+      unlock();
+      return -1;
+    }
+    i = numDanceRoutines;
+  }
+  bool playing = doDanceRoutine && i == currentDanceRoutine;
+  routines[i].name = name;
+  routines[i].steps = steps;
+  routines[i].numSteps = numSteps;
+  routines[i].script = script;
+  routineSteps[i] = 0;
+  memset(&scripts[i], 0, sizeof(DanceScript));
+  danceRoutines[i] = name;
+  if (i == numDanceRoutines) {numDanceRoutines++;}
+  unlock();
+
+  //drop the steps the old version queued, outside the mutex so the motion task can take the command
+  if (playing) {
+    clearQueue();
+  }
+  return i;
+}
+
+//the routines after it move down one index, a routine that was playing stops (the move playing finishes)
+//call it before the steps go away, RoutineStore does before it deletes a routine from flash
+bool DancingServos::removeDanceRoutine(const char * name) {
+  lock();
+  int i = findDanceRoutine(name);
+  if (i == -1) {
+    unlock();
+    return false;
+  }
+  bool playing = doDanceRoutine && i == currentDanceRoutine;
+  if (playing) {doDanceRoutine = false;}
+  for (int j = i; j < numDanceRoutines - 1; j++) {
+    routines[j] = routines[j + 1];
+    routineSteps[j] = routineSteps[j + 1];
+    scripts[j] = scripts[j + 1];
+    danceRoutines[j] = danceRoutines[j + 1];
+  }
+  numDanceRoutines--;
+  danceRoutines[numDanceRoutines] = "";
+  if (currentDanceRoutine > i || (currentDanceRoutine == numDanceRoutines && currentDanceRoutine > 0)) {
+    currentDanceRoutine--;
+  }
+  unlock();
+
+  if (playing) {
+    clearQueue();
+  }
+  return true;
+}
+
+int DancingServos::findDanceRoutine(const char * name) {
+  for (int i = 0; i < numDanceRoutines; i++) {
+    if (strcmp(routines[i].name, name) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+
+
+
+
+//MOVE SHAPES
+//{amp, off, ph0 (degrees), period (ms at REFERENCE_BPM)}, see MoveAlgebra.h
+//the other side's or the backwards version of a move is made from it, not written out again
+
+static constexpr MoveShape walkShape = {{18, 18, 15, 15}, {0, 0, -4, -4}, {0, 0, 90, 90}, BEATS(3)};
+static constexpr MoveShape walkBackShape = reverse(walkShape);
+static constexpr MoveShape heelToeLeft = {{20, -20, -40, -40}, {0, 0, 0, 0}, {0, 0, 0, 0}, BEATS(4)};
+static constexpr MoveShape heelToeRight = flip(heelToeLeft, JOINT_ANKLES);
+static constexpr MoveShape stankLeft = {{-40, 0, 30, 0}, {0, 0, 0, 0}, {0, 0, 90, 0}, BEATS(4)};
+static constexpr MoveShape stankRight = mirror(stankLeft);
+
+//test moves
+static constexpr MoveShape anklesShape = {{0, 0, 45, -45}, {0, 0, 0, 0}, {0, 0, 0, 0}, BEATS(4)};
+static constexpr MoveShape anklesPhaseShape = {{0, 0, 40, -40}, {0, 0, 0, 0}, {0, 0, 0, 90}, BEATS(4)};
+static constexpr MoveShape legsShape = {{40, -40, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, BEATS(4)};
+static constexpr MoveShape legsPhaseShape = {{40, -40, 0, 0}, {0, 0, 0, 0}, {0, 90, 0, 0}, BEATS(4)};
+
+//the derived moves are the ones that used to be written out by hand, worked out by the compiler
+static_assert(sameShape(walkBackShape, {{18, 18, 15, 15}, {0, 0, -4, -4}, {0, 0, -90, -90}, BEATS(3)}), "walk backwards");
+static_assert(sameShape(heelToeRight, {{20, -20, 40, 40}, {0, 0, 0, 0}, {0, 0, 0, 0}, BEATS(4)}), "right heel toe");
+static_assert(sameShape(stankRight, {{0, 40, 0, 30}, {0, 0, 0, 0}, {0, 0, 0, 90}, BEATS(4)}), "right stank");
+static_assert(sameShape(sum(legsShape, flip(legsShape, JOINT_HIPS)), {{0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, BEATS(4)}), "a move and its opposite cancel");
+static_assert(sameShape(sum(legsShape, legsPhaseShape), {{80, 57, 0, 0}, {0, 0, 0, 0}, {0, -135, 0, 0}, BEATS(4)}), "hipR 90 degrees apart");
+
+//the moves above by their enum, for tuning
+bool DancingServos::getMoveShape(int move, MoveShape* shape) {
+  switch (move) {
+    case WALK:          *shape = walkShape; break;
+    case BWALK:         *shape = walkBackShape; break;
+    case LEFT_HEELTOE:  *shape = heelToeLeft; break;
+    case RIGHT_HEELTOE: *shape = heelToeRight; break;
+    case LEFT_STANK:    *shape = stankLeft; break;
+    case RIGHT_STANK:   *shape = stankRight; break;
+    default:            return false;
+  }
+  return true;
+}
+
+//DANCE MOVES
+
+//wrappers for startOscillation()
+//[hipL, hipR, ankleL, ankleR]
+
+//start a dance move by its enum, used by the dance routines
+bool DancingServos::startDanceMove(int move, int arg, float cycles) {
+  switch(move) {
+    case STOP:          stopOscillation(); break;
+    case RESET:         position0(); break;
+    case WALK:          walk(cycles, arg, false); break;
+    case BWALK:         walk(cycles, arg, true); break;
+    case HOP:           hop(arg, cycles); break;
+    case WIGGLE:        wiggle(arg, cycles); break;
+    case ANKLES:        themAnkles(cycles); break;
+    case LEFT_HEELTOE:  heel_toe(cycles, true); break;
+    case RIGHT_HEELTOE: heel_toe(cycles, false); break;
+    case LEFT_STANK:    stank(cycles, true); break;
+    case RIGHT_STANK:   stank(cycles, false); break;
+    case WAVE:          wave(arg, cycles); break;
+    default:            return false;
+  }
+  return true;
+}
+
+//Move to resting poition
+void DancingServos::position0() {
+  int zeroi[NUM_JOINTS] = {};
+  double zerod[NUM_JOINTS] = {};
+  startOscillation(zeroi, zeroi, zerod, BEATS(4), 1.0f);
+}
+
+//Move to resting poition
+void DancingServos::themAnkles(int cycles) {
+  int amp[NUM_JOINTS] = {0, 0, 20, 20};
+  int off[NUM_JOINTS] = {0, 0, 0, 0};
+  double ph0[NUM_JOINTS] = {0, 0, 0, 0};
+  // startOscillation(amp, off, ph0, 3000, cycles);
+  startOscillation(amp, off, ph0, BEATS(3), cycles);
+
+}
+
+//Walk forward, adjust speed with T
+// walk backwards by calling this with reverse = true
+void DancingServos::walk(float cycles, int period, bool reverse) {
+  startShape(withPeriod(reverse ? walkBackShape : walkShape, period), cycles);
+}
+
+//simultaneous ankles
+void DancingServos::hop(int height, int cycles) {
+
+  // dev notes: preferably angle set to 30
+  // the ankles move differently on each kind of bot, see HardwareProfile.h
+  const HardwareProfile& p = dancebotProfile;
+  int amp[NUM_JOINTS] = {0, 0, p.hopAmp[0] * height, p.hopAmp[1] * height};
+  int off[NUM_JOINTS] = {0, 0, p.hopOff[0] * height, p.hopOff[1] * height};
+  double ph0[NUM_JOINTS] = {0, 0, degToRad(p.hopPh0[0]), degToRad(p.hopPh0[1])};
+#if HAS_HAT
+  //tip the hat on every hop
+  amp[HAT_JOINT] = HAT_TIP_ANGLE / 2;
+  off[HAT_JOINT] = HAT_TIP_ANGLE / 2;
+  ph0[HAT_JOINT] = degToRad(-90);
+#endif
+  startOscillation(amp, off, ph0, p.hopPeriod, cycles);
+}
+
+//simultaneous hips
+void DancingServos::wiggle(int angle, int cycles) {
+  int amp[NUM_JOINTS] = {angle, angle, 0, 0};
+  int off[NUM_JOINTS] = {0, 0, 0, 0};
+  double ph0[NUM_JOINTS] = {0, 0, 0, 0};
+  startOscillation(amp, off, ph0, BEATS(4), cycles);
+}
+
+// dev notes: goals for the future
+// 1. add new dance moves and refine
+// 2. overhaul dance servo system(?)
+// 3. coordinate multiple bots together
+//    (modifications in wifi and beacons)
+
+// "hip toe" dance move
+void DancingServos::heel_toe(int cycles, bool left_direction) {
+  // since toes initially pointed inwards?
+  startShape(left_direction ? heelToeLeft : heelToeRight, cycles);
+  // only reverse the ankles for second part?
+  // for (int i = 2; i < 4; i++) {osc[i]->setRev(true);}
+}
+
+
+// "stank" dance move
+void DancingServos::stank(int cycles, bool left_ankle) {
+  // presumably start from resting position
+  startShape(left_ankle ? stankLeft : stankRight, cycles);
+}
+
+
+// "wave" dance move
+void DancingServos::wave(int angle, int cycles) {
+
+  // dev notes: slightly dumb way of specifying degree of motion
+  // but for wave, the angle ~ 45 deg
+
+  int amp[NUM_JOINTS] = {0, 0, angle, angle};
+  int off[NUM_JOINTS] = {0, 0, -angle, angle};
+  // int off[NUM_JOINTS] = {0, 0, angle, -angle}; for the big dance bot
+  double ph0[NUM_JOINTS] = {0, 0, 0, degToRad(90)};
+  startOscillation(amp, off, ph0, BEATS(4), cycles);
+}
+
+//hop() written as foot lifts: both sides of the body rise up to lift mm and back down, on every kind of dancebot
+//hop(30) lifts a small dancebot about 20 mm and a big one 30 mm (see kinematicsTest)
+void DancingServos::footHop(int lift, int cycles) {
+  int amp[NUM_JOINTS] = {0, 0, lift / 2, lift / 2};
+  int off[NUM_JOINTS] = {0, 0, lift / 2, lift / 2};
+  double ph0[NUM_JOINTS] = {0, 0, 0, 0};
+  startFootOscillation(amp, off, ph0, BEATS(3), cycles);
+}
+
+// void DancingServos::shimmy(int angle, int cycles)
+// void DancingServos::ketou(int cycles) 
+
+// dev notes: TEST MOVES
+void DancingServos::ankles(int cycles) {
+  startShape(anklesShape, cycles);
+}
+
+void DancingServos::ankles_phase(int cycles) {
+  startShape(anklesPhaseShape, cycles);
+}
+
+void DancingServos::ankles_offset(int angle, int cycles) {
+  // dev notes: preferably angle set to 40
+  int amp[NUM_JOINTS] = {0, 0, angle, -angle};
+  int off[NUM_JOINTS] = {0, 0, angle, -angle};
+  double ph0[NUM_JOINTS] = {0, 0, 0, 0};
+  startOscillation(amp, off, ph0, BEATS(4), cycles);
+}
+
+void DancingServos::legs(int cycles) {
+  startShape(legsShape, cycles);
+}
+
+void DancingServos::legs_phase(int cycles) {
+  startShape(legsPhaseShape, cycles);
+}
+
+void DancingServos::legs_offset(int cycles) {
+  int amp[NUM_JOINTS] = {20, 20, 0, 0};
+  int off[NUM_JOINTS] = {20, 0, 0, 0};
+  double ph0[NUM_JOINTS] = {0, 0, 0, 0};
+  startOscillation(amp, off, ph0, BEATS(4), cycles);
+}
+
+//INFO
+
+String * DancingServos::getDanceMoves() {
+  return danceMoves;
+}
+
+int DancingServos::getNumDanceMoves() {
+  return numDanceMoves;
+}
+
+String * DancingServos::getDanceRoutines() {
+  return danceRoutines;
+}
+
+int DancingServos::getNumDanceRoutines() {
+  return numDanceRoutines;
+}
+
+
+
+//MATH
+double DancingServos::degToRad(double deg) {
+  return (deg * PI) / 180.0;
+}
+
+
+
+//TEST FUNCTIONS
+
+//play the moves with loopOscillation() until the bot stands still, returns how many samples that took
+//with loadSum, adds up the load current of every sample in it
+static long testPlay(DancingServos* bot, long* loadSum = NULL) {
+  unsigned long startSamples = bot->getSampleCount();
+  unsigned long samples = startSamples;
+  while (bot->isOscillating()) {
+    bot->loopOscillation();
+    if (loadSum != NULL && bot->getSampleCount() != samples) {
+      samples = bot->getSampleCount();
+      *loadSum += bot->getLoadCurrent();
+    }
+    delay(1);
+  }
+  return bot->getSampleCount() - startSamples;
+}
+
+//the ankles move 5 times from the resting position, then the bot goes back to it
+bool dancingServosTest(DancingServos* bot) {
+  bot->position0();
+  testPlay(bot);
+  bot->themAnkles(5);
+  long samples = testPlay(bot);
+  bot->position0();
+  testPlay(bot);
+
+  //5 * 1500 ms, one sample per servo PWM frame
+  long expected = 5 * 1500 / SERVO_FRAME_MS;
+  Serial.println("samples: " + String(samples) + " expected: " + String(expected));
+  bool passed = samples == expected;
+  Serial.println(passed ? "dancing servos test PASSED" : "dancing servos test FAILED");
+  return passed;
+}
+
+//queue three moves back to back, a gap between them would show up as missing samples
+//and a move that cut off the one before it as too few
+bool moveQueueTest(DancingServos* bot) {
+  bot->stopOscillation();
+  unsigned long startSamples = bot->getSampleCount();
+  long t0 = millis();
+
+  bot->setQueueMoves(true);
+  bot->wiggle(30, 1);
+  bot->wiggle(30, 1);
+  bot->themAnkles(1);
+  bot->setQueueMoves(false);
+  Serial.println("queued moves: " + String(bot->getQueueCount()));
+  testPlay(bot);
+
+  //2000 + 2000 + 1500 ms, one sample per servo PWM frame
+  long samples = bot->getSampleCount() - startSamples;
+  long expected = (2000 + 2000 + 1500) / SERVO_FRAME_MS;
+  Serial.println("samples: " + String(samples) + " expected: " + String(expected) + " time: " + String(millis() - t0) + " ms");
+  bool passed = samples == expected;
+
+  //after setQueueMoves(false) a move interrupts the one playing, even one that never ends
+  bot->walk(-1, BEATS(3), false);
+  bot->wiggle(30, 1);
+  if (bot->getQueueCount() != 0 || testPlay(bot) != 2000 / SERVO_FRAME_MS) {passed = false;}
+  Serial.println(passed ? "move queue test PASSED" : "move queue test FAILED");
+  return passed;
+}
+
+//plays a script routine with loopOscillation(), each of its moves has to start on the sample right after the one before
+static bool testScript(DanceScript* s) {
+  SCRIPT_BEGIN(s);
+  for (s->i = 0; s->i < 2; s->i++) {
+    SCRIPT_MOVE(s, WIGGLE, 30, 1);
+  }
+  SCRIPT_MOVE(s, ANKLES, 0, 1);
+  SCRIPT_END(s);
+}
+
+bool danceScriptTest(DancingServos* bot) {
+  Serial.println("script frame: " + String((int) sizeof(DanceScript)) + " bytes, " +
+                 String((int) sizeof(DanceScript) * MAX_DANCE_ROUTINES) + " for the routine table");
+
+  bot->stopOscillation();
+  int routine = bot->addDanceScript("Script test", testScript);
+  bot->setDanceRoutine(routine);
+  bot->enableDanceRoutine(true);
+  unsigned long startSamples = bot->getSampleCount();
+
+  //the script starts over when its last move starts, stop it there and let that move finish
+  int lastStep = 0;
+  while (bot->isOscillating() || lastStep == 0) {
+    bot->loopOscillation();
+    bot->loopDanceRoutines();
+    int step = bot->getDanceRoutineStep();
+    if (step < lastStep) {
+      bot->enableDanceRoutine(false);
+      bot->clearQueue();
+    }
+    lastStep = max(lastStep, step);
+    delay(1);   //let the clock move, loopOscillation() samples once a servo frame
+  }
+
+  //2000 + 2000 + 1500 ms, one sample per servo PWM frame
+  long samples = bot->getSampleCount() - startSamples;
+  long expected = (2000 + 2000 + 1500) / SERVO_FRAME_MS;
+  Serial.println("samples: " + String(samples) + " expected: " + String(expected));
+  bool passed = samples == expected && sizeof(DanceScript) <= 32;
+  Serial.println(passed ? "dance script test PASSED" : "dance script test FAILED");
+  return passed;
+}
+
+//changes the tempo twice during a move, sampling it by hand like the motion tick would
+//the hip has to carry on from where it was each time, and the move has to end after its cycles at the tempos it had
+bool tempoTest(DancingServos* bot) {
+  bot->stopOscillation();
+  bot->setTempo(REFERENCE_BPM);
+  bot->wiggle(30, 4);                   //BEATS(4), 100 samples a cycle
+
+  //a fifth of a cycle in (the hip most of the way out) to twice as fast, two cycles later to half as fast
+  const int changeAt[2] = {20, 120};
+  const int changeTo[2] = {2 * REFERENCE_BPM, REFERENCE_BPM / 2};
+  int maxStep = 0;
+  int lastPos = bot->osc[0]->getPos();
+  long samples = 0;
+  while (bot->isOsc && samples < 1000) {
+    for (int i = 0; i < 2; i++) {
+      if (samples == changeAt[i]) {bot->setTempo(changeTo[i]);}
+    }
+    bot->sampleServos();
+    samples++;
+    int pos = bot->osc[0]->getPos();
+    if (samples > 1) {maxStep = max(maxStep, abs(pos - lastPos));}
+    lastPos = pos;
+  }
+  bot->setTempo(REFERENCE_BPM);
+
+  //a period of 0 plays as a sample a cycle, and a tempo change during it, instead of stopping the motion task
+  bot->walk(2, 0, false);
+  bot->sampleServos();
+  bot->setTempo(MAX_BPM);
+  for (int i = 0; i < 4; i++) {bot->sampleServos();}
+  bool shortPeriod = !bot->isOsc;
+  bot->setTempo(REFERENCE_BPM);
+
+  //20 samples at 100 a cycle, 100 at 50 (2 cycles), the last 1.8 cycles at 200
+  long expected = 20 + 100 + 360;
+  //the fastest a 30 degree hip moves in one sample at 50 samples a cycle, plus rounding
+  int stepLimit = ceil(30 * 2 * PI / 50) + 1;
+  Serial.println("samples: " + String(samples) + " expected: " + String(expected) +
+                 " largest step: " + String(maxStep) + " limit: " + String(stepLimit));
+  bool passed = abs(samples - expected) <= 1 && maxStep > 0 && maxStep <= stepLimit && shortPeriod;   //a hip stuck at a servo limit moves 0
+  Serial.println(passed ? "tempo test PASSED" : "tempo test FAILED");
+  return passed;
+}
+
+#define TEST_BATTERY_MAH 8000     //4 AA, see DemobotLegsESP32.ino
+#define TEST_BOARD_MA 80          //the ESP32, BOARD_CURRENT_MA in PowerController.h
+
+//walks at each power tier's battery level and works out how much longer a battery lasts with the tiers than at full power
+//the current has to go down with each tier, and a battery gets to the next tier only a few % past the last one
+bool powerTierTest(DancingServos* bot) {
+  bool passed = true;
+  const int levels[] = {70, 30, 15, 5};
+  int current[4];
+  for (int tier = POWER_FULL; tier <= POWER_CRITICAL; tier++) {
+    bot->setBatteryLevel(levels[tier]);
+    if (bot->getPowerTier() != tier) {passed = false;}
+    bot->walk(4, BEATS(3), false);
+    long loadSum = 0;
+    long samples = testPlay(bot, &loadSum);
+    current[tier] = samples > 0 ? loadSum / samples : 0;
+    if (tier > POWER_FULL && current[tier] >= current[tier - 1]) {passed = false;}
+  }
+
+  //hysteresis, back up a tier only POWER_TIER_HYSTERESIS % past its minimum
+  bot->setBatteryLevel(powerTiers[POWER_LOW].minBattery + 1);
+  if (bot->getPowerTier() != POWER_CRITICAL) {passed = false;}
+  bot->setBatteryLevel(powerTiers[POWER_LOW].minBattery + POWER_TIER_HYSTERESIS);
+  if (bot->getPowerTier() != POWER_LOW) {passed = false;}
+  bot->setBatteryLevel(100);
+  if (bot->getPowerTier() != POWER_FULL) {passed = false;}
+
+  //the battery lasts the share of its charge in each tier at that tier's current
+  double fullHours = (double) TEST_BATTERY_MAH / (TEST_BOARD_MA + current[POWER_FULL]);
+  double tierHours = 0;
+  for (int tier = POWER_FULL; tier <= POWER_CRITICAL; tier++) {
+    int top = tier == POWER_FULL ? 100 : powerTiers[tier - 1].minBattery;
+    tierHours += TEST_BATTERY_MAH * (top - powerTiers[tier].minBattery) / 100.0 / (TEST_BOARD_MA + current[tier]);
+  }
+  if (tierHours <= fullHours) {passed = false;}
+
+  Serial.println("walk current by tier: " + String(current[0]) + ", " + String(current[1]) + ", " + String(current[2]) + ", " +
+                 String(current[3]) + " mA, runtime " + String(fullHours, 2) + " h at full power, " + String(tierHours, 2) +
+                 " h with the tiers (+" + String(lround(100 * (tierHours / fullHours - 1))) + " %)");
+  Serial.println(passed ? "power tier test PASSED" : "power tier test FAILED");
+  return passed;
+}
+
+//how long the samples of one motion tick take with NUM_JOINTS joints, call it before the motion task or timer starts
+//build with -D EXTRA_JOINTS=4 or 12 to compare 8 and 16 joints, the extra joints have no servos so only their sinusoids are timed
+//clock is micros() on a bot, the host tests pass a real clock since theirs is virtual
+//every tick has to sample, and take less than JOINT_TICK_BUDGET_US
+bool jointBenchmark(DancingServos* bot, unsigned long (*clock)()) {
+  const int ticks = 1000;
+  bot->walk(-1, 1500, false);
+  unsigned long startSamples = bot->getSampleCount();
+  unsigned long t0 = clock();
+  for (int i = 0; i < ticks; i++) {
+    bot->sampleServos();
+  }
+  unsigned long t = clock() - t0;
+  long samples = bot->getSampleCount() - startSamples;
+  bot->stopOscillation();
+  float perTick = t / (float) ticks;
+  Serial.println(String(NUM_JOINTS) + " joints: " + String(perTick, 2) + " us per tick, " +
+                 String(perTick / NUM_JOINTS, 3) + " us per joint, budget " + String(JOINT_TICK_BUDGET_US) + " us");
+  bool passed = samples == ticks && perTick < JOINT_TICK_BUDGET_US;
+  Serial.println(passed ? "joint benchmark PASSED" : "joint benchmark FAILED");
+  return passed;
+}
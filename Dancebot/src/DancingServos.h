@@ -0,0 +1,450 @@
+/* DancingServos.h
+ * UT Austin RAS Demobots
+ * Control class for a set of oscillating servos
+ * There are 2 servos on each leg of the bot: one at the hip and one at the ankle
+ * Functions to oscillate dance moves
+ * standard input order for functions should be [hipL, hipR, ankleL, ankleR]
+ *
+ * Bots with more servos (the big dancebot's hat) have them after the legs, NUM_JOINTS in all (see HardwareProfile.h).
+ * They are sampled on the same tick as the legs and move with the same moves: a move's arrays have NUM_JOINTS entries,
+ * the dance moves only fill in the legs so the rest stay at 0 unless the move is written for them (see hop()).
+ * Attach them with attachJoint(). With only the legs NUM_JOINTS is 4 and nothing changes.
+ * 
+ * To use, call startMotionTask once, or startMotionTimer once, or loopOscillation each loop().
+ * Call a dance move function or startOscillation to begin a move. 
+ * Call loopDanceRoutines each loop() to play the selected dance routine (the motion task plays them itself).
+ * 
+ * Moves can also be queued with queueOscillation, or by calling dance move functions after setQueueMoves(true).
+ * A queued move starts on the sample right after the previous move ends, so there is no gap between moves.
+ *
+ * Tempo: move periods are written at REFERENCE_BPM, BEATS(4) is a 4 beat period, and setTempo() plays every move
+ * faster or slower. A tempo change retimes the move that is playing from its next sample: the oscillators keep their phase
+ * and only how fast it goes changes, so the servos don't jump, and the move keeps the cycles it had left.
+ *
+ * Live tuning: tuneMove() changes one amplitude, offset, phase or the period of the move that is playing, from its next sample
+ * (the mothership's "/tune" page sends them, see WebController.cpp). The oscillators keep their phase like a tempo change,
+ * so a small step moves the servo a little, not back to the start of the move. getMoveShape() gives a move to start tuning from.
+ *
+ * The motion timer (startMotionTimer) samples the servos from an esp_timer once per servo PWM frame,
+ * so moves keep their timing however long the rest of loop() takes. The move functions can still be called from loop(),
+ * the timer and them take turns through a mutex.
+ *
+ * The motion task (startMotionTask) does the same from its own task on APP_CPU, away from the radio and loop() on PRO_CPU
+ * (see platformio.ini), so a busy radio or web server can't make the servos late.
+ * Then only the motion task touches the servos and the move queue. The functions below still work from loop():
+ *    dance moves, stopOscillation, setTrims, setTempo, clearQueue and the dance routine functions are sent to it as MotionCommands
+ *       through a ring buffer without locks, loop() is the only task that may send them
+ *    isOscillating, getQueueCount, getLoadCurrent, getPowerTier, getTempo and getSampleCount read a MotionStatus the motion task
+ *       publishes each tick with a sequence lock, so they can be a tick behind
+ *    setBatteryLevel leaves the level for the motion task's next tick
+ *    addDanceRoutine and removeDanceRoutine still take the mutex, uploads are rare
+ *
+ * With a BeatClock (setBeatClock) the motion task ticks on multiples of the sample period of fleet time instead of its own clock,
+ * so every bot in the fleet samples its servos at the same moments as the mothership (see BeatClock.h). A move that starts
+ * between ticks still takes its first sample right away, and its phase only moves on by the part of a sample up to the next tick.
+ * The motion timer and loopOscillation() keep to the bot's own clock.
+ */
+
+#ifndef DANCINGSERVOS
+#define DANCINGSERVOS
+
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include "HardwareProfile.h"
+#include "Oscillator.h"
+#include "Kinematics.h"
+#include "MoveAlgebra.h"
+#include "BeatClock.h"
+#if HAS_NEOPIXEL
+#include <Adafruit_NeoPixel.h>
+#endif
+
+//max number of moves waiting in the move queue
+#define MOVE_QUEUE_SIZE 8
+
+//max number of dance routines in the routine table
+#define MAX_DANCE_ROUTINES 16
+
+//a motion timer tick this much later than its time counts in getLateTicks()
+#define MOTION_TICK_LATE_US 2000
+
+//what the samples of one tick may take in jointBenchmark(), so the tick ends well before it would count as late
+#define JOINT_TICK_BUDGET_US (MOTION_TICK_LATE_US / 4)
+
+//on the fleet clock a tick comes at most this much more than a sample period after the last one, see followFleetClock()
+#define MOTION_SLEW_US 200
+
+//motion task, above loop() and everything else on APP_CPU
+#define MOTION_TASK_CORE APP_CPU_NUM
+#define MOTION_TASK_PRIORITY (configMAX_PRIORITIES - 3)
+#define MOTION_TASK_STACK 4096
+#define MOTION_COMMAND_QUEUE_SIZE 16
+
+//tempo, moves are written at REFERENCE_BPM (500 ms a beat) and played at the tempo from setTempo()
+#define REFERENCE_BPM 120
+#define MIN_BPM 30
+#define MAX_BPM 300
+#define BEATS(beats) ((beats) * 60000 / REFERENCE_BPM)    //a period in beats, as ms at REFERENCE_BPM
+
+//limits on moves from the radio or an uploaded routine, also the mothership's tuning sliders
+//the shortest period is still more than a sample at MAX_BPM
+#define MIN_MOVE_PERIOD (4 * SERVO_FRAME_MS)    //ms at REFERENCE_BPM
+#define MAX_MOVE_PERIOD 20000
+#define MAX_MOVE_ANGLE 90                       //degrees, amplitude or offset
+#define MAX_MOVE_PH0 360                        //degrees
+
+//servo current estimate for getLoadCurrent(), currents from the servo data sheets (see DemobotLegsESP32.ino)
+#define SERVO_IDLE_MA 8
+#define HIP_RUNNING_MA 160
+#define ANKLE_RUNNING_MA 400
+#define SERVO_RUNNING_SPEED 80      //deg/s that draws the running current, about a 30 degree walk
+
+//power tiers, picked from the battery level by setBatteryLevel()
+//lower tiers dance smaller and slower so the battery lasts until the end of the show (see powerTiers in DancingServos.cpp)
+enum{
+  POWER_FULL,
+  POWER_SAVE,
+  POWER_LOW,
+  POWER_CRITICAL,     //ankles hold still, they are the 400 mA servos
+};
+#define POWER_TIER_HYSTERESIS 3     //% the battery has to be above a tier's minimum to go back up to it
+
+//enums that correspond to dance moves
+//these are also the danceMove values sent from the mothership over ESP-NOW
+enum{
+  STOP,
+  RESET,
+  WALK,
+  HOP,
+  WIGGLE,
+  ANKLES,
+  // dev notes: new moves below:
+  LEFT_HEELTOE,
+  RIGHT_HEELTOE,
+  LEFT_STANK,
+  RIGHT_STANK,
+  BWALK,
+  WAVE,
+
+  // dev notes: TEST MOVES below:
+  // ANKLES_TEST,
+  // ANKLES_PHASE,
+  // ANKLES_OFFSET,
+  // LEGS,
+  // LEGS_PHASE,
+  // LEGS_OFFSET,
+
+  //dance routine i is sent as DEMO1 + i
+  DEMO1,
+  DEMO2,
+
+  // dev notes: new dance routines below:
+  DEMO3,
+  DEMO4
+};
+
+//one step of a dance routine: which move, its argument and how many cycles
+//arg is the period (ms) for WALK/BWALK, the height for HOP and the angle for WIGGLE/WAVE, other moves ignore it
+typedef struct DanceStep {
+  int16_t move;
+  int16_t arg;
+  float cycles;
+} DanceStep;
+
+//a dance script is a routine written as a function that runs a move at a time, with loops and ifs between moves
+//it picks up where it left off each time the next move is needed, like a protothread, so it has no stack of its own:
+//locals don't last from one move to the next, use the DanceScript's i and j, and no switch statements in a script
+//
+//  static bool partyScript(DanceScript* s) {
+//    SCRIPT_BEGIN(s);
+//    for (s->i = 0; s->i < 4; s->i++) {
+//      SCRIPT_MOVE(s, WALK, 1500, 1);
+//    }
+//    SCRIPT_MOVE(s, HOP, s->powerTier == POWER_FULL ? 40 : 25, 1);
+//    SCRIPT_END(s);
+//  }
+//
+//returns true with the next move in s->step, false when it ends, then it starts over
+//the DanceScripts are a fixed table in DancingServos, one for each routine, so scripts never allocate
+typedef struct DanceScript {
+  int line;                 //where to pick up, 0 = the start
+  DanceStep step;           //the move the script asked for
+  int powerTier;            //the bot's power tier when it was resumed
+  int i;
+  int j;
+} DanceScript;
+
+typedef bool (*DanceScriptFunction)(DanceScript* s);
+
+#define SCRIPT_BEGIN(s) switch ((s)->line) { case 0:
+#define SCRIPT_MOVE(s, _move, _arg, _cycles) \
+  do { \
+    (s)->step.move = (_move); (s)->step.arg = (_arg); (s)->step.cycles = (_cycles); \
+    (s)->line = __LINE__; return true; case __LINE__:; \
+  } while (0)
+#define SCRIPT_END(s) } (s)->line = 0; return false
+
+//a dance routine is a list of steps played in order, then repeated, or a script (steps is NULL then)
+typedef struct DanceRoutine {
+  const char * name;
+  const DanceStep * steps;
+  int numSteps;
+  DanceScriptFunction script;
+} DanceRoutine;
+
+//sinusoid parameters for one dance move, same as the startOscillation() inputs
+//[hipL, hipR, ankleL, ankleR]
+typedef struct DanceMove {
+  int amp[NUM_JOINTS];
+  int off[NUM_JOINTS];
+  double ph0[NUM_JOINTS];
+  int period;
+  float cycles;
+  bool taskSpace;           //amp and off are foot turns (degrees) and lifts (mm), see startFootOscillation()
+} DanceMove;
+
+//what loop() asks the motion task to do, see the top of this file
+enum{
+  MOTION_MOVE,              //start move, or queue it after the queued moves if queue is set
+  MOTION_STOP,
+  MOTION_CLEAR_QUEUE,
+  MOTION_TRIMS,             //values = trims
+  MOTION_DANCE_ROUTINE,     //values[0] = routine index
+  MOTION_ENABLE_ROUTINE,    //values[0] = 1 to dance the routine, 0 to stop
+  MOTION_TEMPO,             //values[0] = BPM
+  MOTION_TUNE,              //values = joint, TUNE_ parameter, value
+};
+
+//what tuneMove() changes, also in the mothership's tune frames (see Messages.h)
+enum{
+  TUNE_AMP,                 //degrees
+  TUNE_OFF,                 //degrees
+  TUNE_PH0,                 //degrees
+  TUNE_PERIOD,              //ms at REFERENCE_BPM, the joint is ignored
+};
+int clampTuneValue(int param, int value);   //in the range of the mothership's sliders, the bots check what they receive the same way
+
+typedef struct MotionCommand {
+  int kind;
+  bool queue;
+  int values[4];
+  DanceMove move;
+} MotionCommand;
+
+//what loop() can see of the motion task
+typedef struct MotionStatus {
+  bool oscillating;
+  int queueCount;
+  int loadCurrent;          //mA
+  int powerTier;
+  int tempo;                //BPM
+  unsigned long sampleCount;
+} MotionStatus;
+
+class DancingServos {
+public:
+  DancingServos(int hL, int hR, int aL, int aR);
+  void attachJoint(int joint, int pin);   //a joint after the legs (see HardwareProfile.h), before the motion task or timer starts
+  void setTrims(int tHL, int tHR, int tAL, int tAR);   //legs only, the other joints have no trim
+  void getTrims(int trims[4]);
+
+#if HAS_NEOPIXEL
+  //Neppixel LED functions
+  void setupNeopixel(Adafruit_NeoPixel pixels_);
+  uint32_t wheel(int8_t WheelPos);
+  void rainbow(uint8_t wait);
+  void rainbowCycle(uint8_t wait);
+  void rainbowCycleslow(uint8_t wait);
+  void rainbowHold(uint8_t wait);
+#endif
+
+
+  //dance moves - movements to choose from, calling one of these functions will start a dance, loopOscillation will run it each loop
+  void position0();
+  void walk(float cycles, int period, bool reverse);
+  void themAnkles(int cycles);
+  void hop(int height, int times);
+  void wiggle(int angle, int times);
+
+  // dev notes: new dance moves
+  void heel_toe(int cycles, bool left_direction);
+  void stank(int cycles, bool left_ankle);
+  void wave(int angle, int cycles);
+
+  //moves written as foot turns and lifts, the same on every bot (see Kinematics.h)
+  void footHop(int lift, int cycles);
+
+  // TEST MOVES
+  void ankles(int cycles);
+  void ankles_phase(int cycles);
+  void ankles_offset(int angle, int cycles);
+  void legs(int cycles);
+  void legs_phase(int cycles);
+  void legs_offset(int cycles);
+
+  //start a dance move by its enum, see DanceStep for what arg means
+  bool startDanceMove(int move, int arg, float cycles);
+
+  //functions to interact with the four Oscillators
+  void startOscillation(int amp[NUM_JOINTS], int off[NUM_JOINTS], double ph0[NUM_JOINTS], int period, float cycles);
+  void startFootOscillation(int amp[NUM_JOINTS], int off[NUM_JOINTS], double ph0[NUM_JOINTS], int period, float cycles);   //hips in degrees of foot turn, ankles in mm of lift, the rest in degrees
+  void startShape(const MoveShape& shape, float cycles);                      //a leg move from MoveAlgebra.h, the other joints rest
+  void startShapes(const MoveShape* shapes, int count, float cycles);         //each shape for cycles, one after the other
+  void loopOscillation();          //samples the servos when it is time, does nothing once the motion timer runs
+  void stopOscillation();
+  void waitOscillation();       //this does not currently work, arduino doesn't like this type of loop
+  bool isOscillating();
+  unsigned long getSampleCount();  //number of samples taken while oscillating
+  int getLoadCurrent();            //estimated current draw of the attached servos for the current move (mA)
+
+  //fixed rate motion tick, see the top of this file
+  bool startMotionTask();          //false if the task didn't start, try startMotionTimer() then
+  bool startMotionTimer();         //false if the timer didn't start, loopOscillation() keeps sampling then
+  bool isMotionRunning();          //true if the motion task or timer samples the servos, false if loopOscillation() has to
+  void runMotionTask();            //the motion task's body, never returns
+  void motionTick();               //called by the motion timer or task
+  unsigned long getTickCount();
+  unsigned long getLateTicks();    //ticks more than MOTION_TICK_LATE_US late since resetTickStats()
+  long getMaxTickJitter();         //us, the latest tick since resetTickStats()
+  void resetTickStats();
+  void setBeatClock(BeatClock* clock);   //tick on the fleet clock, before the motion task starts
+  BeatClock* getBeatClock();       //NULL = none
+
+  //power-aware motion scaling, moves are scaled for the power tier when they start
+  void setBatteryLevel(int percent);   //call when the battery level changes, picks the power tier
+  int getPowerTier();
+
+  //tempo, see the top of this file
+  void setTempo(int bpm);          //MIN_BPM to MAX_BPM, the move that is playing changes speed on its next sample
+  int getTempo();
+
+  //live tuning, see the top of this file
+  void tuneMove(int joint, int param, int value);   //the move that is playing, from its next sample, before the power tier and tempo
+  bool getMoveShape(int move, MoveShape* shape);     //false if the dance move isn't made from a MoveShape
+
+  //move queue
+  bool queueOscillation(int amp[NUM_JOINTS], int off[NUM_JOINTS], double ph0[NUM_JOINTS], int period, float cycles);   //false if the queue is full
+  void setQueueMoves(bool queue);   //true = dance move functions add to the queue instead of interrupting the current move
+  void clearQueue();
+  int getQueueCount();
+  bool isQueueFull();
+
+  //get info about the dance moves
+  String * getDanceMoves();
+  int getNumDanceMoves();
+
+  //get info about the dance routines
+  String * getDanceRoutines();
+  int getNumDanceRoutines();
+
+  //run the dance routines
+  void loopDanceRoutines();               //call once per loop, queues the next step of the current dance routine
+  void enableDanceRoutine(bool dance);
+  void setDanceRoutine(int dance);        //also restarts that routine from its first step
+  int getDanceRoutineStep();              //index of the next step of the current dance routine
+  int addDanceRoutine(const char * name, const DanceStep * steps, int numSteps);   //returns the routine index, -1 if the table is full
+  int addDanceScript(const char * name, DanceScriptFunction script);                //same for a script, see DanceScript
+  bool removeDanceRoutine(const char * name);   //false if not found
+  int findDanceRoutine(const char * name);   //-1 if not found
+  
+private:
+  friend bool jointBenchmark(DancingServos* bot, unsigned long (*clock)());
+  friend bool tempoTest(DancingServos* bot);
+  double degToRad(double deg);
+  bool checkSampleTime();           //check if the sample period has passed
+  void sampleServos();              //take the next sample of the current move
+  void lock();                      //hold the motion mutex while changing moves, it is recursive
+  void unlock();
+  bool fromOtherTask();             //the motion task runs and this isn't it, so send commands and read the status instead
+  void sendCommand(MotionCommand* command);
+  void sendCommand(int kind, int value);
+  void runCommands();               //the motion task runs the commands loop() sent
+  void publishStatus();
+  void readStatus(MotionStatus* out);
+  void startMove(DanceMove* move);  //start a move, or queue it after setQueueMoves(true)
+  void startMove(DanceMove* move, bool queue);
+  bool queueMove(DanceMove* move);
+  void beginMove(DanceMove* move);  //start oscillating right away
+  void applyMove(DanceMove* move);  //set the oscillators to a move's parameters
+  int tempoPeriod(int period);      //a period written at REFERENCE_BPM, at the current tempo (ms)
+  void retime();                    //play the current move at the current tempo
+  bool onFleetClock();              //the motion task ticks on the BeatClock
+  void alignTicks(int64_t now);     //the next tick is a sample period from now, or the next multiple of it on the fleet clock
+  void followFleetClock();          //when the next tick is due on the fleet clock
+  void updateLoadCurrent();
+  void nextMove();                  //start the next queued move, or stop if the queue is empty
+  int addRoutine(const char * name, const DanceStep * steps, int numSteps, DanceScriptFunction script);
+  const DanceStep* nextDanceStep(); //the current routine's next step, NULL if its script has no moves
+
+  //[hipL, hipR, ankleL, ankleR]
+  Oscillator* osc[NUM_JOINTS];
+  int pins[NUM_JOINTS];             //-1 = not attached
+  Kinematics* kinematics;           //this bot's leg model, for foot moves
+  bool isOsc;
+
+  //sample clock shared by all four oscillators
+  int samplePeriod;                 //ms
+  unsigned long t_lastSample = 0;
+  unsigned long sampleCount = 0;
+  int movePeriod = 0;               //period of the current move at the current tempo (ms)
+  int moveBasePeriod = 0;           //period of the current move at REFERENCE_BPM, scaled for the power tier (ms)
+  int moveAmp[NUM_JOINTS];          //amplitudes of the current move, scaled for the power tier
+  long moveSamplesLeft = 0;         //samples left in the current move, -1 = oscillate forever
+  volatile int loadCurrent = (NUM_LEG_JOINTS + HAS_HAT) * SERVO_IDLE_MA;   //mA, see getLoadCurrent()
+  int powerTier = POWER_FULL;
+  int tempo = REFERENCE_BPM;
+
+  //motion timer
+  esp_timer_handle_t motionTimer = NULL;
+  SemaphoreHandle_t motionLock;
+  int64_t nextTick = 0;             //esp_timer time the next tick should run at
+  BeatClock* beatClock = NULL;
+  int64_t lastTick = 0;             //esp_timer time the last tick was due, on the BeatClock
+  volatile unsigned long tickCount = 0;
+  volatile unsigned long lateTicks = 0;
+  volatile long maxTickJitter = 0;
+
+  //motion task
+  TaskHandle_t motionTask = NULL;
+  MotionCommand commandQueue[MOTION_COMMAND_QUEUE_SIZE];
+  volatile int commandHead = 0;     //next command for the motion task
+  volatile int commandTail = 0;     //where loop() puts the next command
+  bool sendQueueMoves = false;      //setQueueMoves() from loop(), queueMoves belongs to the motion task
+  volatile int batteryLevel = -1;   //setBatteryLevel() from loop(), -1 = none yet
+  MotionStatus motionStatus;
+  volatile uint32_t statusSeq = 0;  //odd while the motion task writes motionStatus
+
+  //move queue (ring buffer)
+  DanceMove moveQueue[MOVE_QUEUE_SIZE];
+  int queueHead = 0;
+  int queueCount = 0;
+  bool queueMoves = false;
+
+  // dev notes: new moves below:
+  int numDanceMoves = 12;
+  String danceMoves[12] = {"Stop", "Reset", "Walk", "Hop", "Wiggle", "Ankles", "Left Heel Toe", "Right Heel Toe", "Left Stank", "Right Stank", "Backwards Walk", "Wave"};
+  // String danceMoves[18] = {"Stop", "Reset", "Walk", "Hop", "Wiggle", "Ankles", "Left Heel Toe", "Right Heel Toe", "Left Stank", "Right Stank", "Backwards Walk", "Wave", 
+  //     "ankles", "ankles_phase", "ankles_offset", "legs", "legs_phase", "legs_offset"};
+  // void  (*danceMoveFunctions[])() = {};   //TODO standardize dance move function input parameters
+
+  bool doDanceRoutine = false;
+  int currentDanceRoutine = 0;
+  // dev notes: new demos go in the routine tables in DancingServos.cpp
+  int numDanceRoutines = 0;
+  DanceRoutine routines[MAX_DANCE_ROUTINES];
+  int routineSteps[MAX_DANCE_ROUTINES];     //cursor for each routine, index of its next step (moves since a script started)
+  DanceScript scripts[MAX_DANCE_ROUTINES];  //where each script routine is up to
+  String danceRoutines[MAX_DANCE_ROUTINES];
+
+};
+
+bool dancingServosTest(DancingServos* bot);
+bool moveQueueTest(DancingServos* bot);
+bool danceScriptTest(DancingServos* bot);
+bool tempoTest(DancingServos* bot);
+bool powerTierTest(DancingServos* bot);
+bool jointBenchmark(DancingServos* bot, unsigned long (*clock)() = micros);
+
+#endif
@@ -0,0 +1,308 @@
+//ESP32 PICO Kit dev board
+/* Current Pins
+ * hip  L: 14
+ * hip R: 13
+ * ankle L: 12 
+ * ankle R: 15
+ */
+
+/*
+ * Hardware
+ * 
+ * Servos
+ *    "Ankles": 2 HiTec HS-625MG "Super Torque" Servos https://www.horizonhobby.com/pdf/HRC32625S-Spec_Sheet.pdf
+ *      Operating Voltage: 4.8-6.0 V
+ *      Current Draw: 8.8 mA idle, 400 mA running
+ *    "Hips": 2 HiTec HS-322HD "Deluxe" Servos https://www.robotshop.com/media/files/pdf/hitec-hs-322hd-servo-specsheet.pdf
+ *      Operating Voltage: 4.8-6.0 V
+ *      Current Draw: 7.4 mA idle, 160 mA running no load, 700 mA running stalled
+ *    Total Current Draw 4 Servos: ~1600mA when running
+ *    Both have 900-2100 us pulse width (see Oscillator.cpp attach function)
+ * Microcontroller
+ *    ESP32 Pico Kit https://www.espressif.com/sites/default/files/documentation/esp32-pico-d4_datasheet_en.pdf
+ *    Operating Voltage: There is a 5v pin
+ *    Current Draw: 80mA average
+ * Batteries
+ *    Power Source: 6V 8000 mAH
+ *    4 rechargeable AA (1.5V), 2000 mAH each
+ *    8000 mAH battery using 1700mA lasts about 4.7 hours
+ * Decoupling Capacitor
+ *    100uF capacitor across the power source. I'm not sure if this is the best size, I haven't measured the noise yet.
+ *    Decoupling capacitors help remove AC noise from a DC power source.
+ *    The motors turning on/off and running can create noise in the power source; look at the differnce in current draw for idle vs running.
+ *    The ESP32 will reset if the power supply is not stable. The Teensy didn't crash without the cap, but it doesn't hurt. 
+ *    It would probably be better to use a 5v regulator.
+ */
+
+ 
+#include <Arduino.h>
+#include "HardwareProfile.h"
+#include "DancingServos.h"
+#include "RoutineStore.h"
+#include "TrimStore.h"
+#include "WiFi.h"
+#include <esp_now.h>
+#if IS_MOTHERSHIP
+#include "WebController.h"
+#else
+#include "BotController.h"
+#endif
+#include "PowerController.h"
+#include "TraceRecorder.h"
+#include "LoopScheduler.h"
+#include "BeatClock.h"
+#if HAS_NEOPIXEL
+#include "Adafruit_NeoPixel.h"
+#endif
+
+//the hardware profile (mothership, big or small dancebot) is picked by the PlatformIO environment, see HardwareProfile.h
+
+//the controllers have their own routineStore and trimStore pointers, these need other names to link
+DancingServos* bot;
+RoutineStore* botRoutines;
+TrimStore* botTrims;
+
+//fleet time and the beat, the mothership's own clock, the bots follow its beacons (see BeatClock.h)
+BeatClock botClock;
+
+#if IS_MOTHERSHIP
+//WiFi Settings
+//STA = connect to a WiFi network with name ssid
+//AP = create a WiFi access point with  name ssid
+#define WIFI_MODE "AP"
+//const char * ssid = "esp_hotspot";
+//const char * pass = "esp";
+
+const char * ssid = "Cole1";
+const char * pass = "cole1234";
+#endif
+
+PowerController* powerControl = NULL;   //only bots with a battery monitor have one
+
+//everything loop() does, see LoopScheduler.h
+//times in us: period between runs (0 = every pass), then how late a run may start
+LoopScheduler scheduler;
+void loopMotion();
+void loopPower();
+void loopSerial();
+
+#if HAS_NEOPIXEL
+//LED eyes
+Adafruit_NeoPixel pixels_(NEOPIXEL_COUNT, NEOPIXEL_PIN, NEO_GRB + NEO_KHZ800);
+uint32_t prevTime;
+uint8_t mode;
+int32_t color;
+void loopNeopixel();
+#endif
+
+void calibrateTrims(DancingServos* bot);
+
+
+void setup() {
+  Serial.begin(115200);
+  delay(500);
+
+  Serial.println("Dancebot profile: " + String(dancebotProfile.name));
+  printMACAddress();
+
+#if IS_MOTHERSHIP
+  /* Data Transmission Setup*/
+  //Set device as a Wi-Fi Station AND Wi-Fi Access Point
+  WiFi.mode(WIFI_AP_STA);
+
+  if(!setupESPNOW()){
+    Serial.println("Failed ESPNOW init...");
+    return;
+  }
+#endif
+
+  //[hipL, hipR, ankleL, ankleR]
+  const int* pins = dancebotProfile.pins;
+  bot = new DancingServos(pins[0], pins[1], pins[2], pins[3]);
+#if HAS_HAT
+  //the hat is a joint like the legs, hop() tips it
+  bot->attachJoint(HAT_JOINT, HAT_PIN);
+#endif
+  calibrateTrims(bot);
+  bot->position0();
+
+  //dance routines uploaded from the mothership's web page
+  botRoutines = new RoutineStore();
+  if (botRoutines->begin()) {
+    Serial.println("Loaded " + String(botRoutines->loadRoutines(bot)) + " stored dance routines");
+  }
+
+#if IS_MOTHERSHIP
+  Serial.println("Setting up WiFi...");
+  setupWiFi(WIFI_MODE, ssid, pass);       //Access Point or Station
+  setupWebServer(bot, botRoutines, botTrims);   //Set up the Web Server
+  Serial.println("Finished setting up WiFi!");
+#endif
+
+  delay(500);
+  bot->position0();
+
+  //run the servos from their own task on APP_CPU, loop() has PRO_CPU with the radio (see platformio.ini)
+  //from here on loop() is the only other task that may call bot's functions, see DancingServos.h
+  //the task ticks on the fleet clock, so the whole fleet samples its servos together
+  bot->setBeatClock(&botClock);
+  if (!bot->startMotionTask()) {
+    Serial.println("Failed to start motion task, sampling the servos from a timer");
+    if (!bot->startMotionTimer()) {
+      Serial.println("Failed to start motion timer, sampling the servos in loop()");
+    }
+  }
+
+#if HAS_POWER_CONTROLLER
+  Serial.println("Starting Power");
+  powerControl = new PowerController();
+  powerControl->batteryADCInit();
+#endif
+
+#if !IS_MOTHERSHIP
+  Serial.println("Starting ESPNOW");
+  if(!setupESPNOW(bot, powerControl, botRoutines, botTrims)){
+    Serial.println("Failed ESPNOW init...");
+  }
+#endif
+
+#if HAS_NEOPIXEL
+  //setup Neopixel LEDs
+  bot->setupNeopixel(pixels_);
+#endif
+
+
+  //the servos are only sampled in loop() if the motion task and timer didn't start, poll them every ms then
+  if (!bot->isMotionRunning()) {
+    scheduler.addTask("motion", loopMotion, SCHEDULE_MOTION, 1000, MOTION_TICK_LATE_US);
+  }
+#if IS_MOTHERSHIP
+  scheduler.addTask("fleet", loopFleet, SCHEDULE_RADIO, 0, 5000);
+  scheduler.addTask("web", loopWebServer, SCHEDULE_WEB, 10000, 100000);
+#if HAS_MICROPHONE
+  //the tempo and beat of the music, the microphone buffers 64 ms
+  if (setupMusic()) {
+    scheduler.addTask("music", loopMusic, SCHEDULE_RADIO, 10000, 30000);
+  }
+#endif
+#else
+  scheduler.addTask("radio", handleDanceMove, SCHEDULE_RADIO, 0, 5000);
+  scheduler.addTask("telemetry", loopTelemetry, SCHEDULE_TELEMETRY, 100000, 500000);
+#endif
+#if HAS_NEOPIXEL
+  scheduler.addTask("leds", loopNeopixel, SCHEDULE_LEDS, 20000, 100000);
+#endif
+#if HAS_POWER_CONTROLLER
+  scheduler.addTask("power", loopPower, SCHEDULE_TELEMETRY, 10000, 100000);
+#endif
+  scheduler.addTask("serial", loopSerial, SCHEDULE_TELEMETRY, 50000, 500000);
+}
+
+void loop() {
+  scheduler.loop();
+}
+
+//the motion task plays the dance routines itself, these only do anything when the servos are sampled in loop()
+void loopMotion() {
+  bot->loopOscillation();
+  bot->loopDanceRoutines();
+}
+
+#if HAS_POWER_CONTROLLER
+void loopPower() {
+  //the battery level is corrected for the servo load, and the moves are scaled down as the battery drains
+  powerControl->setLoadCurrent(bot->getLoadCurrent());
+  bot->setBatteryLevel(powerControl->getBatteryPercentage());
+
+  //save power while standing still, a new move wakes the bot within a period of this task
+  //the radio only sleeps when no mothership is around, see PowerController.h
+  //only the bots have a power controller, the mothership never sleeps
+  powerControl->loopPowerSave(!bot->isOscillating() && bot->getQueueCount() == 0, isFollowingFleet());
+}
+#endif
+
+//Serial commands: 't' prints the servo trace as CSV (see TraceRecorder.h),
+//'j' the motion timer's jitter counters, how each of loop()'s tasks kept to its deadline, how the beat clock follows the mothership
+//and how many ESP-NOW sends weren't delivered
+void loopSerial() {
+  if (Serial.available() > 0) {
+    char command = Serial.read();
+#if TRACE_ENABLED
+    if (command == 't') {
+      traceDump(&Serial);
+    }
+#endif
+    if (command == 'j') {
+      Serial.println("motion ticks: " + String(bot->getTickCount()) + " late: " + String(bot->getLateTicks()) +
+                     " worst: " + String(bot->getMaxTickJitter()) + " us");
+      bot->resetTickStats();
+      scheduler.printStats(&Serial);
+      scheduler.resetStats();
+      botClock.printStats(&Serial);
+      botClock.resetStats();
+      printSendStats(&Serial);
+      resetSendStats();
+    }
+  }
+}
+
+#if HAS_NEOPIXEL
+void loopNeopixel() {
+  uint8_t  i;
+  uint32_t t;
+
+  switch(mode) {
+   case 0: //rainbow hold
+    bot->rainbowHold(20);
+    //delay(500); make loop for delay
+    break;
+
+   case 1: //rainbow cycle slow
+    bot->rainbowCycleslow(20);
+    //delay(50);
+    break; 
+
+   case 2: //rainbow cycle fast 
+    bot->rainbowCycle(5);
+    //delay(50);
+    break;
+  }
+
+  t = millis();
+  if((t - prevTime) > 8000) {      // Every 8 seconds...
+    mode++;                        // Next mode
+    if(mode > 3) {                 // End of modes?
+      mode = 0;                    // Start modes over
+      color >>= 8;                 // Next color R->G->B
+      if(!color) color = 0xB300A4; // Reset color
+    }
+     for(i=0; i<32; i++) pixels_.setPixelColor(i, 0);
+    prevTime = t;
+  }
+}
+#endif
+
+
+//manual calibration- based on how the servos are attatched to the 3d printed parts
+//the default trims in HardwareProfile.h are only used the first time a bot boots, after that its trims are loaded from flash
+//adjust them on the mothership's web page (or POST /trim) instead of changing this code
+void calibrateTrims(DancingServos* bot) {
+  //[hipL, hipR, ankleL, ankleR]
+  //CW - decrease value, CCW - increase value
+  //trims used before they were saved to flash:
+  //  bot 1: (165, 100, 160, 20)
+  //  bot 2: (107, 75, 135, 132)
+  //  bot 3: (165, 100, 25, 40)
+  //  big dancebot: (95, 90, 140, 130) or (95, 90, 130, 120)
+  //  small dancebot: (170, 60, 25, 18)
+  int trims[4];
+
+  uint8_t mac[6];
+  WiFi.macAddress(mac);
+  botTrims = new TrimStore();
+  botTrims->begin(mac);
+  bool loaded = botTrims->loadOrMigrateTrims(trims, dancebotProfile.defaultTrims);
+  bot->setTrims(trims[0], trims[1], trims[2], trims[3]);
+
+  Serial.println(String(loaded ? "Loaded trims from flash" : "Saved default trims to flash") + " in " + String(botTrims->getLoadMicros()) + " us");
+}
@@ -0,0 +1,234 @@
+/* FleetRegistry.cpp
+ * UT Austin RAS Demobots
+ * The mothership's table of dancebots, see FleetRegistry.h
+ *
+ * The hash table uses linear probing. Removing a bot shifts the entries after it back,
+ * so there are no deleted markers and lookups stay short when bots keep joining and leaving.
+ */
+
+#include <Arduino.h>
+#include <string.h>
+#include "FleetRegistry.h"
+#include "DancingServos.h"
+
+FleetRegistry::FleetRegistry() {
+  for (int i = 0; i < FLEET_TABLE_SIZE; i++) {
+    table[i] = -1;
+  }
+  for (int i = 0; i < MAX_DANCEBOTS; i++) {
+    bots[i].active = false;
+  }
+  numBots = 0;
+  numPeers = 0;
+}
+
+//FNV-1a
+uint32_t FleetRegistry::hashMac(const uint8_t mac[6]) {
+  uint32_t hash = 2166136261u;
+  for (int i = 0; i < 6; i++) {
+    hash = (hash ^ mac[i]) * 16777619u;
+  }
+  return hash;
+}
+
+int FleetRegistry::findSlot(const uint8_t mac[6]) {
+  int slot = hashMac(mac) & (FLEET_TABLE_SIZE - 1);
+  while (table[slot] != -1 && memcmp(bots[table[slot]].mac, mac, 6) != 0) {
+    slot = (slot + 1) & (FLEET_TABLE_SIZE - 1);
+  }
+  return slot;
+}
+
+int FleetRegistry::join(const uint8_t mac[6], unsigned long t) {
+  int slot = findSlot(mac);
+  if (table[slot] != -1) {
+    bots[table[slot]].lastSeen = t;
+    return table[slot];
+  }
+  if (numBots == MAX_DANCEBOTS) {
+    return -1;
+  }
+
+  //lowest free id, so ids stay small
+  int id = 0;
+  while (bots[id].active) {id++;}
+
+  FleetBot* bot = &bots[id];
+  memcpy(bot->mac, mac, 6);
+  bot->active = true;
+  bot->isPeer = false;
+  bot->needsId = true;
+  bot->lastSeen = t;
+  bot->batteryLevel = 100;
+  bot->powerTier = POWER_FULL;
+  table[slot] = id;
+  numBots++;
+  return id;
+}
+
+void FleetRegistry::leave(int id) {
+  FleetBot* bot = getBot(id);
+  if (bot == NULL) {
+    return;
+  }
+  setPeer(id, false);
+
+  //take the bot out of the hash table, then move back entries that probed past it
+  int empty = findSlot(bot->mac);
+  table[empty] = -1;
+  for (int slot = (empty + 1) & (FLEET_TABLE_SIZE - 1); table[slot] != -1; slot = (slot + 1) & (FLEET_TABLE_SIZE - 1)) {
+    int home = hashMac(bots[table[slot]].mac) & (FLEET_TABLE_SIZE - 1);
+    //move it if its home slot isn't between the empty slot and where it is now
+    if (((slot - home) & (FLEET_TABLE_SIZE - 1)) >= ((slot - empty) & (FLEET_TABLE_SIZE - 1))) {
+      table[empty] = table[slot];
+      table[slot] = -1;
+      empty = slot;
+    }
+  }
+
+  bot->active = false;
+  numBots--;
+}
+
+int FleetRegistry::findBot(const uint8_t mac[6]) {
+  return table[findSlot(mac)];
+}
+
+FleetBot* FleetRegistry::getBot(int id) {
+  if (id < 0 || id >= MAX_DANCEBOTS || !bots[id].active) {
+    return NULL;
+  }
+  return &bots[id];
+}
+
+int FleetRegistry::getNumBots() {
+  return numBots;
+}
+
+void FleetRegistry::setPeer(int id, bool peer) {
+  FleetBot* bot = getBot(id);
+  if (bot == NULL || bot->isPeer == peer) {
+    return;
+  }
+  bot->isPeer = peer;
+  numPeers += peer ? 1 : -1;
+}
+
+int FleetRegistry::getNumPeers() {
+  return numPeers;
+}
+
+bool FleetRegistry::allPeers() {
+  return numPeers == numBots;
+}
+
+
+
+/* Test
+ * TEST_FLEET_BOTS virtual bots come and go for TEST_FLEET_SECONDS, each says hello every HEARTBEAT_INTERVAL_MS while it is there,
+ * the registry is run like loopFleet() runs it (timeouts, then peers), and checked against what the bots did after every step
+ */
+
+#define TEST_FLEET_BOTS 50
+#define TEST_FLEET_SECONDS 600
+#define TEST_FLEET_STEP_MS 100
+#define TEST_FLEET_HELLO_MS 5000    //HEARTBEAT_INTERVAL_MS in BotController.cpp
+
+static uint32_t fleetTestRandom = 1;
+static uint32_t fleetTestNext() {
+  fleetTestRandom = fleetTestRandom * 1103515245 + 12345;
+  return fleetTestRandom >> 8;
+}
+
+//Espressif's OUI and made up device bytes, spread out like real MACs so some share a hash slot
+static void fleetTestMac(int bot, uint8_t mac[6]) {
+  uint32_t device = (bot + 1) * 2654435761u;
+  uint8_t testMac[6] = {0x24, 0x0A, 0xC4, (uint8_t) (device >> 24), (uint8_t) (device >> 16), (uint8_t) (device >> 8)};
+  memcpy(mac, testMac, 6);
+}
+
+bool fleetRegistryTest() {
+  bool passed = true;
+  FleetRegistry fleet;
+  bool present[TEST_FLEET_BOTS];
+  unsigned long lastHello[TEST_FLEET_BOTS];
+  unsigned long leftAt[TEST_FLEET_BOTS];     //when it stopped saying hello
+  uint8_t mac[6];
+  for (int i = 0; i < TEST_FLEET_BOTS; i++) {
+    present[i] = true;
+    lastHello[i] = fleetTestNext() % TEST_FLEET_HELLO_MS;     //they boot over the first few seconds
+    leftAt[i] = 0;
+  }
+
+  long joins = 0;
+  long leaves = 0;
+  int most = 0;
+  for (unsigned long t = 0; t < TEST_FLEET_SECONDS * 1000UL; t += TEST_FLEET_STEP_MS) {
+    //about every 30 s a bot is switched off or back on
+    for (int i = 0; i < TEST_FLEET_BOTS; i++) {
+      if (fleetTestNext() % (30000 / TEST_FLEET_STEP_MS) == 0) {
+        present[i] = !present[i];
+        if (!present[i]) {leftAt[i] = t;}
+        else {lastHello[i] = t - TEST_FLEET_HELLO_MS;}
+      }
+    }
+
+    //hellos
+    for (int i = 0; i < TEST_FLEET_BOTS; i++) {
+      if (!present[i] || t - lastHello[i] < TEST_FLEET_HELLO_MS) {
+        continue;
+      }
+      lastHello[i] = t;
+      fleetTestMac(i, mac);
+      bool known = fleet.findBot(mac) != -1;
+      int id = fleet.join(mac, t);
+      if (fleet.getBot(id) == NULL || fleet.findBot(mac) != id || memcmp(fleet.getBot(id)->mac, mac, 6) != 0) {passed = false;}
+      if (!known) {joins++;}
+    }
+
+    //timeouts, then the first FLEET_MAX_PEERS bots are peers
+    for (int id = 0; id < MAX_DANCEBOTS; id++) {
+      FleetBot* bot = fleet.getBot(id);
+      if (bot != NULL && t - bot->lastSeen > FLEET_TIMEOUT_MS) {
+        fleet.leave(id);
+        leaves++;
+      }
+    }
+    for (int id = 0; id < MAX_DANCEBOTS; id++) {
+      FleetBot* bot = fleet.getBot(id);
+      if (bot != NULL && !bot->isPeer && fleet.getNumPeers() < FLEET_MAX_PEERS) {
+        fleet.setPeer(id, true);
+      }
+    }
+
+    //every bot that said hello in the timeout is there with its own MAC, every bot gone longer than that isn't
+    int count = 0;
+    for (int i = 0; i < TEST_FLEET_BOTS; i++) {
+      fleetTestMac(i, mac);
+      int id = fleet.findBot(mac);
+      bool recent = present[i] || t - leftAt[i] <= FLEET_TIMEOUT_MS;
+      if (present[i] && id == -1) {passed = false;}
+      if (!recent && id != -1) {passed = false;}
+      if (id != -1) {count++;}
+    }
+    if (count != fleet.getNumBots() || fleet.getNumPeers() != min(count, FLEET_MAX_PEERS) ||
+        fleet.allPeers() != (count <= FLEET_MAX_PEERS)) {
+      passed = false;
+    }
+    if (count > most) {most = count;}
+  }
+
+  //a full table turns the next bot away
+  FleetRegistry full;
+  for (int i = 0; i < MAX_DANCEBOTS; i++) {
+    fleetTestMac(1000 + i, mac);
+    if (full.join(mac, 0) != i) {passed = false;}
+  }
+  fleetTestMac(1000 + MAX_DANCEBOTS, mac);
+  if (full.join(mac, 0) != -1 || full.getNumBots() != MAX_DANCEBOTS) {passed = false;}
+
+  Serial.println(String(TEST_FLEET_BOTS) + " bots: " + String(joins) + " joins, " + String(leaves) + " leaves, up to " +
+                 String(most) + " in the fleet at once");
+  Serial.println(passed ? "fleet registry test PASSED" : "fleet registry test FAILED");
+  return passed;
+}
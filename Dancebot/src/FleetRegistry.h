@@ -0,0 +1,64 @@
+/* FleetRegistry.h
+ * UT Austin RAS Demobots
+ * The mothership's table of dancebots that have joined it
+ *
+ * Bots broadcast a hello when they boot, the mothership adds them here and sends back their id (see BotController).
+ * A bot's id is its slot in the table, it keeps it as long as the mothership keeps hearing from it.
+ * Bots are looked up by MAC address with a hash table, so a hello from any bot is found in about one step.
+ *
+ * ESP-NOW only allows ESP_NOW_MAX_TOTAL_PEER_NUM peers (one is the broadcast address).
+ * The first bots to join are registered as peers and get unicast messages,
+ * bots past that limit are reached by broadcast (see isPeer and allPeers()).
+ */
+
+#ifndef FLEETREGISTRY
+#define FLEETREGISTRY
+
+#include <stdint.h>
+
+#define MAX_DANCEBOTS 64
+#define FLEET_TABLE_SIZE 128      //hash table size, a power of 2 at least twice MAX_DANCEBOTS keeps probes short
+#define FLEET_MAX_PEERS 19        //ESP-NOW peers for bots, the 20th is the broadcast address
+#define FLEET_TIMEOUT_MS 15000    //a bot that hasn't said hello for this long has left
+
+typedef struct FleetBot {
+  uint8_t mac[6];
+  bool active;              //false = free slot
+  bool isPeer;              //registered as an ESP-NOW peer, otherwise it is reached by broadcast
+  bool needsId;             //the bot hasn't been sent its id yet
+  unsigned long lastSeen;   //ms
+  float batteryLevel;
+  int powerTier;            //see DancingServos.h
+} FleetBot;
+
+class FleetRegistry {
+public:
+  FleetRegistry();
+
+  //add a bot, or mark an existing bot as seen, returns its id (-1 if the table is full)
+  int join(const uint8_t mac[6], unsigned long t);
+  void leave(int id);
+  int findBot(const uint8_t mac[6]);    //id, -1 if the bot hasn't joined
+
+  FleetBot* getBot(int id);             //NULL if no bot has this id
+  int getNumBots();
+
+  //ESP-NOW peers
+  void setPeer(int id, bool peer);
+  int getNumPeers();
+  bool allPeers();                      //true if every bot can be sent unicast messages
+
+private:
+  static uint32_t hashMac(const uint8_t mac[6]);
+  int findSlot(const uint8_t mac[6]);   //hash table slot with this MAC, or the empty slot where it would go
+
+  FleetBot bots[MAX_DANCEBOTS];
+  int16_t table[FLEET_TABLE_SIZE];      //MAC hash -> id, -1 = empty
+  int numBots;
+  int numPeers;
+};
+
+//50 bots joining and leaving, checked after every step
+bool fleetRegistryTest();
+
+#endif
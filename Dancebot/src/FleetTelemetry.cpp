@@ -0,0 +1,161 @@
+/* FleetTelemetry.cpp
+ * UT Austin RAS Demobots
+ * Telemetry history for each dancebot, see FleetTelemetry.h
+ */
+
+#include <Arduino.h>
+#include <string.h>
+#include "FleetTelemetry.h"
+
+static const int tierSeconds[NUM_TELEMETRY_TIERS] = {1, 10, 60};
+static const int tierRatio[NUM_TELEMETRY_TIERS - 1] = {TELEMETRY_TIER_RATIO, 6};   //samples of a tier that make one sample of the next
+
+FleetTelemetry::FleetTelemetry() {
+  for (int id = 0; id < TELEMETRY_MAX_BOTS; id++) {
+    clearBot(id);
+  }
+}
+
+void FleetTelemetry::clearBot(int id) {
+  if (id < 0 || id >= TELEMETRY_MAX_BOTS) {
+    return;
+  }
+  for (int tier = 0; tier < NUM_TELEMETRY_TIERS; tier++) {
+    rings[id][tier].head = 0;
+    rings[id][tier].count = 0;
+  }
+  memset(accumulators[id], 0, sizeof(accumulators[id]));
+}
+
+void FleetTelemetry::addSample(int id, const TelemetrySample* sample) {
+  if (id < 0 || id >= TELEMETRY_MAX_BOTS) {
+    return;
+  }
+  addToTier(id, TIER_1S, sample);
+}
+
+//put a sample in a tier's ring, and combine it into the next tier
+void FleetTelemetry::addToTier(int id, int tier, const TelemetrySample* sample) {
+  TelemetryRing* ring = &rings[id][tier];
+  ring->samples[ring->head] = *sample;
+  ring->head = (ring->head + 1) % TELEMETRY_TIER_SIZE;
+  if (ring->count < TELEMETRY_TIER_SIZE) {ring->count++;}
+
+  if (tier == NUM_TELEMETRY_TIERS - 1) {
+    return;
+  }
+
+  TelemetryAccumulator* acc = &accumulators[id][tier];
+  uint8_t jitter = acc->count == 0 ? 0 : acc->combined.jitter;
+  uint16_t lag = acc->count == 0 ? 0 : acc->combined.lag;
+  acc->combined = *sample;
+  acc->combined.jitter = sample->jitter > jitter ? sample->jitter : jitter;
+  acc->combined.lag = sample->lag > lag ? sample->lag : lag;
+  acc->battery += sample->battery;
+  if (sample->rssi != 0) {
+    acc->rssi += sample->rssi;
+    acc->rssiCount++;
+  }
+  acc->count++;
+
+  if (acc->count == tierRatio[tier]) {
+    acc->combined.battery = acc->battery / acc->count;
+    acc->combined.rssi = acc->rssiCount == 0 ? 0 : acc->rssi / acc->rssiCount;
+    TelemetrySample combined = acc->combined;
+    memset(acc, 0, sizeof(TelemetryAccumulator));
+    addToTier(id, tier + 1, &combined);
+  }
+}
+
+int FleetTelemetry::getSamples(int id, int tier, TelemetrySample* samples, int max) {
+  if (id < 0 || id >= TELEMETRY_MAX_BOTS || tier < 0 || tier >= NUM_TELEMETRY_TIERS) {
+    return 0;
+  }
+  TelemetryRing* ring = &rings[id][tier];
+  int count = ring->count < max ? ring->count : max;
+  //the newest count samples, oldest first
+  int start = (ring->head - count + TELEMETRY_TIER_SIZE) % TELEMETRY_TIER_SIZE;
+  for (int i = 0; i < count; i++) {
+    samples[i] = ring->samples[(start + i) % TELEMETRY_TIER_SIZE];
+  }
+  return count;
+}
+
+int FleetTelemetry::getTierSeconds(int tier) {
+  return tierSeconds[tier];
+}
+
+
+
+/* Test
+ * TELEMETRY_MAX_BOTS bots, and a few past them, send a sample every second for an hour
+ * the table doesn't grow, every tier ends up full, and each minute keeps its worst jitter and average battery
+ */
+
+#define TEST_TELEMETRY_SECONDS 3600
+#define TEST_TELEMETRY_EXTRA_BOTS 5       //ids past TELEMETRY_MAX_BOTS, they get no history
+#define TEST_TELEMETRY_MAX_BYTES 32768    //"about 30 KB for 20 bots" in FleetTelemetry.h
+
+static void telemetryTestSample(int id, int second, TelemetrySample* sample) {
+  memset(sample, 0, sizeof(TelemetrySample));
+  sample->battery = 100 - second / 36;                  //the battery runs down over the hour
+  sample->danceMove = second / 60 % 12;
+  sample->rssi = -40 - id;
+  sample->jitter = second % 60 == 17 ? 100 + second / 60 : 5;   //one long loop() each minute
+  sample->lag = id;
+}
+
+bool fleetTelemetryTest() {
+  bool passed = true;
+  //a global on the mothership, too big for this stack
+  static FleetTelemetry telemetry;
+  TelemetrySample sample;
+  for (int id = 0; id < TELEMETRY_MAX_BOTS + TEST_TELEMETRY_EXTRA_BOTS; id++) {
+    telemetry.clearBot(id);
+  }
+  for (int second = 0; second < TEST_TELEMETRY_SECONDS; second++) {
+    for (int id = 0; id < TELEMETRY_MAX_BOTS + TEST_TELEMETRY_EXTRA_BOTS; id++) {
+      telemetryTestSample(id, second, &sample);
+      telemetry.addSample(id, &sample);
+    }
+  }
+
+  static TelemetrySample samples[TELEMETRY_TIER_SIZE];
+  for (int id = 0; id < TELEMETRY_MAX_BOTS + TEST_TELEMETRY_EXTRA_BOTS; id++) {
+    int expected = id < TELEMETRY_MAX_BOTS ? TELEMETRY_TIER_SIZE : 0;
+    for (int tier = 0; tier < NUM_TELEMETRY_TIERS; tier++) {
+      if (telemetry.getSamples(id, tier, samples, TELEMETRY_TIER_SIZE) != expected) {passed = false;}
+    }
+    if (expected == 0) {
+      continue;
+    }
+
+    //the last minute as sent
+    telemetry.getSamples(id, TIER_1S, samples, TELEMETRY_TIER_SIZE);
+    telemetryTestSample(id, TEST_TELEMETRY_SECONDS - 1, &sample);
+    if (memcmp(&samples[TELEMETRY_TIER_SIZE - 1], &sample, sizeof(TelemetrySample)) != 0) {passed = false;}
+
+    //the hour a minute at a time, oldest first
+    telemetry.getSamples(id, TIER_1MIN, samples, TELEMETRY_TIER_SIZE);
+    for (int minute = 0; minute < TELEMETRY_TIER_SIZE; minute++) {
+      int battery = 0;
+      for (int second = minute * 60; second < minute * 60 + 60; second++) {
+        battery += 100 - second / 36;
+      }
+      if (samples[minute].jitter != 100 + minute || abs(samples[minute].battery - battery / 60) > 1 ||
+          samples[minute].rssi != -40 - id || samples[minute].lag != id || samples[minute].danceMove != minute % 12) {
+        passed = false;
+      }
+    }
+  }
+
+  //a bot that leaves starts over
+  telemetry.clearBot(3);
+  if (telemetry.getSamples(3, TIER_1S, samples, TELEMETRY_TIER_SIZE) != 0) {passed = false;}
+  if (sizeof(FleetTelemetry) > TEST_TELEMETRY_MAX_BYTES) {passed = false;}
+
+  Serial.println(String(TELEMETRY_MAX_BOTS) + " bots for an hour in " + String((int) sizeof(FleetTelemetry)) + " bytes, " +
+                 String((int) sizeof(FleetTelemetry) / TELEMETRY_MAX_BOTS) + " a bot");
+  Serial.println(passed ? "fleet telemetry test PASSED" : "fleet telemetry test FAILED");
+  return passed;
+}
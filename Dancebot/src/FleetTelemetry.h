@@ -0,0 +1,70 @@
+/* FleetTelemetry.h
+ * UT Austin RAS Demobots
+ * History of the telemetry each dancebot sends to the mothership (see TelemetrySample in Messages.h)
+ *
+ * Each bot has three ring buffers of TELEMETRY_TIER_SIZE samples:
+ *    TIER_1S     every sample, the last minute
+ *    TIER_10S    10 samples combined into one, the last 10 minutes
+ *    TIER_1MIN   60 samples combined into one, the last hour
+ * Combined samples keep the worst jitter and lag, the average battery and RSSI, and the latest move, power tier and reset reason.
+ *
+ * All of it is a fixed size table: TELEMETRY_MAX_BOTS * 3 * TELEMETRY_TIER_SIZE * 8 bytes plus the sums, about 30 KB for 20 bots.
+ * Bots with an id of TELEMETRY_MAX_BOTS or more have no history (loopFleet() says so when one joins).
+ * It isn't sized from MAX_DANCEBOTS on purpose: 64 bots would take about 100 KB, about all the RAM the mothership has left
+ * next to the WiFi stack and the web server. Ids are the lowest free ones, so the first 20 bots in the fleet have history.
+ */
+
+#ifndef FLEETTELEMETRY
+#define FLEETTELEMETRY
+
+#include <stdint.h>
+#include "Messages.h"
+
+#define TELEMETRY_MAX_BOTS 20
+#define TELEMETRY_TIER_SIZE 60
+#define TELEMETRY_TIER_RATIO 10   //samples combined from one tier into the next, TIER_1MIN uses 6 TIER_10S samples
+
+enum{
+  TIER_1S,
+  TIER_10S,
+  TIER_1MIN,
+  NUM_TELEMETRY_TIERS
+};
+
+//sums for combining samples into the next tier
+typedef struct TelemetryAccumulator {
+  int count;
+  uint32_t battery;
+  int32_t rssi;
+  int rssiCount;
+  TelemetrySample combined;     //max jitter and lag, latest of the rest
+} TelemetryAccumulator;
+
+typedef struct TelemetryRing {
+  TelemetrySample samples[TELEMETRY_TIER_SIZE];
+  int head;                     //where the next sample goes
+  int count;
+} TelemetryRing;
+
+class FleetTelemetry {
+public:
+  FleetTelemetry();
+
+  void addSample(int id, const TelemetrySample* sample);    //one TIER_1S sample
+  void clearBot(int id);                                    //the bot left
+
+  //copy up to max samples of one tier, oldest first, returns how many
+  int getSamples(int id, int tier, TelemetrySample* samples, int max);
+  int getTierSeconds(int tier);                             //time between samples of a tier
+
+private:
+  void addToTier(int id, int tier, const TelemetrySample* sample);
+
+  TelemetryRing rings[TELEMETRY_MAX_BOTS][NUM_TELEMETRY_TIERS];
+  TelemetryAccumulator accumulators[TELEMETRY_MAX_BOTS][NUM_TELEMETRY_TIERS - 1];
+};
+
+//an hour of samples from every bot in a table that doesn't grow
+bool fleetTelemetryTest();
+
+#endif
@@ -0,0 +1,104 @@
+/* HardwareProfile.h
+ * UT Austin RAS Demobots
+ * Compile time settings for each kind of dancebot, so every bot runs the same firmware
+ *
+ * Pick a profile with a build flag, each environment in platformio.ini sets one:
+ *    DANCEBOT_PROFILE_MOTHERSHIP   main dancebot: web page, sends dance moves to the other bots, NeoPixel eyes
+ *    DANCEBOT_PROFILE_BIGBOT       big dancebot: follows the mothership, hat servo, battery monitor
+ *    DANCEBOT_PROFILE_SMALLBOT     small dancebot: follows the mothership, battery monitor
+ *
+ * Hardware a profile doesn't have is compiled out with the HAS_ macros below.
+ * NUM_JOINTS is how many servos DancingServos samples together: the 4 leg joints, then the hat (HAT_JOINT) if the profile has one,
+ * then EXTRA_JOINTS more, 0 unless a build flag sets it (e.g. -D EXTRA_JOINTS=4 to time the motion tick with 8 joints).
+ * Everything else that differs between the bots is a constant in dancebotProfile.
+ */
+
+#ifndef HARDWAREPROFILE
+#define HARDWAREPROFILE
+
+typedef struct HardwareProfile {
+  const char * name;
+  int pins[4];              //servo pins, [hipL, hipR, ankleL, ankleR]
+  int defaultTrims[4];      //used until the bot has trims saved in flash (see TrimStore.h)
+
+  //hop() ankle sinusoids, [ankleL, ankleR]
+  //the big dancebot's ankles are mounted the other way around, so it hops with its ankles 90 degrees apart
+  int hopAmp[2];            //multiplied by the hop height
+  int hopOff[2];            //multiplied by the hop height
+  int hopPh0[2];            //degrees
+  int hopPeriod;            //ms
+
+  //leg model for moves written as foot turns and lifts (see Kinematics.h)
+  int footWidth;            //mm, ankle axis to the edge of the foot the bot tips onto
+  int ankleHeight;          //mm, ankle axis above the sole
+  int jointSign[4];         //1 or -1, which way each servo turns to turn the foot out or lift that side of the body
+} HardwareProfile;
+
+#if defined(DANCEBOT_PROFILE_MOTHERSHIP)
+  #define IS_MOTHERSHIP 1
+  #define HAS_NEOPIXEL 1
+  #define NEOPIXEL_PIN 26
+  #define NEOPIXEL_COUNT 7
+  #define HAS_MICROPHONE 1           //I2S microphone for following the music, pins in Microphone.h
+  constexpr HardwareProfile dancebotProfile = {
+    "mothership",
+    {14, 13, 12, 15},
+    {165, 100, 25, 40},
+    {1, -1}, {1, -1}, {0, 0}, 1500,
+    30, 12, {1, -1, 1, -1}
+  };
+
+#elif defined(DANCEBOT_PROFILE_BIGBOT)
+  #define HAS_HAT 1
+  #define HAT_PIN 26
+  #define HAT_TIP_ANGLE 40          //degrees the hat tips on each hop, it rests at 0
+  #define HAS_POWER_CONTROLLER 1
+  constexpr HardwareProfile dancebotProfile = {
+    "big dancebot",
+    {14, 13, 12, 15},
+    {95, 90, 140, 130},
+    {-1, -1}, {1, -1}, {-90, 90}, 2000,
+    45, 18, {1, -1, 1, -1}
+  };
+
+#elif defined(DANCEBOT_PROFILE_SMALLBOT)
+  #define HAS_POWER_CONTROLLER 1
+  constexpr HardwareProfile dancebotProfile = {
+    "small dancebot",
+    {14, 13, 12, 15},
+    {170, 60, 25, 18},
+    {1, -1}, {1, -1}, {0, 0}, 1500,
+    30, 12, {1, -1, 1, -1}
+  };
+
+#else
+  #error "No hardware profile, build with -D DANCEBOT_PROFILE_MOTHERSHIP, _BIGBOT or _SMALLBOT (see platformio.ini)"
+#endif
+
+#ifndef IS_MOTHERSHIP
+  #define IS_MOTHERSHIP 0
+#endif
+#ifndef HAS_NEOPIXEL
+  #define HAS_NEOPIXEL 0
+#endif
+#ifndef HAS_MICROPHONE
+  #define HAS_MICROPHONE 0
+#endif
+#ifndef HAS_HAT
+  #define HAS_HAT 0
+#endif
+#ifndef HAS_POWER_CONTROLLER
+  #define HAS_POWER_CONTROLLER 0
+#endif
+#ifndef EXTRA_JOINTS
+  #define EXTRA_JOINTS 0
+#endif
+
+//joints, [hipL, hipR, ankleL, ankleR, hat, extra joints...]
+#define NUM_LEG_JOINTS 4
+#if HAS_HAT
+  #define HAT_JOINT NUM_LEG_JOINTS
+#endif
+#define NUM_JOINTS (NUM_LEG_JOINTS + HAS_HAT + EXTRA_JOINTS)
+
+#endif
@@ -0,0 +1,90 @@
+//Kinematics.cpp
+//UT Austin RAS Demobots
+
+#include <math.h>
+#include <Arduino.h>
+#include "Kinematics.h"
+
+Kinematics::Kinematics(const HardwareProfile* profile) {
+  for (int i = 0; i < 4; i++) {
+    sign[i] = profile->jointSign[i] < 0 ? -1 : 1;
+  }
+
+  //past 90 - atan2(ankleHeight, footWidth) degrees the foot is over its edge
+  double w = profile->footWidth;
+  double a = profile->ankleHeight;
+  maxAngle = min(KINEMATICS_MAX_ANGLE, (int) floor(90 - atan2(a, w) * 180 / PI));
+  for (int d = 0; d <= maxAngle; d++) {
+    double angle = d * PI / 180;
+    liftTable[d] = w * sin(angle) + a * cos(angle) - a;
+  }
+}
+
+int Kinematics::jointAngle(int joint, double value) {
+  if (joint < 2 || joint > 3) {
+    return (joint < 2 ? sign[joint] : 1) * lround(value);
+  }
+
+  //find the two degrees the lift is between, then interpolate
+  float lift = fabs(value);
+  int angle = maxAngle;
+  if (lift < liftTable[maxAngle]) {
+    int lo = 0;
+    int hi = maxAngle;
+    while (hi - lo > 1) {
+      int mid = (lo + hi) / 2;
+      if (liftTable[mid] <= lift) {lo = mid;}
+      else {hi = mid;}
+    }
+    angle = lround(lo + (lift - liftTable[lo]) / (liftTable[hi] - liftTable[lo]));
+  }
+  return value < 0 ? -sign[joint] * angle : sign[joint] * angle;
+}
+
+double Kinematics::taskValue(int joint, int angle) {
+  if (joint < 2 || joint > 3) {
+    return (joint < 2 ? sign[joint] : 1) * angle;
+  }
+  int a = sign[joint] * angle;
+  double lift = liftTable[min(abs(a), maxAngle)];
+  return a < 0 ? -lift : lift;
+}
+
+int Kinematics::getMaxAngle() {return maxAngle;}
+double Kinematics::getMaxLift() {return liftTable[maxAngle];}
+
+
+//TEST FUNCTIONS
+/* the hand-tuned hop(30) and walk() ankles, through forward and then inverse kinematics, should come back within a degree
+ * and the hop should only lift the body, never tip a foot onto its inner edge (checks jointSign)
+ * prints how high hop(30) lifts this bot, the same angles lift a bigger bot more
+ */
+bool kinematicsTest() {
+  Kinematics kinematics(&dancebotProfile);
+  const HardwareProfile& p = dancebotProfile;
+  int worst = 0;
+  double lowest = 1000;
+  double highest = -1000;
+
+  int samples = p.hopPeriod / 50;
+  for (int s = 0; s < samples; s++) {
+    double ph = 2 * PI * s / samples;
+    for (int i = 0; i < 2; i++) {
+      int hop = lround(p.hopAmp[i] * 30 * sin(ph + p.hopPh0[i] * PI / 180) + p.hopOff[i] * 30);
+      double lift = kinematics.taskValue(2 + i, hop);
+      worst = max(worst, abs(kinematics.jointAngle(2 + i, lift) - hop));
+      lowest = min(lowest, lift);
+      highest = max(highest, lift);
+
+      int walk = lround(15 * sin(ph + PI / 2) - 4);
+      worst = max(worst, abs(kinematics.jointAngle(2 + i, kinematics.taskValue(2 + i, walk)) - walk));
+    }
+  }
+
+  Serial.println(String(p.name) + ": feet tip over at " + String(kinematics.getMaxAngle()) + " degrees, " + String(kinematics.getMaxLift(), 1) + " mm");
+  Serial.println("hop(30) lifts the body " + String(lowest, 1) + " to " + String(highest, 1) + " mm");
+  Serial.println("worst round trip error: " + String(worst) + " degrees");
+  bool passed = worst <= 1 && lowest > -0.5;
+  Serial.println(passed ? "kinematics test PASSED" : "kinematics test FAILED");
+  return passed;
+}
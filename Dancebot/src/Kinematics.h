@@ -0,0 +1,44 @@
+/* Kinematics.h
+ * UT Austin RAS Demobots
+ * Leg model of a dancebot, so moves can be written as foot turns and lifts instead of servo angles
+ *
+ * Task space, [hipL, hipR, ankleL, ankleR]:
+ *    hips: how far the foot is turned out (degrees)
+ *    ankles: how far that side of the body is lifted by tipping the foot onto its outer edge (mm),
+ *            negative tips it onto the inner edge
+ *
+ * The ankle tips the foot about the foot's edge, footWidth out and ankleHeight down from the ankle axis
+ * (see HardwareProfile.h), so lifting the ankle by h takes
+ *    footWidth * sin(angle) + ankleHeight * cos(angle) - ankleHeight = h
+ *    angle = asin((ankleHeight + h) / R) - atan2(ankleHeight, footWidth),  R = sqrt(footWidth^2 + ankleHeight^2)
+ * The lift for every whole degree is worked out once in the constructor,
+ * jointAngle() looks the angle up in that table each sample.
+ */
+
+#ifndef KINEMATICS
+#define KINEMATICS
+
+#include <stdint.h>
+#include "HardwareProfile.h"
+
+//ankle angles in the lift table, 0 to this many degrees
+#define KINEMATICS_MAX_ANGLE 90
+
+class Kinematics {
+public:
+  Kinematics(const HardwareProfile* profile);
+
+  int jointAngle(int joint, double value);   //task space -> servo degrees (inverse kinematics)
+  double taskValue(int joint, int angle);    //servo degrees -> task space (forward kinematics), ankles stop at getMaxLift()
+  int getMaxAngle();                         //ankle angle that puts the foot on its edge, tipping further lowers the body again
+  double getMaxLift();                       //mm, the lift at getMaxAngle()
+
+private:
+  int sign[4];
+  int maxAngle;
+  float liftTable[KINEMATICS_MAX_ANGLE + 1];   //lift for each degree up to maxAngle (mm)
+};
+
+bool kinematicsTest();
+
+#endif
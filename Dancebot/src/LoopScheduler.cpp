@@ -0,0 +1,158 @@
+//LoopScheduler.cpp
+//UT Austin RAS Demobots
+
+#include <string.h>
+#include "LoopScheduler.h"
+
+LoopScheduler::LoopScheduler(unsigned long (*_clock)()) {
+  clock = _clock;
+}
+
+bool LoopScheduler::addTask(const char* name, void (*run)(), int priority, unsigned long period, unsigned long deadline) {
+  if (numTasks >= SCHEDULER_MAX_TASKS) {
+    return false;
+  }
+  //keep the table in priority order, tasks with the same priority in the order they were added
+  int i = numTasks;
+  while (i > 0 && tasks[i - 1].priority > priority) {
+    tasks[i] = tasks[i - 1];
+    i--;
+  }
+  ScheduledTask* task = &tasks[i];
+  memset(task, 0, sizeof(*task));
+  task->name = name;
+  task->run = run;
+  task->priority = priority;
+  task->period = period;
+  task->deadline = deadline;
+  task->nextRun = clock();
+  numTasks++;
+  return true;
+}
+
+/* loop
+ * run each task that is due, most important first, unless it has to wait for a more important one
+ */
+void LoopScheduler::loop() {
+  for (int i = 0; i < numTasks; i++) {
+    ScheduledTask* task = &tasks[i];
+    unsigned long start = clock();
+    if ((long) (start - task->nextRun) < 0) {
+      continue;
+    }
+
+    unsigned long late = start - task->nextRun;
+    if (late <= task->deadline && mustWait(i, start, start + task->maxRunTime)) {
+      task->deferrals++;
+      continue;
+    }
+
+    task->run();
+    unsigned long end = clock();
+
+    task->runs++;
+    if (late > task->deadline) {task->overruns++;}
+    if (late > task->maxLate) {task->maxLate = late;}
+    if (end - start > task->maxRunTime) {task->maxRunTime = end - start;}
+
+    //every pass tasks are late by the time between their runs, periodic ones keep to their period
+    //but don't try to catch up on the runs they missed
+    if (task->period == 0) {
+      task->nextRun = end;
+    }
+    else {
+      task->nextRun += task->period;
+      if ((long) (start - task->nextRun) >= 0) {task->nextRun = start + task->period;}
+    }
+  }
+}
+
+//true if a more important periodic task comes due between now and end
+//one that is already due is waiting for a task before it, which gets checked too
+bool LoopScheduler::mustWait(int task, unsigned long now, unsigned long end) {
+  for (int i = 0; i < task; i++) {
+    ScheduledTask* other = &tasks[i];
+    if (other->priority < tasks[task].priority && other->period != 0 &&
+        (long) (other->nextRun - now) > 0 && (long) (end - other->nextRun) > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int LoopScheduler::getNumTasks() {
+  return numTasks;
+}
+
+const ScheduledTask* LoopScheduler::getTask(int task) {
+  return task >= 0 && task < numTasks ? &tasks[task] : NULL;
+}
+
+void LoopScheduler::printStats(Print* out) {
+  for (int i = 0; i < numTasks; i++) {
+    ScheduledTask* task = &tasks[i];
+    out->println(String(task->name) + ": runs: " + String(task->runs) + " deferred: " + String(task->deferrals) +
+                 " overruns: " + String(task->overruns) + " latest: " + String(task->maxLate) + " us longest: " +
+                 String(task->maxRunTime) + " us");
+  }
+}
+
+void LoopScheduler::resetStats() {
+  for (int i = 0; i < numTasks; i++) {
+    tasks[i].runs = 0;
+    tasks[i].deferrals = 0;
+    tasks[i].overruns = 0;
+    tasks[i].maxLate = 0;
+  }
+}
+
+/* Test
+ * runs made up tasks on a virtual clock, each run moves the clock on by how long the task takes
+ */
+
+static unsigned long testClock = 0;
+static unsigned long testClockMicros() {return testClock;}
+
+static void testMotion() {testClock += 500;}
+static void testWeb() {testClock += 12000;}
+static void testTelemetry() {testClock += 100;}
+static void testSlow() {testClock += 25000;}
+
+//run scheduler for ms of virtual time, with 100 us of other work each pass
+static void testRun(LoopScheduler* scheduler, unsigned long ms) {
+  unsigned long end = testClock + ms * 1000;
+  while ((long) (testClock - end) < 0) {
+    scheduler->loop();
+    testClock += 100;
+  }
+}
+
+bool loopSchedulerTest() {
+  bool passed = true;
+
+  //a 12 ms web page has to fit between 20 ms motion samples, so it waits for the sample then runs
+  LoopScheduler scheduler(testClockMicros);
+  scheduler.addTask("telemetry", testTelemetry, SCHEDULE_TELEMETRY, 100000, 500000);
+  scheduler.addTask("web", testWeb, SCHEDULE_WEB, 10000, 50000);
+  scheduler.addTask("motion", testMotion, SCHEDULE_MOTION, 20000, 2000);
+  testRun(&scheduler, 2000);
+  scheduler.printStats(&Serial);
+  const ScheduledTask* motion = scheduler.getTask(0);
+  const ScheduledTask* web = scheduler.getTask(1);
+  const ScheduledTask* telemetry = scheduler.getTask(2);
+  if (motion->runs < 99 || motion->overruns > 0 || motion->maxLate > 200) {passed = false;}
+  if (web->runs < 90 || web->deferrals == 0 || web->overruns > 0) {passed = false;}
+  if (telemetry->runs < 19 || telemetry->overruns > 0) {passed = false;}
+
+  //a task that never fits still runs once its deadline passes
+  LoopScheduler starved(testClockMicros);
+  starved.addTask("motion", testMotion, SCHEDULE_MOTION, 20000, 2000);
+  starved.addTask("slow", testSlow, SCHEDULE_TELEMETRY, 200000, 30000);
+  testRun(&starved, 2000);
+  starved.printStats(&Serial);
+  const ScheduledTask* slow = starved.getTask(1);
+  if (slow->runs < 9 || slow->overruns < slow->runs - 1) {passed = false;}
+
+  Serial.println(passed ? "loop scheduler test PASSED" : "loop scheduler test FAILED");
+  return passed;
+}
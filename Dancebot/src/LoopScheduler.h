@@ -0,0 +1,70 @@
+/* LoopScheduler.h
+ * UT Austin RAS Demobots
+ * Cooperative scheduler for the work in loop(): motion (when it isn't in the motion task), radio, web server, LEDs and telemetry
+ *
+ * Each task is a function run every period, or every pass with period 0. Lower priorities go first (SCHEDULE_MOTION first),
+ * and a task that is due can wait up to its deadline for a turn.
+ * Every pass of loop() runs the tasks that are due, except that a task is deferred to a later pass when it could still be running
+ * when a more important periodic task is due, going by the longest it has ever run. It only waits until its own deadline,
+ * after that it runs anyway and counts as an overrun, so a slow web page can't be put off forever.
+ * Tasks that run every pass don't hold up the others, they come round again right away.
+ *
+ * Nothing is allocated, there are at most SCHEDULER_MAX_TASKS tasks.
+ * Time comes from micros(), or the clock given to the constructor, so it can be tested on a virtual clock (see loopSchedulerTest).
+ */
+
+#ifndef LOOPSCHEDULER
+#define LOOPSCHEDULER
+
+#include <Arduino.h>
+
+#define SCHEDULER_MAX_TASKS 8
+
+//task priorities, most important first
+enum {
+  SCHEDULE_MOTION,
+  SCHEDULE_RADIO,
+  SCHEDULE_WEB,
+  SCHEDULE_LEDS,
+  SCHEDULE_TELEMETRY
+};
+
+typedef struct ScheduledTask {
+  const char* name;
+  void (*run)();
+  int priority;
+  unsigned long period;       //us between runs, 0 = every pass
+  unsigned long deadline;     //us after it is due that it has to have started by
+  unsigned long nextRun;      //micros() it is due
+
+  //since resetStats()
+  unsigned long runs;
+  unsigned long deferrals;    //passes it waited for a more important task
+  unsigned long overruns;     //runs that started after the deadline
+  unsigned long maxLate;      //us, the latest start
+  unsigned long maxRunTime;   //us, the longest run, kept by resetStats() so deferring still works
+} ScheduledTask;
+
+class LoopScheduler {
+public:
+  LoopScheduler(unsigned long (*_clock)() = micros);
+
+  bool addTask(const char* name, void (*run)(), int priority, unsigned long period, unsigned long deadline);   //false if full
+  void loop();                          //run the tasks that are due, call this each loop()
+
+  int getNumTasks();
+  const ScheduledTask* getTask(int task);   //task-th in priority order
+  void printStats(Print* out);          //one line for each task
+  void resetStats();
+
+private:
+  unsigned long (*clock)();
+  ScheduledTask tasks[SCHEDULER_MAX_TASKS];   //in priority order
+  int numTasks = 0;
+
+  bool mustWait(int task, unsigned long now, unsigned long end);
+};
+
+bool loopSchedulerTest();
+
+#endif
@@ -0,0 +1,116 @@
+/* Messages.h
+ * UT Austin RAS Demobots
+ * ESP-NOW messages between the mothership (WebController) and the other dancebots (BotController)
+ * Both sides are built from this file, so the structs always match
+ *
+ * Joining: a bot broadcasts status Hello until the mothership answers with status SetID (its id),
+ * then keeps sending Hello to the mothership every few seconds so the mothership knows it is still there (see FleetRegistry.h).
+ */
+
+#ifndef MESSAGES
+#define MESSAGES
+
+#include <stddef.h>
+#include <stdint.h>
+
+//message struct that contains info that will be sent to clients
+typedef struct struct_message {
+  int id;
+  int danceMove;
+  bool batteryFlag;
+  float batteryLevel;
+  int status; 
+  char character[32]; 
+  int trims[4];             //servo trims for status SetTrims, [hipL, hipR, ankleL, ankleR]
+  int powerTier;            //the bot's DancingServos power tier, sent with status BattLevel
+  uint8_t target[6];        //MAC of the bot this message is for, all 0xFF = every bot, needed when it is broadcast
+  uint16_t seq;             //command number for acks and duplicates (see ReliableLink.h), 0 = no ack wanted
+  uint16_t tempo;           //fleet tempo (BPM), every command and SetID from the mothership has it, 0 = none
+} struct_message;
+
+//a piece of an uploaded dance routine (see RoutineStore.h), sent with status RoutineChunk
+//the bots tell it apart from struct_message by its length
+#define ROUTINE_CHUNK_SIZE 200
+typedef struct struct_routine_chunk {
+  int status;
+  uint32_t routineCrc;      //crc32 of the whole routine, also identifies the upload
+  uint16_t routineLength;
+  uint16_t offset;          //where data goes in the routine
+  uint16_t length;          //bytes used in data
+  uint16_t reserved;
+  uint32_t chunkCrc;        //crc32 of data
+  uint8_t data[ROUTINE_CHUNK_SIZE];
+} struct_routine_chunk;
+
+//what a bot measured over the last second, sent with status Telemetry every TELEMETRY_INTERVAL_MS
+//the mothership keeps a history of these for each bot (see FleetTelemetry.h)
+#define TELEMETRY_INTERVAL_MS 1000
+typedef struct TelemetrySample {
+  uint8_t battery;          //%
+  uint8_t danceMove;        //current dance move, see DancingServos.h
+  int8_t rssi;              //dBm of the mothership's messages, 0 = none heard
+  uint8_t jitter;           //longest time between loop() calls, ms (255 max)
+  uint16_t lag;             //longest time from receiving a command to starting it, ms
+  uint8_t powerTier;        //see DancingServos.h
+  uint8_t resetReason;      //esp_reset_reason() of the last boot
+} TelemetrySample;
+
+typedef struct struct_telemetry {
+  int status;               //Telemetry
+  int id;
+  TelemetrySample sample;
+} struct_telemetry;
+
+//the mothership's beat beacon, broadcast on every beat with status Beat, the bots' BeatClocks follow it (see BeatClock.h)
+typedef struct struct_beat {
+  int status;               //Beat
+  uint32_t beat;            //beat number of beatTime
+  int64_t time;             //mothership's fleet time when it sent this (us)
+  int64_t beatTime;         //fleet time of the beat (us)
+  uint16_t tempo;           //BPM
+  uint16_t reserved;
+} struct_beat;
+
+//live tuning from the mothership's "/tune", broadcast with status Tune (see WebController.cpp)
+//only the header and count deltas are sent, so the bots tell it apart by its status and a length that matches count
+#define TUNE_MAX_DELTAS 13        //amp, off and ph0 of each leg joint, and the period
+#define TUNE_START 0x01           //flags: start the tuned move, the frame has every parameter
+typedef struct TuneDelta {
+  uint8_t joint;            //[hipL, hipR, ankleL, ankleR]
+  uint8_t param;            //TUNE_ in DancingServos.h
+  int16_t value;
+} TuneDelta;
+
+typedef struct struct_tune {
+  int status;               //Tune
+  uint16_t seq;             //frame number, a bot skips frames older than the last one it took
+  uint8_t count;            //deltas sent
+  uint8_t flags;
+  uint64_t bots;            //bit id set for each bot that takes it
+  TuneDelta deltas[TUNE_MAX_DELTAS];
+} struct_tune;
+#define TUNE_HEADER_SIZE offsetof(struct_tune, deltas)
+
+//dance move enums are in DancingServos.h
+// enum for return info
+enum{
+  None,
+  SetID,
+  BattLevel,
+  QueueMove,    //add the dance move to the move queue instead of starting it right away
+  RoutineChunk, //struct_routine_chunk with part of an uploaded dance routine
+  SetTrims,     //set and save the servo trims in the message
+  Hello,        //bot -> mothership, join the fleet or say it is still there
+  Ack,          //bot -> mothership, got the command with this seq
+  Telemetry,    //bot -> mothership, struct_telemetry
+  SetTempo,     //only change the tempo, the bots keep dancing the same move
+  Beat,         //mothership -> bots, struct_beat
+  Tune,         //mothership -> bots, struct_tune
+  DeleteRoutine, //delete the uploaded routine named in character
+}; 
+
+extern uint8_t broadcastAddress[6];
+
+void printMACAddress();
+
+#endif
@@ -0,0 +1,69 @@
+//Microphone.cpp
+//UT Austin RAS Demobots
+
+#include "HardwareProfile.h"
+#if HAS_MICROPHONE
+
+#include <Arduino.h>
+#include <driver/i2s.h>
+#include "BeatTracker.h"
+#include "Microphone.h"
+
+//raw 32 bit slots, read a DMA buffer's worth at a time
+static int32_t micBuffer[MIC_DMA_SAMPLES];
+static unsigned long micOverruns = 0;
+
+bool microphoneBegin() {
+  i2s_config_t config = {};
+  config.mode = (i2s_mode_t) (I2S_MODE_MASTER | I2S_MODE_RX);
+  config.sample_rate = BEAT_SAMPLE_RATE;
+  config.bits_per_sample = I2S_BITS_PER_SAMPLE_32BIT;
+  config.channel_format = I2S_CHANNEL_FMT_ONLY_LEFT;
+  config.communication_format = I2S_COMM_FORMAT_STAND_I2S;
+  config.intr_alloc_flags = 0;
+  config.dma_buf_count = MIC_DMA_BUFFERS;
+  config.dma_buf_len = MIC_DMA_SAMPLES;
+  config.use_apll = false;
+
+  i2s_pin_config_t pins = {};
+  pins.bck_io_num = MIC_SCK_PIN;
+  pins.ws_io_num = MIC_WS_PIN;
+  pins.data_out_num = I2S_PIN_NO_CHANGE;
+  pins.data_in_num = MIC_SD_PIN;
+
+  if (i2s_driver_install(I2S_NUM_0, &config, 0, NULL) != ESP_OK) {
+    Serial.println("No microphone: I2S driver install failed");
+    return false;
+  }
+  if (i2s_set_pin(I2S_NUM_0, &pins) != ESP_OK) {
+    Serial.println("No microphone: I2S pins failed");
+    i2s_driver_uninstall(I2S_NUM_0);
+    return false;
+  }
+  return true;
+}
+
+int microphoneRead(int16_t* samples, int max) {
+  int count = 0;
+  int reads = 0;
+  while (count < max) {
+    size_t bytes = 0;
+    int want = min(max - count, MIC_DMA_SAMPLES);
+    //timeout 0, only what is already in the DMA buffers
+    if (i2s_read(I2S_NUM_0, micBuffer, want * sizeof(int32_t), &bytes, 0) != ESP_OK || bytes == 0) {
+      break;
+    }
+    for (int i = 0; i < (int) (bytes / sizeof(int32_t)); i++) {
+      samples[count++] = (int16_t) constrain(micBuffer[i] >> MIC_SHIFT, -32768, 32767);
+    }
+    reads++;
+  }
+  if (reads >= MIC_DMA_BUFFERS) {micOverruns++;}
+  return count;
+}
+
+unsigned long microphoneGetOverruns() {
+  return micOverruns;
+}
+
+#endif
@@ -0,0 +1,27 @@
+/* Microphone.h
+ * UT Austin RAS Demobots
+ * Mothership only: an I2S MEMS microphone (INMP441) for following the music's beat (see BeatTracker.h)
+ *
+ * The I2S driver fills DMA buffers in the background at BEAT_SAMPLE_RATE, microphoneRead() takes what has come in
+ * without waiting, so it can be called from loop(). The INMP441 sends 24 bit samples in 32 bit slots on the left channel
+ * (L/R pin to ground), they are cut down to 16 bits with MIC_SHIFT, raise it if loud music clips.
+ * MIC_DMA_BUFFERS * MIC_DMA_SAMPLES samples are buffered, 64 ms, so loop() can be that late before samples are lost.
+ */
+
+#ifndef MICROPHONE
+#define MICROPHONE
+
+#include <stdint.h>
+
+#define MIC_SCK_PIN 32
+#define MIC_WS_PIN 25
+#define MIC_SD_PIN 33
+#define MIC_SHIFT 14              //32 bit slot to 16 bit sample
+#define MIC_DMA_BUFFERS 4
+#define MIC_DMA_SAMPLES 256
+
+bool microphoneBegin();                         //false if there is no I2S driver, e.g. in the simulator
+int microphoneRead(int16_t* samples, int max);  //samples that came in since the last call, up to max
+unsigned long microphoneGetOverruns();          //reads that found every DMA buffer full, samples were probably lost
+
+#endif
@@ -0,0 +1,113 @@
+/* MoveAlgebra.h
+ * UT Austin RAS Demobots
+ * Dance moves as values that can be mirrored, reversed, sped up and added together at compile time
+ *
+ * A MoveShape is the leg sinusoids of one move, [hipL, hipR, ankleL, ankleR], phases in degrees.
+ * The functions below are constexpr, so a move made from another one is worked out by the compiler:
+ *    static constexpr MoveShape stankLeft = {{-40, 0, 30, 0}, {0, 0, 0, 0}, {0, 0, 90, 0}, 2000};
+ *    static constexpr MoveShape stankRight = mirror(stankLeft);
+ * and starting it with DancingServos::startShape() costs the same as a move written out by hand, every tick after that too.
+ * A list of shapes is a move sequence, DancingServos::startShapes() plays one after the other.
+ *
+ * mirror()    the same move on the other side of the body, the hips turn the other way
+ * reverse()   the phases negated, e.g. walk backwards
+ * flip()      the joints in a mask turn the other way
+ * timeScale() the period scaled by a percentage
+ * withPeriod() the same move at another period
+ * sum()       both moves at once, the sinusoids of each joint are added into one (a sum of sinusoids with the same
+ *             period is a sinusoid), both moves have to have the same period
+ *
+ * sum() uses sin, cos, atan2 and sqrt, GCC works those out at compile time for constant moves.
+ */
+
+#ifndef MOVEALGEBRA
+#define MOVEALGEBRA
+
+#include <math.h>
+
+//joint masks for flip()
+#define JOINT_HIP_L (1 << 0)
+#define JOINT_HIP_R (1 << 1)
+#define JOINT_ANKLE_L (1 << 2)
+#define JOINT_ANKLE_R (1 << 3)
+#define JOINT_HIPS (JOINT_HIP_L | JOINT_HIP_R)
+#define JOINT_ANKLES (JOINT_ANKLE_L | JOINT_ANKLE_R)
+
+typedef struct MoveShape {
+  int amp[4];       //degrees
+  int off[4];       //degrees
+  double ph0[4];    //degrees
+  int period;       //ms
+} MoveShape;
+
+constexpr MoveShape mirror(const MoveShape& m) {
+  return {{-m.amp[1], -m.amp[0], m.amp[3], m.amp[2]},
+          {-m.off[1], -m.off[0], m.off[3], m.off[2]},
+          {m.ph0[1], m.ph0[0], m.ph0[3], m.ph0[2]},
+          m.period};
+}
+
+constexpr MoveShape reverse(const MoveShape& m) {
+  return {{m.amp[0], m.amp[1], m.amp[2], m.amp[3]},
+          {m.off[0], m.off[1], m.off[2], m.off[3]},
+          {-m.ph0[0], -m.ph0[1], -m.ph0[2], -m.ph0[3]},
+          m.period};
+}
+
+constexpr int flipSign(int mask, int joint) {
+  return (mask & (1 << joint)) != 0 ? -1 : 1;
+}
+
+constexpr MoveShape flip(const MoveShape& m, int mask) {
+  return {{flipSign(mask, 0) * m.amp[0], flipSign(mask, 1) * m.amp[1], flipSign(mask, 2) * m.amp[2], flipSign(mask, 3) * m.amp[3]},
+          {flipSign(mask, 0) * m.off[0], flipSign(mask, 1) * m.off[1], flipSign(mask, 2) * m.off[2], flipSign(mask, 3) * m.off[3]},
+          {m.ph0[0], m.ph0[1], m.ph0[2], m.ph0[3]},
+          m.period};
+}
+
+constexpr MoveShape withPeriod(const MoveShape& m, int period) {
+  return {{m.amp[0], m.amp[1], m.amp[2], m.amp[3]},
+          {m.off[0], m.off[1], m.off[2], m.off[3]},
+          {m.ph0[0], m.ph0[1], m.ph0[2], m.ph0[3]},
+          period};
+}
+
+constexpr MoveShape timeScale(const MoveShape& m, int percent) {
+  return withPeriod(m, m.period * percent / 100);
+}
+
+//one joint of sum(): add the two sinusoids as phasors (x = amp * cos(ph0), y = amp * sin(ph0))
+constexpr double phasorX(const MoveShape& a, const MoveShape& b, int i) {
+  return a.amp[i] * cos(a.ph0[i] * M_PI / 180) + b.amp[i] * cos(b.ph0[i] * M_PI / 180);
+}
+
+constexpr double phasorY(const MoveShape& a, const MoveShape& b, int i) {
+  return a.amp[i] * sin(a.ph0[i] * M_PI / 180) + b.amp[i] * sin(b.ph0[i] * M_PI / 180);
+}
+
+constexpr int sumAmp(const MoveShape& a, const MoveShape& b, int i) {
+  return (int) lround(sqrt(phasorX(a, b, i) * phasorX(a, b, i) + phasorY(a, b, i) * phasorY(a, b, i)));
+}
+
+//a joint that cancels out keeps phase 0
+constexpr double sumPhase(const MoveShape& a, const MoveShape& b, int i) {
+  return sumAmp(a, b, i) == 0 ? 0 : atan2(phasorY(a, b, i), phasorX(a, b, i)) * 180 / M_PI;
+}
+
+constexpr MoveShape sum(const MoveShape& a, const MoveShape& b) {
+  return {{sumAmp(a, b, 0), sumAmp(a, b, 1), sumAmp(a, b, 2), sumAmp(a, b, 3)},
+          {a.off[0] + b.off[0], a.off[1] + b.off[1], a.off[2] + b.off[2], a.off[3] + b.off[3]},
+          {sumPhase(a, b, 0), sumPhase(a, b, 1), sumPhase(a, b, 2), sumPhase(a, b, 3)},
+          a.period};
+}
+
+//true if two shapes give the same move, for static_assert
+constexpr bool sameJoint(const MoveShape& a, const MoveShape& b, int i) {
+  return a.amp[i] == b.amp[i] && a.off[i] == b.off[i] && (a.amp[i] == 0 || fabs(a.ph0[i] - b.ph0[i]) < 0.5);
+}
+
+constexpr bool sameShape(const MoveShape& a, const MoveShape& b) {
+  return a.period == b.period && sameJoint(a, b, 0) && sameJoint(a, b, 1) && sameJoint(a, b, 2) && sameJoint(a, b, 3);
+}
+
+#endif
@@ -5,6 +5,8 @@
 #include <Arduino.h>
   
 #include "Oscillator.h"
+#include "TraceRecorder.h"
+#include "Kinematics.h"
 
 //#define PI 3.14159265358979323846
 
@@ -15,9 +17,13 @@ Oscillator::Oscillator() {
   this->servoAttached = false;
   this->t_lastRefresh = 0;
   this->ph = 0;
+  this->joint = 0xFF;
+  this->kinematics = NULL;
+  this->trim = 0;     //until setTrim(), DancingServos::setTrims() sets them from flash
+  this->pos = 0;
 
   //default sinusoid values
-  samplePeriod = 50;
+  samplePeriod = SERVO_FRAME_MS;
   this->setAmp(30);
   this->setOff(0);
   this->setPh0(0);
@@ -35,6 +41,10 @@ Oscillator::Oscillator( int a,  int o, double p0,  int t, bool r) {
   this->servoAttached = false;
   this->t_lastRefresh = 0;
   this->ph = 0;
+  this->joint = 0xFF;
+  this->kinematics = NULL;
+  this->trim = 0;     //until setTrim(), DancingServos::setTrims() sets them from flash
+  this->pos = 0;
 
   //default sinusoid values
   samplePeriod = 30;
@@ -54,17 +64,27 @@ Oscillator::Oscillator( int a,  int o, double p0,  int t, bool r) {
 //set servo pos based on sinusoid
 void Oscillator::refreshPos() {
   if (this->servoAttached && this->checkRefreshTime()) {
-    //Serial.print("phInc: " + String(this->phInc));
-    if (!this->isStopped) {
-        //if the refresh time is complete and the motor is not stopped
-        //calculate the current pos in the sinusoid
-        int newPos = this->rev * round(double(this->amp) * double(sin(this->ph + this->ph0)) + double(this->off));
-        this->setPos(newPos);
-    }
-    this->ph += this->phInc;    //increment the phase
-    if (this->ph > 2 * PI) {this->resetPh();}
+    this->sample();
   }
 }
+//take the next sample of the sinusoid
+//DancingServos calls this directly so all four servos share one sample clock
+void Oscillator::sample() {
+  //Serial.print("phInc: " + String(this->phInc));
+  if (!this->isStopped) {
+      //if the motor is not stopped
+      //calculate the current pos in the sinusoid
+      double value = double(this->amp) * double(sin(this->ph + this->ph0)) + double(this->off);
+      int newPos;
+      if (this->kinematics == NULL) {newPos = this->rev * round(value);}
+      else {newPos = this->kinematics->jointAngle(this->joint, this->rev * value);}
+      this->setPos(newPos);
+  }
+  this->ph += this->phInc;    //increment the phase
+  //wrap around without dropping the part past 2 PI, so a period that isn't a whole number of samples doesn't jump
+  //fmod and not a loop, this runs in the motion task and shiftPh() can move the phase any distance
+  if (this->ph >= 2 * PI) {this->ph = fmod(this->ph, 2 * PI);}
+}
 //check if refresh time increment has passed
 bool Oscillator::checkRefreshTime() {
   //check if samplePeriod (ms) has passed since last checkRefreshTime() call
@@ -89,6 +109,7 @@ void Oscillator::detach() {
     this->servoAttached = false;
   }
 }
+void Oscillator::setJoint(int j) {this->joint = j;}
 
 
 //SINUSOID PARAMETERS
@@ -100,25 +121,44 @@ void Oscillator::setOff( int o) { this->off = o;}
 void Oscillator::setPh0(double p0) {this->ph0 = p0;}
 //set Period (ms)
 void Oscillator::setPer( int t) {
+  //at least a sample, a period of 0 would make the phase step infinite
+  if (t < this->samplePeriod) {t = this->samplePeriod;}
   this->period = t;
   double n = double(this->period) / double(this->samplePeriod);  //n = number of samples
   this->phInc = (2.0 * PI) / n;
   //Serial.print("n: " + String(n) + " phInc: " + String(this->phInc));
 }
+//get how often the sinusoid is sampled (ms)
+int Oscillator::getSamplePeriod() {return this->samplePeriod;}
 //Set Sinusoid Reverse on/off (default off) (sin reverse not servo reverse)
 void Oscillator::setRev(bool r) {
   if (r) {this->rev = -1;}
   else {this->rev = 1;}
 }
+//the sinusoid is in task space (see Kinematics.h), the joint number picks the hip or ankle model
+void Oscillator::setKinematics(Kinematics* k) {this->kinematics = k;}
 
 
 //CONTROL
-void Oscillator::stopO() {this->isStopped = true;}
-void Oscillator::startO() {this->isStopped = false;}
+void Oscillator::stopO() {
+  if (!this->isStopped) {TRACE(TRACE_STOP, this->joint, 0, 0, 0);}
+  this->isStopped = true;
+}
+//the trace gets the sinusoid the next samples come from
+void Oscillator::startO() {
+  this->isStopped = false;
+#if TRACE_ENABLED
+  long phase = lround((this->ph + this->ph0) * 1800.0 / PI) % 3600;
+  if (phase < 0) {phase += 3600;}
+  TRACE(TRACE_WAVE, this->joint, this->rev * this->amp, this->rev * this->off, this->period);
+  TRACE(TRACE_PHASE, this->joint, phase, this->kinematics != NULL, 0);
+#endif
+}
 //set Position (degrees)
 void Oscillator::setPos(int p) {
   this->pos = p;
   servo->write(p + this->trim);
+  TRACE(TRACE_POS, this->joint, p, this->trim, 0);
   //Serial.print("pos: " + String(p) + " ph: " + String(this->ph) + " phInc: " + String(this->phInc) + "amp: " + String(this->amp) + "\n");
 }
 int Oscillator::getPos() {
@@ -130,6 +170,10 @@ int Oscillator::getPos() {
 void Oscillator::resetPh() {
   this->ph = 0;
 }
+double Oscillator::getPh() {return this->ph;}
+void Oscillator::shiftPh(double samples) {
+  this->ph += samples * this->phInc;
+}
 
 //CALIBRATION
 void Oscillator::setTrim(int t) {this->trim = t;}
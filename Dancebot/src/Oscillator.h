@@ -20,10 +20,15 @@
  
 #include <ESP32Servo.h>
 
+class Kinematics;
+
 //These values depend on the servo motors, check the data sheet for minUs and maxUs. Used for Oscillator::attach().
 #define MIN_US 900
 #define MAX_US 2100
 
+//the servo PWM period (50 Hz), the sinusoids are sampled once per PWM frame
+#define SERVO_FRAME_MS 20
+
 
 class Oscillator {
 public:
@@ -33,16 +38,20 @@ public:
   //setup functions from Servo class
   void attach(int pin);
   void detach();
+  void setJoint(int j);           //which joint this is in the trace (see TraceRecorder.h)
 
   //sinusoid functions
   void refreshPos();              //set servo pos based on sinusoid
+  void sample();                  //take the next sample of the sinusoid now, without checking the refresh time
   
   //sinusoid parameters
   void setAmp(int a);             //set Amplitude (degrees)
   void setOff(int o);             //set Offset (degrees)
   void setPh0(double p0);         //set Initial Phase (radians)
-  void setPer(int t); //set Period (ms)
+  void setPer(int t);             //set Period (ms), the phase carries on from where it is
   void setRev(bool r);            //Set Reverse on/off (default off)
+  void setKinematics(Kinematics* k);   //the sinusoid is a foot turn or lift for this Kinematics, NULL = servo degrees (default)
+  int getSamplePeriod();          //get how often the sinusoid is sampled (ms)
 
   //control
   void stopO();
@@ -50,6 +59,8 @@ public:
   void setPos(int p);             //set Position (degrees)
   int getPos();                 
   void resetPh();                 //set Current Phase to 0
+  double getPh();                 //get Current Phase (radians), 0 to 2 PI
+  void shiftPh(double samples);   //move the Current Phase on by a number of samples, a part of one or back with a negative
 
   //calibration (if we need it, built into refreshPos, just call setTrim)
   void setTrim(int t);       //set Trim (degrees)
@@ -71,6 +82,7 @@ private:
   double ph0;           //Initial Phase (radians)
   int period;           //Period (ms)
   int rev;              //Reverse Sinusoid multiplier (1 = no rev, -1 = rev)
+  Kinematics* kinematics;   //turns the sinusoid into servo degrees, NULL = it already is
 
   //servo status variables
   bool isStopped;
@@ -81,6 +93,8 @@ private:
 
   //calibration (if we need it)
   int trim;     //add to position (degrees)
+
+  uint8_t joint;  //joint number in the trace
 };
 
 void oscillatorTest();
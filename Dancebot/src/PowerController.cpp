@@ -0,0 +1,336 @@
+/* ESP32 Power Controller for Dancebot
+ *
+ * Implementation for checking battery level and going into modem power saving mode.
+ * Espressif documentation for WiFi power saving mode:
+ * https://docs.espressif.com/projects/esp-idf/en/latest/esp32/api-guides/wifi.html#esp32-wi-fi-power-saving-mode
+ *
+ * To see resistor divider and/or battery level checker, look for PCB schematic on Github
+ * 
+ */
+
+#include "HardwareProfile.h"
+#if HAS_POWER_CONTROLLER
+
+#include <Arduino.h>
+#include <esp_wifi.h>
+#include <esp_timer.h>
+#include <esp_now.h>
+#include <PowerController.h>
+
+//pin mappings
+//#define ADC_IN 27 //ADC pin 27 doesn't work when WiFi is running....
+#define ADC_IN 33 //CHANGED FROM PCB SCH, pin 33 works w/ WiFi
+#define BAT_EN 4
+#define LATCH_OUT 5
+
+//resistor divider
+#define R2 100 
+#define R3 51
+#define VOUT(Vin) (((Vin) * R3) / (R2 + R3))
+
+//ADC -> battery mV: 3.3 V full scale, 1.1 is scale factor to correct ADC reading, resistor divides by 3
+#define ADC_TO_MV(adc) ((adc) * 10890 / 4095)
+
+//discharge curve of the 2 cell battery without load, mV at 0%, 10%, ... 100%
+//8.4 V full and 6.5 V empty, the flat part in the middle is why a linear map of the voltage doesn't work
+static const int16_t dischargeCurve[11] = {6500, 7380, 7460, 7540, 7580, 7640, 7740, 7840, 7960, 8120, 8400};
+
+//median of n samples, sorts samples
+static int medianOf(int* samples, int n) {
+    for (int i = 1; i < n; i++) {
+        int s = samples[i];
+        int j = i - 1;
+        for (; j >= 0 && samples[j] > s; j--) {
+            samples[j + 1] = samples[j];
+        }
+        samples[j + 1] = s;
+    }
+    return samples[n / 2];
+}
+
+//state of charge (%) for a voltage without load, interpolated on dischargeCurve
+static int stateOfCharge(int mv) {
+    if (mv <= dischargeCurve[0]) return 0;
+    for (int i = 1; i < 11; i++) {
+        if (mv < dischargeCurve[i]) {
+            return (i - 1) * 10 + (mv - dischargeCurve[i - 1]) * 10 / (dischargeCurve[i] - dischargeCurve[i - 1]);
+        }
+    }
+    return 100;
+}
+
+static int readBatteryAdc(void) {
+    return analogRead(ADC_IN);
+}
+
+static void batteryTimerCallback(void* arg) {
+    ((PowerController*) arg)->sampleBattery();
+}
+
+PowerController::PowerController(void){
+    readAdc = readBatteryAdc;
+    batteryPercentage = 100;
+    loadCurrent = 0;
+    batteryTick = 0;
+    batteryFilterMv = -1;
+    batteryReadings = 0;
+
+    powerState = POWER_ACTIVE;
+    idleSince = 0;
+    stateStart = 0;
+    for (int i = 0; i < NUM_POWER_STATES; i++) {
+        stateMillis[i] = 0;
+    }
+    lastPowerLog = 0;
+}
+
+void PowerController::powerOnSystem(void){
+    digitalWrite(LATCH_OUT, 1);
+}
+
+//TO DO: Test if power consumption decreases
+void PowerController::startWiFiPowerSave(void){
+    esp_wifi_set_ps(WIFI_PS_MIN_MODEM); //sets to Modem-sleep mode
+    //the bots aren't connected to an access point, so ESP-NOW listens in wake windows instead of at DTIM beacons
+    esp_wifi_connectionless_module_set_wake_interval(IDLE_WAKE_INTERVAL_MS);
+    esp_now_set_wake_window(IDLE_WAKE_WINDOW_MS);
+}
+
+void PowerController::endWiFiPowerSave(void){
+    esp_wifi_set_ps(WIFI_PS_NONE);  //disable modem-sleep mode
+}
+
+void PowerController::batteryADCInit(void){
+    adcAttachPin(ADC_IN);
+    pinMode(BAT_EN, OUTPUT);
+    digitalWrite(BAT_EN, 0); //disable battery lvl circuit  CHANGE THIS BACK TO 0
+
+    esp_timer_create_args_t timerArgs = {};
+    timerArgs.callback = batteryTimerCallback;
+    timerArgs.arg = this;
+    timerArgs.name = "battery";
+    esp_timer_handle_t timer;
+    if (esp_timer_create(&timerArgs, &timer) != ESP_OK || esp_timer_start_periodic(timer, BATTERY_TICK_MS * 1000) != ESP_OK) {
+        Serial.println("Failed to start battery timer");
+    }
+}
+
+float PowerController::getBatteryPercentage(void){
+    return batteryPercentage;
+}
+
+int PowerController::getBatteryMillivolts(void){
+    int32_t filtered = batteryFilterMv;
+    return filtered < 0 ? -1 : filtered >> 8;
+}
+
+void PowerController::setLoadCurrent(int mA){
+    loadCurrent = mA;
+}
+
+uint32_t PowerController::getBatteryReadings(void){
+    return batteryReadings;
+}
+
+/* sampleBattery
+ * tick 0: enable the battery lvl checker, the divider settles for a tick
+ * ticks 1 - BATTERY_MEDIAN_SIZE: take a sample each tick, corrected for the voltage drop across the internal resistance
+ * then disable the checker, filter the median into the battery level and wait for the next window
+ * integer math only, this runs in the timer task
+ */
+void PowerController::sampleBattery(void){
+    if (batteryTick == 0) {
+        digitalWrite(BAT_EN, 1); //enable battery lvl checker
+    }
+    else if (batteryTick <= BATTERY_MEDIAN_SIZE) {
+        int current = BOARD_CURRENT_MA + loadCurrent;
+        batterySamples[batteryTick - 1] = ADC_TO_MV(readAdc()) + current * BATTERY_RESISTANCE_MOHM / 1000;
+    }
+
+    if (batteryTick == BATTERY_MEDIAN_SIZE) {
+        digitalWrite(BAT_EN, 0); //disable battery lvl checker
+
+        int32_t median = medianOf(batterySamples, BATTERY_MEDIAN_SIZE) << 8;
+        int32_t filtered = batteryFilterMv;
+        if (filtered < 0) {
+            filtered = median;      //first reading starts the EMA
+        }
+        else {
+            filtered += (median - filtered) >> BATTERY_EMA_SHIFT;
+        }
+
+        batteryFilterMv = filtered;
+        batteryPercentage = stateOfCharge(filtered >> 8);
+        batteryReadings++;
+    }
+
+    batteryTick++;
+    if (batteryTick >= BATTERY_WINDOW_TICKS) {
+        batteryTick = 0;
+    }
+}
+
+//IDLE POWER MANAGER
+
+/* loopPowerSave
+ * active -> idle once the bot has been idle for IDLE_DELAY_MS, idle listening while listen is set
+ * idle -> active right away, on the same loop() that starts a move (e.g. one just received over ESP-NOW)
+ * the two idle states switch when listen changes
+ */
+void PowerController::loopPowerSave(bool idle, bool listen){
+    unsigned long t = millis();
+    int idleState = listen ? POWER_IDLE_LISTEN : POWER_IDLE;
+    if (!idle) {
+        idleSince = t;
+        if (powerState != POWER_ACTIVE) {
+            setPowerState(POWER_ACTIVE, t);
+        }
+    }
+    else if (powerState != idleState && (powerState != POWER_ACTIVE || t - idleSince >= IDLE_DELAY_MS)) {
+        setPowerState(idleState, t);
+    }
+
+    if (t - lastPowerLog >= POWER_LOG_INTERVAL_MS) {
+        lastPowerLog = t;
+        Serial.println("Power state time: active " + String(getPowerStateMillis(POWER_ACTIVE) / 1000) + " s, idle " + String(getPowerStateMillis(POWER_IDLE) / 1000) +
+                       " s, idle listening " + String(getPowerStateMillis(POWER_IDLE_LISTEN) / 1000) + " s");
+    }
+}
+
+int PowerController::getPowerState(void){
+    return powerState;
+}
+
+unsigned long PowerController::getPowerStateMillis(int state){
+    unsigned long ms = stateMillis[state];
+    if (state == powerState) {
+        ms += millis() - stateStart;
+    }
+    return ms;
+}
+
+void PowerController::setPowerState(int state, unsigned long t){
+    stateMillis[powerState] += t - stateStart;
+    stateStart = t;
+    powerState = state;
+
+    if (state == POWER_IDLE) {
+        startWiFiPowerSave();
+        setCpuFrequencyMhz(IDLE_CPU_MHZ);
+    }
+    else if (state == POWER_IDLE_LISTEN) {
+        endWiFiPowerSave();
+        setCpuFrequencyMhz(IDLE_CPU_MHZ);
+    }
+    else {
+        setCpuFrequencyMhz(ACTIVE_CPU_MHZ);
+        endWiFiPowerSave();
+    }
+}
+
+
+
+//TEST FUNCTIONS
+
+#define TEST_OPEN_MV 7800           //open circuit voltage, about 70 %
+#define TEST_SAG_TICKS 1000         //20 s, 40 readings
+#define TEST_SAG_MAX_ERROR_MV 20    //after the EMA settles
+
+static int testAdc;
+
+static int testReadAdc(void) {
+    return testAdc;
+}
+
+//servo current (mA) and extra sag (mV) on a tick for each waveform
+static void testSag(int shape, int tick, int* load, int* spike) {
+    *load = 0;
+    *spike = 0;
+    switch (shape) {
+        case 1: *spike = tick % 7 == 0 ? 1500 : 0; break;           //a servo starting, one tick
+        case 2: *spike = tick % 11 < 2 ? 1200 : 0; break;           //two ticks, the median still has three clean samples
+        case 3: *load = 1500; break;                                //every servo running
+        case 4: *load = 800 + lround(700 * sin(2 * PI * tick / 75.0)); break;   //a 1500 ms move
+    }
+}
+
+bool batterySagTest(void) {
+    bool passed = true;
+    for (int shape = 0; shape <= 4; shape++) {
+        PowerController power;
+        power.readAdc = testReadAdc;
+        if (power.getBatteryMillivolts() != -1 || power.getBatteryPercentage() != 100) {passed = false;}
+
+        int worstSample = 0;
+        int worstReading = 0;
+        uint32_t readings = 0;
+        for (int tick = 0; tick < TEST_SAG_TICKS; tick++) {
+            int load;
+            int spike;
+            testSag(shape, tick, &load, &spike);
+            int mv = TEST_OPEN_MV - (BOARD_CURRENT_MA + load) * BATTERY_RESISTANCE_MOHM / 1000 - spike;
+            testAdc = mv * 4095 / 10890;
+            if (abs(TEST_OPEN_MV - mv) > worstSample) {worstSample = abs(TEST_OPEN_MV - mv);}
+            power.setLoadCurrent(load);
+            power.sampleBattery();
+
+            //from the 10th reading on
+            if (power.getBatteryReadings() != readings && ++readings >= 10) {
+                int error = abs(power.getBatteryMillivolts() - TEST_OPEN_MV);
+                if (error > worstReading) {worstReading = error;}
+            }
+        }
+        if (worstReading > TEST_SAG_MAX_ERROR_MV || power.getBatteryReadings() != TEST_SAG_TICKS / BATTERY_WINDOW_TICKS) {
+            passed = false;
+        }
+        Serial.println("sag " + String(shape) + ": the battery dropped up to " + String(worstSample) + " mV, the level was off by up to " +
+                       String(worstReading) + " mV");
+    }
+    Serial.println(passed ? "battery sag test PASSED" : "battery sag test FAILED");
+    return passed;
+}
+
+
+#define TEST_TRACE_TICKS 180000     //one hour from full to empty
+#define TEST_TRACE_MAX_ERROR 5      //% after the EMA settles
+
+//open circuit voltage (mV) at a state of charge (%), the inverse of stateOfCharge()
+static int testOpenCircuit(double soc) {
+    int i = soc >= 100 ? 9 : (int) (soc / 10);
+    return dischargeCurve[i] + lround((dischargeCurve[i + 1] - dischargeCurve[i]) * (soc - i * 10) / 10);
+}
+
+//replay a discharge: 10 s of dancing (a 1500 ms move) then 5 s standing still, over and over
+//returns the worst state of charge error (%) from the 10th reading on
+static int testTrace(PowerController* power, bool correct) {
+    int worst = 0;
+    uint32_t readings = 0;
+    for (int tick = 0; tick < TEST_TRACE_TICKS; tick++) {
+        double soc = 100.0 * (TEST_TRACE_TICKS - tick) / TEST_TRACE_TICKS;
+        int load = tick % 750 < 500 ? 800 + lround(700 * sin(2 * PI * tick / 75.0)) : 0;
+        testAdc = (testOpenCircuit(soc) - (BOARD_CURRENT_MA + load) * BATTERY_RESISTANCE_MOHM / 1000) * 4095 / 10890;
+        power->setLoadCurrent(correct ? load : 0);
+        power->sampleBattery();
+
+        if (power->getBatteryReadings() != readings && ++readings >= 10) {
+            int error = abs(lround(power->getBatteryPercentage() - soc));
+            if (error > worst) {worst = error;}
+        }
+    }
+    return worst;
+}
+
+bool batteryTraceTest(void) {
+    PowerController power;
+    PowerController uncorrectedPower;
+    power.readAdc = testReadAdc;
+    uncorrectedPower.readAdc = testReadAdc;
+    int corrected = testTrace(&power, true);
+    int uncorrected = testTrace(&uncorrectedPower, false);
+    bool passed = corrected <= TEST_TRACE_MAX_ERROR && corrected < uncorrected;
+    Serial.println("state of charge off by up to " + String(corrected) + " %, " + String(uncorrected) + " % without the load correction");
+    Serial.println(passed ? "battery trace test PASSED" : "battery trace test FAILED");
+    return passed;
+}
+
+#endif
@@ -0,0 +1,112 @@
+/* PowerController.h
+ * UT Austin RAS Demobots
+ * 
+ * The battery level is sampled in the background by a timer started in batteryADCInit().
+ * Each reading is the median of a few samples, smoothed with an EMA, so short voltage drops when the servos
+ * draw current don't show up in the battery level. getBatteryPercentage() only returns the last reading,
+ * so it is safe to call from anywhere, including the ESP-NOW callbacks.
+ *
+ * The servos pull the battery voltage down while they move, so each sample is corrected for the load current
+ * (setLoadCurrent) and the battery's internal resistance, then the state of charge is looked up on a discharge curve.
+ *
+ * loopPowerSave() turns on WiFi modem sleep and lowers the CPU frequency while the bot is standing still,
+ * and switches back to full power as soon as a move starts.
+ * While the bot follows a mothership the radio has to keep listening: asleep it would hear only about a quarter of the
+ * beat beacons and commands (IDLE_WAKE_WINDOW_MS of IDLE_WAKE_INTERVAL_MS), and its acks would come up to 75 ms late,
+ * after ReliableSender has resent. Then only the CPU slows down (POWER_IDLE_LISTEN).
+*/
+
+#ifndef POWERCONTROLLER
+#define POWERCONTROLLER
+
+#include <stdint.h>
+
+//battery sampler timing
+#define BATTERY_TICK_MS 20          //time between ADC samples
+#define BATTERY_MEDIAN_SIZE 5       //samples per reading, one tick apart so a short current spike only lands on one of them
+#define BATTERY_WINDOW_TICKS 25     //one reading every 25 ticks (500 ms), the divider is only on while sampling
+#define BATTERY_EMA_SHIFT 2         //each new reading moves the filtered value 1/4 of the way
+
+//state of charge model
+#define BATTERY_RESISTANCE_MOHM 200 //internal resistance of the pack plus wiring, measure the drop at a known load to tune it
+#define BOARD_CURRENT_MA 80         //ESP32 average current, added to the servo load
+
+//idle power manager, see loopPowerSave()
+#define IDLE_DELAY_MS 2000          //how long the bot has to stand still before it saves power
+#define IDLE_CPU_MHZ 80             //WiFi needs at least 80 MHz, the servo PWM clock doesn't change at 80 MHz and up
+#define ACTIVE_CPU_MHZ 240
+//while idle without a mothership the radio only listens for ESP-NOW for IDLE_WAKE_WINDOW_MS of every IDLE_WAKE_INTERVAL_MS
+//a message from the mothership waits at most about IDLE_WAKE_INTERVAL_MS - IDLE_WAKE_WINDOW_MS,
+//a longer interval or shorter window saves more power but wakes slower
+#define IDLE_WAKE_INTERVAL_MS 100
+#define IDLE_WAKE_WINDOW_MS 25
+#define POWER_LOG_INTERVAL_MS 60000 //how often loopPowerSave prints the time spent in each power state
+
+//power states
+enum{
+  POWER_ACTIVE,
+  POWER_IDLE,
+  POWER_IDLE_LISTEN,      //idle with the radio listening, only the CPU slows down
+  NUM_POWER_STATES
+};
+
+class PowerController {
+public:
+    PowerController(void);
+    //when ESP32 turns on, latch the power to continue being on (refer to sch)
+    void powerOnSystem(void);
+
+    void startWiFiPowerSave(void);
+    void endWiFiPowerSave(void);
+
+    //set up the battery level checker and start sampling it in the background
+    void batteryADCInit(void);
+    //filtered battery % between 0 - 100, 100 until the first reading
+    float getBatteryPercentage(void);
+    //filtered battery voltage without load (mV), -1 until the first reading
+    int getBatteryMillivolts(void);
+    //servo current (mA) while the next samples are taken, from DancingServos::getLoadCurrent()
+    void setLoadCurrent(int mA);
+    //number of battery readings taken
+    uint32_t getBatteryReadings(void);
+
+    //called by the battery timer every BATTERY_TICK_MS
+    void sampleBattery(void);
+
+    //idle power manager, call each loop()
+    //idle = no move running and the move queue is empty
+    //listen = the mothership is sending beacons and commands, the radio can't sleep
+    void loopPowerSave(bool idle, bool listen);
+    int getPowerState(void);
+    unsigned long getPowerStateMillis(int state);    //total time spent in a power state (ms)
+
+private:
+    friend bool batterySagTest(void);
+//the state of charge along a whole discharge with the servos dancing on and off, with and without load correction
+bool batteryTraceTest(void);
+    friend bool batteryTraceTest(void);
+    int (*readAdc)(void);                   //the battery divider's ADC reading, the tests replace it
+
+    //0 - 100 %, written by the battery timer
+    volatile int batteryPercentage;
+    volatile int loadCurrent;               //mA
+
+    //battery sampler
+    int batteryTick;
+    int batterySamples[BATTERY_MEDIAN_SIZE];   //load corrected voltage (mV)
+    volatile int32_t batteryFilterMv;       //EMA of the median readings, mV * 256, -1 = no reading yet
+    volatile uint32_t batteryReadings;
+
+    //idle power manager
+    void setPowerState(int state, unsigned long t);
+    int powerState;
+    unsigned long idleSince;            //ms
+    unsigned long stateStart;           //ms
+    unsigned long stateMillis[NUM_POWER_STATES];
+    unsigned long lastPowerLog;         //ms
+};
+
+//the battery level under synthetic voltage sag (servo start spikes and load), on a virtual ADC
+bool batterySagTest(void);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,332 @@
+/* ReliableLink.cpp
+ * UT Austin RAS Demobots
+ * Acknowledged delivery for mothership commands, see ReliableLink.h
+ */
+
+#include <Arduino.h>
+#include <string.h>
+#include "ReliableLink.h"
+#include "DancingServos.h"
+
+//seqs wrap around, a is newer than b if it is less than half the range ahead
+static bool seqNewer(uint16_t a, uint16_t b) {
+  return (int16_t)(a - b) > 0;
+}
+
+bool isSafetyCommand(const struct_message* message) {
+  return (message->status == None || message->status == QueueMove) &&
+         (message->danceMove == STOP || message->danceMove == RESET);
+}
+
+
+//RELIABLE SENDER (mothership)
+
+ReliableSender::ReliableSender(ReliableSendFunction send) {
+  this->send = send;
+  for (int i = 0; i < RELIABLE_TABLE_SIZE; i++) {
+    table[i].used = false;
+  }
+  seq = 0;
+  resends = 0;
+  failures = 0;
+}
+
+uint16_t ReliableSender::nextSeq() {
+  seq++;
+  if (seq == 0) {seq = 1;}
+  return seq;
+}
+
+bool ReliableSender::track(int id, const struct_message* message, unsigned long t) {
+  bool safety = isSafetyCommand(message);
+  PendingMessage* slot = NULL;
+
+  for (int i = 0; i < RELIABLE_TABLE_SIZE; i++) {
+    PendingMessage* pending = &table[i];
+    //a safety command replaces the commands still waiting for this bot
+    if (pending->used && safety && pending->id == id) {
+      pending->used = false;
+    }
+    if (!pending->used && slot == NULL) {
+      slot = pending;
+    }
+  }
+
+  //table full: a safety command takes the slot of a command that isn't one
+  if (slot == NULL && safety) {
+    for (int i = 0; i < RELIABLE_TABLE_SIZE && slot == NULL; i++) {
+      if (!isSafetyCommand(&table[i].message)) {
+        slot = &table[i];
+        failures++;
+      }
+    }
+  }
+  if (slot == NULL) {
+    return false;
+  }
+
+  slot->acked = false;
+  slot->id = id;
+  slot->tries = 1;
+  slot->nextTry = t + (safety ? RELIABLE_SAFETY_TIMEOUT_MS : RELIABLE_TIMEOUT_MS);
+  memcpy(&slot->message, message, sizeof(struct_message));
+  slot->used = true;
+  return true;
+}
+
+void ReliableSender::ack(int id, uint16_t seq) {
+  for (int i = 0; i < RELIABLE_TABLE_SIZE; i++) {
+    if (table[i].used && table[i].id == id && table[i].message.seq == seq) {
+      table[i].acked = true;
+    }
+  }
+}
+
+void ReliableSender::loop(unsigned long t) {
+  //safety commands first
+  for (int pass = 0; pass < 2; pass++) {
+    for (int i = 0; i < RELIABLE_TABLE_SIZE; i++) {
+      PendingMessage* pending = &table[i];
+      if (!pending->used || isSafetyCommand(&pending->message) != (pass == 0)) {
+        continue;
+      }
+      if (pending->acked) {
+        pending->used = false;
+      }
+      else if ((long)(t - pending->nextTry) >= 0) {
+        resend(pending, t);
+      }
+    }
+  }
+}
+
+void ReliableSender::resend(PendingMessage* pending, unsigned long t) {
+  if (pending->tries >= RELIABLE_MAX_TRIES) {
+    pending->used = false;
+    failures++;
+    return;
+  }
+  send(pending->id, &pending->message);
+  resends++;
+
+  unsigned long timeout = isSafetyCommand(&pending->message) ? RELIABLE_SAFETY_TIMEOUT_MS : RELIABLE_TIMEOUT_MS;
+  pending->nextTry = t + (timeout << pending->tries);
+  pending->tries++;
+}
+
+void ReliableSender::dropBot(int id) {
+  for (int i = 0; i < RELIABLE_TABLE_SIZE; i++) {
+    if (table[i].id == id) {
+      table[i].used = false;
+    }
+  }
+}
+
+int ReliableSender::getPending() {
+  int count = 0;
+  for (int i = 0; i < RELIABLE_TABLE_SIZE; i++) {
+    if (table[i].used) {count++;}
+  }
+  return count;
+}
+
+unsigned long ReliableSender::getResends() {
+  return resends;
+}
+
+unsigned long ReliableSender::getFailures() {
+  return failures;
+}
+
+
+//DUPLICATE FILTER (bot)
+
+DuplicateFilter::DuplicateFilter() {
+  reset();
+}
+
+void DuplicateFilter::reset() {
+  started = false;
+  lastSeq = 0;
+  seen = 0;
+  safetySeq = 0;
+  safetySeen = false;
+}
+
+bool DuplicateFilter::accept(const struct_message* message) {
+  uint16_t seq = message->seq;
+  if (seq == 0) {
+    return true;
+  }
+
+  if (!started) {
+    started = true;
+    lastSeq = seq;
+    seen = 1;
+  }
+  else if (seqNewer(seq, lastSeq)) {
+    uint16_t ahead = seq - lastSeq;
+    seen = ahead >= DUPLICATE_WINDOW ? 0 : seen << ahead;
+    seen |= 1;
+    lastSeq = seq;
+  }
+  else {
+    uint16_t behind = lastSeq - seq;
+    //too old to tell if it is a duplicate, or already seen
+    if (behind >= DUPLICATE_WINDOW || (seen & (1u << behind))) {
+      return false;
+    }
+    seen |= 1u << behind;
+  }
+
+  //a command sent before the last STOP/RESET would undo it
+  if (isSafetyCommand(message)) {
+    safetySeq = seq;
+    safetySeen = true;
+  }
+  else if (safetySeen && seqNewer(safetySeq, seq)) {
+    return false;
+  }
+  return true;
+}
+
+
+
+/* Test
+ * a ReliableSender and TEST_LINK_BOTS bots with DuplicateFilters on a virtual clock, a command for every bot each
+ * TEST_LINK_PERIOD_MS, over a radio that loses commands and acks alike, with some latency
+ * measures how long each command took to reach each bot (the first copy the bot accepted) at each loss
+ */
+
+#define TEST_LINK_BOTS 20
+#define TEST_LINK_COMMANDS 200
+#define TEST_LINK_PERIOD_MS 250
+#define TEST_LINK_LATENCY_MS 2        //plus up to one more
+#define TEST_LINK_MAX_AIR 256
+#define TEST_LINK_MAX_MS 1024         //latency histogram
+
+//a message in the air, a command to a bot or its ack
+typedef struct LinkTestPacket {
+  int id;
+  bool ack;
+  unsigned long arrives;
+  struct_message message;
+} LinkTestPacket;
+
+static LinkTestPacket linkTestAir[TEST_LINK_MAX_AIR];
+static int linkTestInAir = 0;
+static unsigned long linkTestTime = 0;
+static int linkTestLoss = 0;
+static uint32_t linkTestRandom = 1;
+
+static uint32_t linkTestNext() {
+  linkTestRandom = linkTestRandom * 1103515245 + 12345;
+  return linkTestRandom >> 8;
+}
+
+static void linkTestSend(int id, bool ack, const struct_message* message) {
+  if ((int) (linkTestNext() % 100) < linkTestLoss || linkTestInAir == TEST_LINK_MAX_AIR) {
+    return;
+  }
+  LinkTestPacket* packet = &linkTestAir[linkTestInAir++];
+  packet->id = id;
+  packet->ack = ack;
+  packet->arrives = linkTestTime + TEST_LINK_LATENCY_MS + linkTestNext() % 2;
+  memcpy(&packet->message, message, sizeof(struct_message));
+}
+
+static bool linkTestResend(int id, struct_message* message) {
+  linkTestSend(id, false, message);
+  return true;
+}
+
+//percentile (ms) from the latency histogram
+static int linkTestPercentile(const long* histogram, long count, int percent) {
+  long seen = 0;
+  for (int ms = 0; ms < TEST_LINK_MAX_MS; ms++) {
+    seen += histogram[ms];
+    if (seen * 100 >= count * percent) {return ms;}
+  }
+  return TEST_LINK_MAX_MS;
+}
+
+bool reliableLinkTest() {
+  bool passed = true;
+  static long histogram[TEST_LINK_MAX_MS];
+  static unsigned long sentAt[TEST_LINK_COMMANDS];
+  static bool delivered[TEST_LINK_BOTS][TEST_LINK_COMMANDS];
+  for (linkTestLoss = 0; linkTestLoss <= 30; linkTestLoss += 10) {
+    ReliableSender sender(linkTestResend);
+    DuplicateFilter filters[TEST_LINK_BOTS];
+    memset(histogram, 0, sizeof(histogram));
+    memset(delivered, 0, sizeof(delivered));
+    linkTestInAir = 0;
+    long count = 0;
+    long duplicates = 0;
+    uint16_t firstSeq = 0;
+
+    int commands = 0;
+    for (linkTestTime = 0; commands < TEST_LINK_COMMANDS || sender.getPending() > 0 || linkTestInAir > 0; linkTestTime++) {
+      //a new command for every bot, like transmitToDancebots()
+      if (commands < TEST_LINK_COMMANDS && linkTestTime == (unsigned long) commands * TEST_LINK_PERIOD_MS) {
+        struct_message command;
+        memset(&command, 0, sizeof(command));
+        command.danceMove = WALK;
+        command.seq = sender.nextSeq();
+        if (commands == 0) {firstSeq = command.seq;}
+        sentAt[commands++] = linkTestTime;
+        for (int id = 0; id < TEST_LINK_BOTS; id++) {
+          if (!sender.track(id, &command, linkTestTime)) {passed = false;}
+          linkTestSend(id, false, &command);
+        }
+      }
+
+      //packets that arrive now, commands are acked every time like BotController does
+      for (int i = 0; i < linkTestInAir; i++) {
+        LinkTestPacket* packet = &linkTestAir[i];
+        if (packet->arrives != linkTestTime) {
+          continue;
+        }
+        LinkTestPacket arrived = *packet;
+        *packet = linkTestAir[--linkTestInAir];
+        i--;
+        if (arrived.ack) {
+          sender.ack(arrived.id, arrived.message.seq);
+          continue;
+        }
+        int command = (uint16_t) (arrived.message.seq - firstSeq);
+        if (filters[arrived.id].accept(&arrived.message)) {
+          if (delivered[arrived.id][command]) {passed = false;}
+          delivered[arrived.id][command] = true;
+          long latency = linkTestTime - sentAt[command];
+          histogram[latency < TEST_LINK_MAX_MS ? latency : TEST_LINK_MAX_MS - 1]++;
+          count++;
+        }
+        else {
+          duplicates++;
+        }
+        struct_message ack;
+        memset(&ack, 0, sizeof(ack));
+        ack.status = Ack;
+        ack.id = arrived.id;
+        ack.seq = arrived.message.seq;
+        linkTestSend(arrived.id, true, &ack);
+      }
+      sender.loop(linkTestTime);
+    }
+
+    //with RELIABLE_MAX_TRIES sends about 1 in a million commands is lost at 10 % loss, about 1 in a 1000 at 30 %
+    long total = (long) TEST_LINK_BOTS * TEST_LINK_COMMANDS;
+    int p50 = linkTestPercentile(histogram, count, 50);
+    int p90 = linkTestPercentile(histogram, count, 90);
+    int p99 = linkTestPercentile(histogram, count, 99);
+    if (count < total - total / 200 || (linkTestLoss == 0 && (count != total || p99 > TEST_LINK_LATENCY_MS + 1))) {passed = false;}
+    //99 % of the commands get there by the fifth send, RELIABLE_TIMEOUT_MS * (1 + 2 + 4 + 8) after the first
+    if (p99 > 15 * RELIABLE_TIMEOUT_MS + TEST_LINK_LATENCY_MS + 1) {passed = false;}
+    Serial.println("loss " + String(linkTestLoss) + "%: delivered " + String(count) + " of " + String(total) + ", latency p50 " +
+                   String(p50) + " ms, p90 " + String(p90) + " ms, p99 " + String(p99) + " ms, " + String(sender.getResends()) +
+                   " resends, " + String(duplicates) + " duplicates dropped");
+  }
+  Serial.println(passed ? "reliable link test PASSED" : "reliable link test FAILED");
+  return passed;
+}
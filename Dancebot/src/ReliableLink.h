@@ -0,0 +1,90 @@
+/* ReliableLink.h
+ * UT Austin RAS Demobots
+ * Acknowledged delivery for messages from the mothership to the dancebots
+ *
+ * The mothership numbers each command it sends (seq), every bot that gets one answers with status Ack.
+ * ReliableSender (mothership) keeps each command until the bot acknowledges it, and sends it again with exponential backoff:
+ * after RELIABLE_TIMEOUT_MS, then twice that, ... up to RELIABLE_MAX_TRIES sends.
+ * DuplicateFilter (bot) drops commands it already got, since a lost ack means the same command arrives twice.
+ *
+ * STOP and RESET are safety commands: they are sent again sooner, they replace the commands still waiting for the same bot,
+ * and the bot ignores any older command that shows up after one.
+ *
+ * Everything is in fixed size tables, nothing is allocated. Nothing is locked either, ReliableSender is only used from loop().
+ */
+
+#ifndef RELIABLELINK
+#define RELIABLELINK
+
+#include <stdint.h>
+#include "Messages.h"
+
+#define RELIABLE_TABLE_SIZE 64        //commands waiting for an ack, for all bots
+#define RELIABLE_TIMEOUT_MS 30        //first resend, doubles each time
+#define RELIABLE_SAFETY_TIMEOUT_MS 10 //first resend of STOP/RESET
+#define RELIABLE_MAX_TRIES 6          //sends before giving up on a bot
+#define DUPLICATE_WINDOW 32           //how many recent seqs a bot remembers
+
+//STOP and RESET
+bool isSafetyCommand(const struct_message* message);
+
+//send a message to one bot, true if it was sent
+typedef bool (*ReliableSendFunction)(int id, struct_message* message);
+
+typedef struct PendingMessage {
+  bool used;
+  bool acked;                   //freed on the next loop()
+  int id;                       //bot
+  uint8_t tries;
+  unsigned long nextTry;        //ms
+  struct_message message;
+} PendingMessage;
+
+class ReliableSender {
+public:
+  ReliableSender(ReliableSendFunction send);
+
+  uint16_t nextSeq();           //seq for a new command, never 0 (0 = no ack wanted)
+
+  //keep a command that was just sent to bot id until it is acknowledged, false if it can't be kept
+  bool track(int id, const struct_message* message, unsigned long t);
+  //a bot acknowledged seq, call from the same task as the others, the receive callback queues acks for it
+  void ack(int id, uint16_t seq);
+  //call each loop(), resends commands that timed out, safety commands first
+  void loop(unsigned long t);
+  //forget the commands for a bot that left
+  void dropBot(int id);
+
+  int getPending();
+  unsigned long getResends();
+  unsigned long getFailures();  //commands a bot never acknowledged
+
+private:
+  void resend(PendingMessage* pending, unsigned long t);
+
+  ReliableSendFunction send;
+  PendingMessage table[RELIABLE_TABLE_SIZE];
+  uint16_t seq;
+  unsigned long resends;
+  unsigned long failures;
+};
+
+class DuplicateFilter {
+public:
+  DuplicateFilter();
+  //true if a command should be run, false if it is a duplicate or older than the last safety command
+  bool accept(const struct_message* message);
+  void reset();                 //new mothership, forget its seqs
+
+private:
+  bool started;
+  uint16_t lastSeq;             //newest seq seen
+  uint32_t seen;                //bit i = lastSeq - i was seen
+  uint16_t safetySeq;           //seq of the last safety command
+  bool safetySeen;
+};
+
+//delivery latency percentiles over a radio with 0 to 30 % loss, on a virtual clock
+bool reliableLinkTest();
+
+#endif
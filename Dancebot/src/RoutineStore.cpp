@@ -0,0 +1,425 @@
+/* RoutineStore.cpp
+ * UT Austin RAS Demobots
+ * Routine binary format and flash storage, see RoutineStore.h
+ *
+ * Writing a routine to a slot:
+ *    erase the sector, write the slot header without its magic, write the routine, then write the magic
+ *    a routine is only valid once its magic is written, so a reset in the middle leaves a free slot
+ * Replacing or deleting a routine clears the old slot's magic (no erase needed), after the bot stopped playing from it
+ */
+
+#include <Arduino.h>
+#include <string.h>
+#include "RoutineStore.h"
+
+#ifdef ESP_PLATFORM
+#include <esp_partition.h>
+static const esp_partition_t* partition = NULL;
+static spi_flash_mmap_handle_t mapHandle;
+#else
+//host stand-in for the "routines" partition, it keeps its contents between RoutineStore objects like flash would
+static uint8_t flashSim[ROUTINE_NUM_SLOTS * ROUTINE_SLOT_SIZE];
+static bool flashSimErased = false;
+#endif
+
+
+//ROUTINE FORMAT
+
+//standard crc32 (same as zlib), pass the previous crc to continue a calculation
+uint32_t routineCrc32(const uint8_t* data, size_t len, uint32_t crc) {
+  crc = ~crc;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= data[i];
+    for (int b = 0; b < 8; b++) {
+      crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    }
+  }
+  return ~crc;
+}
+
+bool checkRoutine(const uint8_t* routine, size_t len) {
+  RoutineHeader header;
+  if (len < sizeof(RoutineHeader)) {return false;}
+  memcpy(&header, routine, sizeof(RoutineHeader));
+
+  if (header.magic != ROUTINE_MAGIC || header.version != ROUTINE_VERSION) {return false;}
+  if (header.numSteps == 0 || header.numSteps > ROUTINE_MAX_STEPS) {return false;}
+  if (len != sizeof(RoutineHeader) + header.numSteps * sizeof(DanceStep)) {return false;}
+  if (memchr(header.name, 0, ROUTINE_NAME_LEN) == NULL || header.name[0] == 0) {return false;}
+
+  if (routineCrc32(routine + sizeof(RoutineHeader), header.numSteps * sizeof(DanceStep)) != header.crc) {return false;}
+
+  //a routine is stored and played again at every boot, so a bad step would stop the bot each time
+  for (int i = 0; i < header.numSteps; i++) {
+    DanceStep step;
+    memcpy(&step, routine + sizeof(RoutineHeader) + i * sizeof(DanceStep), sizeof(DanceStep));
+    if (!checkDanceStep(&step)) {return false;}
+  }
+  return true;
+}
+
+bool checkDanceStep(const DanceStep* step) {
+  //dance routines (DEMO1 on) can't be steps, see startDanceMove()
+  if (step->move < STOP || step->move > WAVE) {return false;}
+  if (!(step->cycles > 0 && step->cycles <= ROUTINE_MAX_CYCLES)) {return false;}    //also NaN
+  switch (step->move) {
+    case WALK:
+    case BWALK:   return step->arg >= MIN_MOVE_PERIOD && step->arg <= MAX_MOVE_PERIOD;
+    case HOP:
+    case WIGGLE:
+    case WAVE:    return abs(step->arg) <= MAX_MOVE_ANGLE;
+  }
+  return true;
+}
+
+size_t buildRoutine(uint8_t* buffer, const char* name, const DanceStep* steps, int numSteps) {
+  if (numSteps <= 0 || numSteps > ROUTINE_MAX_STEPS || strlen(name) == 0 || strlen(name) >= ROUTINE_NAME_LEN) {
+    return 0;
+  }
+  RoutineHeader header;
+  memset(&header, 0, sizeof(RoutineHeader));
+  header.magic = ROUTINE_MAGIC;
+  header.version = ROUTINE_VERSION;
+  header.numSteps = numSteps;
+  header.crc = routineCrc32((const uint8_t*)steps, numSteps * sizeof(DanceStep));
+  strcpy(header.name, name);
+
+  memcpy(buffer, &header, sizeof(RoutineHeader));
+  memcpy(buffer + sizeof(RoutineHeader), steps, numSteps * sizeof(DanceStep));
+  return sizeof(RoutineHeader) + numSteps * sizeof(DanceStep);
+}
+
+const DanceStep* getRoutineSteps(const RoutineHeader* routine) {
+  return (const DanceStep*)(routine + 1);
+}
+
+
+
+//SETUP FUNCTIONS
+
+RoutineStore::RoutineStore() {
+  mapped = NULL;
+  nextSequence = 1;
+  lastWriteMicros = 0;
+}
+
+bool RoutineStore::begin() {
+#ifdef ESP_PLATFORM
+  partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, (esp_partition_subtype_t)ROUTINE_PARTITION_SUBTYPE, "routines");
+  if (partition == NULL || partition->size < ROUTINE_NUM_SLOTS * ROUTINE_SLOT_SIZE) {
+    Serial.println("Routine partition not found, check partitions.csv");
+    return false;
+  }
+  const void* ptr;
+  if (esp_partition_mmap(partition, 0, ROUTINE_NUM_SLOTS * ROUTINE_SLOT_SIZE, ESP_PARTITION_MMAP_DATA, &ptr, &mapHandle) != ESP_OK) {
+    Serial.println("Failed to map the routine partition");
+    return false;
+  }
+  mapped = (const uint8_t*)ptr;
+#else
+  if (!flashSimErased) {
+    memset(flashSim, 0xFF, sizeof(flashSim));
+    flashSimErased = true;
+  }
+  mapped = flashSim;
+#endif
+
+  //continue the upload order after the newest stored routine
+  for (int i = 0; i < ROUTINE_NUM_SLOTS; i++) {
+    if (getRoutine(i) != NULL && getSlot(i)->sequence >= nextSequence) {
+      nextSequence = getSlot(i)->sequence + 1;
+    }
+  }
+  return true;
+}
+
+
+
+//STORE FUNCTIONS
+
+const RoutineHeader* RoutineStore::storeRoutine(const uint8_t* routine, size_t len, DancingServos* bot) {
+  if (mapped == NULL || !checkRoutine(routine, len)) {
+    return NULL;
+  }
+  RoutineHeader header;
+  memcpy(&header, routine, sizeof(RoutineHeader));
+
+  //the old copy isn't overwritten in place, the bot may be playing it straight from flash
+  int oldSlot = findSlot(header.name);
+  int slot = pickFreeSlot();
+  if (slot == -1) {return NULL;}
+  //a routine the bot has no room for could never be played, don't store it
+  if (bot->findDanceRoutine(header.name) == -1 && bot->getNumDanceRoutines() >= MAX_DANCE_ROUTINES) {return NULL;}
+
+  unsigned long t0 = micros();
+
+  RoutineSlot slotHeader;
+  slotHeader.magic = 0xFFFFFFFF;
+  slotHeader.eraseCount = getEraseCount(slot) + 1;
+  slotHeader.sequence = nextSequence;
+  slotHeader.length = len;
+
+  size_t offset = slot * ROUTINE_SLOT_SIZE;
+  uint32_t magic = ROUTINE_SLOT_VALID;
+  if (!eraseSlot(slot) ||
+      !writeFlash(offset, &slotHeader, sizeof(RoutineSlot)) ||
+      !writeFlash(offset + sizeof(RoutineSlot), routine, len) ||
+      !writeFlash(offset, &magic, sizeof(magic))) {
+    return NULL;
+  }
+  nextSequence++;
+
+  //the bot plays the new copy before the old slot is deleted, a deleted slot can be erased by the next upload
+  const RoutineHeader* stored = getRoutine(slot);
+  uint32_t deleted = ROUTINE_SLOT_DELETED;
+  if (bot->addDanceRoutine(stored->name, getRoutineSteps(stored), stored->numSteps) == -1) {
+    writeFlash(offset, &deleted, sizeof(deleted));
+    return NULL;
+  }
+  if (oldSlot != -1) {
+    writeFlash(oldSlot * ROUTINE_SLOT_SIZE, &deleted, sizeof(deleted));
+  }
+
+  lastWriteMicros = micros() - t0;
+  return stored;
+}
+
+bool RoutineStore::deleteRoutine(const char* name, DancingServos* bot) {
+  int slot = findSlot(name);
+  if (slot == -1) {
+    return false;
+  }
+  bot->removeDanceRoutine(name);
+  uint32_t deleted = ROUTINE_SLOT_DELETED;
+  return writeFlash(slot * ROUTINE_SLOT_SIZE, &deleted, sizeof(deleted));
+}
+
+
+
+//READ FUNCTIONS
+
+const RoutineHeader* RoutineStore::getRoutine(int slot) {
+  if (mapped == NULL || slot < 0 || slot >= ROUTINE_NUM_SLOTS || getSlot(slot)->magic != ROUTINE_SLOT_VALID) {
+    return NULL;
+  }
+  return (const RoutineHeader*)(getSlot(slot) + 1);
+}
+
+const RoutineHeader* RoutineStore::findRoutine(const char* name) {
+  return getRoutine(findSlot(name));
+}
+
+int RoutineStore::getNumRoutines() {
+  int n = 0;
+  for (int i = 0; i < ROUTINE_NUM_SLOTS; i++) {
+    if (getRoutine(i) != NULL) {n++;}
+  }
+  return n;
+}
+
+int RoutineStore::loadRoutines(DancingServos* bot) {
+  int loaded = 0;
+  uint32_t lastSequence = 0;
+
+  //add in upload order so every bot that got the same uploads has the same routine table
+  while (true) {
+    int next = -1;
+    for (int i = 0; i < ROUTINE_NUM_SLOTS; i++) {
+      if (getRoutine(i) != NULL && getSlot(i)->sequence > lastSequence &&
+          (next == -1 || getSlot(i)->sequence < getSlot(next)->sequence)) {
+        next = i;
+      }
+    }
+    if (next == -1) {
+      break;
+    }
+
+    //routines stored before the steps were checked are left out
+    const RoutineHeader* routine = getRoutine(next);
+    if (checkRoutine((const uint8_t*) routine, getSlot(next)->length) &&
+        bot->addDanceRoutine(routine->name, getRoutineSteps(routine), routine->numSteps) != -1) {
+      loaded++;
+    }
+    lastSequence = getSlot(next)->sequence;
+  }
+  return loaded;
+}
+
+
+
+//FLASH FUNCTIONS
+
+uint32_t RoutineStore::getEraseCount(int slot) {
+  uint32_t count = getSlot(slot)->eraseCount;
+  if (count == 0xFFFFFFFF) {count = 0;}    //never written
+  return count;
+}
+
+unsigned long RoutineStore::getLastWriteMicros() {
+  return lastWriteMicros;
+}
+
+const RoutineSlot* RoutineStore::getSlot(int slot) {
+  return (const RoutineSlot*)(mapped + slot * ROUTINE_SLOT_SIZE);
+}
+
+int RoutineStore::findSlot(const char* name) {
+  for (int i = 0; i < ROUTINE_NUM_SLOTS; i++) {
+    const RoutineHeader* routine = getRoutine(i);
+    if (routine != NULL && strncmp(routine->name, name, ROUTINE_NAME_LEN) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+int RoutineStore::pickFreeSlot() {
+  int best = -1;
+  for (int i = 0; i < ROUTINE_NUM_SLOTS; i++) {
+    if (getSlot(i)->magic != ROUTINE_SLOT_VALID && (best == -1 || getEraseCount(i) < getEraseCount(best))) {
+      best = i;
+    }
+  }
+  return best;
+}
+
+bool RoutineStore::eraseSlot(int slot) {
+#ifdef ESP_PLATFORM
+  return esp_partition_erase_range(partition, slot * ROUTINE_SLOT_SIZE, ROUTINE_SLOT_SIZE) == ESP_OK;
+#else
+  memset(flashSim + slot * ROUTINE_SLOT_SIZE, 0xFF, ROUTINE_SLOT_SIZE);
+  return true;
+#endif
+}
+
+bool RoutineStore::writeFlash(size_t offset, const void* data, size_t len) {
+#ifdef ESP_PLATFORM
+  return esp_partition_write(partition, offset, data, len) == ESP_OK;
+#else
+  //like NOR flash, a write can only clear bits
+  for (size_t i = 0; i < len; i++) {
+    flashSim[offset + i] &= ((const uint8_t*)data)[i];
+  }
+  return true;
+#endif
+}
+
+
+
+//TEST FUNCTIONS
+
+#define TEST_WEAR_ROUNDS 10   //uploads of one routine per slot
+
+//delete every stored routine, the erase counts stay
+static void testDeleteAll(RoutineStore* store, DancingServos* bot) {
+  char name[ROUTINE_NAME_LEN];
+  for (int i = 0; i < ROUTINE_NUM_SLOTS; i++) {
+    if (store->getRoutine(i) != NULL) {
+      strcpy(name, store->getRoutine(i)->name);
+      store->deleteRoutine(name, bot);
+    }
+  }
+}
+
+bool routineStoreTest(DancingServos* bot) {
+  RoutineStore store;
+  if (!store.begin()) {
+    Serial.println("routine store test FAILED");
+    return false;
+  }
+  bool passed = true;
+  testDeleteAll(&store, bot);
+  int builtin = bot->getNumDanceRoutines();
+
+  DanceStep steps[ROUTINE_MAX_STEPS];
+  for (int i = 0; i < ROUTINE_MAX_STEPS; i++) {
+    steps[i].move = WALK;
+    steps[i].arg = MIN_MOVE_PERIOD + i;
+    steps[i].cycles = 1;
+  }
+  static uint8_t routine[ROUTINE_MAX_SIZE];
+  char name[ROUTINE_NAME_LEN];
+  size_t len;
+
+  //a step the bot can't play is turned away: a period of 0, a move that doesn't exist, cycles that aren't a number
+  DanceStep bad[3] = {{WALK, 0, 1}, {WAVE + 1, 0, 1}, {HOP, 30, NAN}};
+  for (int i = 0; i < 3; i++) {
+    len = buildRoutine(routine, "Test bad", &bad[i], 1);
+    if (checkRoutine(routine, len) || store.storeRoutine(routine, len, bot) != NULL) {passed = false;}
+  }
+
+  //routines go in until the bot's routine table is full, one that doesn't fit isn't stored
+  int room = MAX_DANCE_ROUTINES - builtin;
+  int fits = room < ROUTINE_NUM_SLOTS ? room : ROUTINE_NUM_SLOTS;
+  for (int i = 0; i <= fits && i < ROUTINE_NUM_SLOTS; i++) {
+    snprintf(name, sizeof(name), "Test %d", i);
+    len = buildRoutine(routine, name, steps, i + 1);
+    const RoutineHeader* stored = store.storeRoutine(routine, len, bot);
+    if (i < fits && (stored == NULL || memcmp(stored, routine, len) != 0)) {passed = false;}
+    if (i == fits && (stored != NULL || bot->findDanceRoutine(name) != -1)) {passed = false;}
+  }
+  if (store.getNumRoutines() != fits) {passed = false;}
+
+  //every slot holds a routine, read back as it was written
+  //the bot's table is emptied of them first, they stay in flash
+  for (int i = 0; i < ROUTINE_NUM_SLOTS; i++) {
+    snprintf(name, sizeof(name), "Test %d", i);
+    bot->removeDanceRoutine(name);
+  }
+  for (int i = fits; i < ROUTINE_NUM_SLOTS; i++) {
+    snprintf(name, sizeof(name), "Test %d", i);
+    len = buildRoutine(routine, name, steps, i + 1);
+    const RoutineHeader* stored = store.storeRoutine(routine, len, bot);
+    if (stored == NULL || memcmp(stored, routine, len) != 0) {passed = false;}
+  }
+  if (store.getNumRoutines() != ROUTINE_NUM_SLOTS) {passed = false;}
+
+  //the partition is full, a new copy of a stored routine is turned away and the bot keeps playing the old one
+  len = buildRoutine(routine, "Test 0", steps + 1, 1);
+  if (store.storeRoutine(routine, len, bot) != NULL || store.findRoutine("Test 0") == NULL ||
+      getRoutineSteps(store.findRoutine("Test 0"))[0].arg != MIN_MOVE_PERIOD) {
+    passed = false;
+  }
+
+  //deleting one frees its slot and takes it out of the bot's routine table
+  if (!store.deleteRoutine("Test 0", bot) || store.findRoutine("Test 0") != NULL || bot->findDanceRoutine("Test 0") != -1) {
+    passed = false;
+  }
+
+  //a new copy goes in the free slot, the old slot is deleted
+  int oldSlot = store.findSlot("Test 1");
+  len = buildRoutine(routine, "Test 1", steps + 1, 1);
+  const RoutineHeader* stored = store.storeRoutine(routine, len, bot);
+  if (stored == NULL || store.findSlot("Test 1") == oldSlot || store.getRoutine(oldSlot) != NULL ||
+      getRoutineSteps(stored)[0].arg != MIN_MOVE_PERIOD + 1) {
+    passed = false;
+  }
+
+  //as at boot, every routine is added again until the bot's table is full
+  int loaded = store.loadRoutines(bot);
+  for (int i = 0; i < ROUTINE_NUM_SLOTS; i++) {
+    const RoutineHeader* r = store.getRoutine(i);
+    if (r != NULL && bot->findDanceRoutine(r->name) == -1 && bot->getNumDanceRoutines() < MAX_DANCE_ROUTINES) {passed = false;}
+  }
+
+  //one routine uploaded over and over wears every slot about the same
+  testDeleteAll(&store, bot);
+  len = buildRoutine(routine, "Test wear", steps, ROUTINE_MAX_STEPS);
+  for (int i = 0; i < ROUTINE_NUM_SLOTS * TEST_WEAR_ROUNDS; i++) {
+    if (store.storeRoutine(routine, len, bot) == NULL) {passed = false;}
+  }
+  uint32_t low = store.getEraseCount(0);
+  uint32_t high = low;
+  for (int i = 1; i < ROUTINE_NUM_SLOTS; i++) {
+    if (store.getEraseCount(i) < low) {low = store.getEraseCount(i);}
+    if (store.getEraseCount(i) > high) {high = store.getEraseCount(i);}
+  }
+  if (high - low > 1) {passed = false;}
+  testDeleteAll(&store, bot);
+  if (bot->getNumDanceRoutines() != builtin) {passed = false;}
+
+  //no flash timing, a host build writes to RAM and its clock is virtual, the mothership prints each upload's write time
+  Serial.println("loaded " + String(loaded) + " routines, slots erased " + String(low) + " to " + String(high) + " times");
+  Serial.println(passed ? "routine store test PASSED" : "routine store test FAILED");
+  return passed;
+}
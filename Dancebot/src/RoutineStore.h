@@ -0,0 +1,101 @@
+/* RoutineStore.h
+ * UT Austin RAS Demobots
+ * Flash storage for dance routines uploaded at runtime
+ *
+ * A routine is stored in its binary format: a RoutineHeader followed by numSteps DanceSteps.
+ * Each routine gets its own flash sector ("slot") in the "routines" data partition (see partitions.csv).
+ * The partition is memory mapped, so a stored routine is played straight from flash without copying it to RAM.
+ * A slot the bot may be playing from is never erased: a new copy goes in a free slot, and the bot is moved onto it
+ * before the old one is deleted. When every slot holds a routine, or the bot's routine table (MAX_DANCE_ROUTINES,
+ * built-in routines included) is full, an upload fails until one is deleted.
+ *
+ * Without ESP_PLATFORM (host builds) the partition is a RAM array that behaves like NOR flash
+ * (erase sets a sector to 0xFF, writes can only clear bits), so storage and wear can be checked on a PC.
+ */
+
+#ifndef ROUTINESTORE
+#define ROUTINESTORE
+
+#include <stdint.h>
+#include <stddef.h>
+#include "DancingServos.h"
+
+//routine binary format
+#define ROUTINE_MAGIC 0x5244          //"DR"
+#define ROUTINE_VERSION 1
+#define ROUTINE_NAME_LEN 24           //including the terminating 0
+#define ROUTINE_MAX_STEPS 64
+#define ROUTINE_MAX_CYCLES 1000      //of one step
+#define ROUTINE_MAX_SIZE (sizeof(RoutineHeader) + ROUTINE_MAX_STEPS * sizeof(DanceStep))
+
+//flash layout
+#define ROUTINE_SLOT_SIZE 4096        //one flash sector per routine
+#define ROUTINE_NUM_SLOTS 16          //64 KB "routines" partition
+#define ROUTINE_PARTITION_SUBTYPE 0x40
+
+//header at the start of every routine, steps follow right after it
+typedef struct RoutineHeader {
+  uint16_t magic;                     //ROUTINE_MAGIC
+  uint8_t version;                    //ROUTINE_VERSION
+  uint8_t numSteps;
+  uint32_t crc;                       //crc32 of the steps
+  char name[ROUTINE_NAME_LEN];
+} RoutineHeader;
+
+//header at the start of every flash slot, the routine follows right after it
+typedef struct RoutineSlot {
+  uint32_t magic;                     //ROUTINE_SLOT_VALID, ROUTINE_SLOT_DELETED or 0xFFFFFFFF when erased
+  uint32_t eraseCount;                //how many times this sector has been erased
+  uint32_t sequence;                  //upload order, the newest copy of a routine wins
+  uint32_t length;                    //routine length (bytes)
+} RoutineSlot;
+
+#define ROUTINE_SLOT_VALID 0x544C5352     //"RSLT"
+#define ROUTINE_SLOT_DELETED 0x00000000   //clearing bits doesn't need an erase
+
+uint32_t routineCrc32(const uint8_t* data, size_t len, uint32_t crc = 0);
+bool checkRoutine(const uint8_t* routine, size_t len);    //check magic, version, length, crc and every step
+bool checkDanceStep(const DanceStep* step);               //a move a routine can play, with an arg and cycles in range
+size_t buildRoutine(uint8_t* buffer, const char* name, const DanceStep* steps, int numSteps);   //returns the routine length, 0 on error
+const DanceStep* getRoutineSteps(const RoutineHeader* routine);
+
+class RoutineStore {
+public:
+  RoutineStore();
+  bool begin();                       //find and memory map the partition
+
+  //store a checked routine and add it to the bot's routine table, replaces a stored routine with the same name
+  //returns the stored copy in flash, NULL on error, when every slot holds a routine (delete one first)
+  //or when the bot's routine table is full, a routine the bot can't play isn't stored
+  const RoutineHeader* storeRoutine(const uint8_t* routine, size_t len, DancingServos* bot);
+  bool deleteRoutine(const char* name, DancingServos* bot);     //also takes it out of the bot's routine table
+
+  //zero-copy reads straight from the mapped partition
+  const RoutineHeader* getRoutine(int slot);   //NULL if the slot is empty
+  const RoutineHeader* findRoutine(const char* name);
+  int getNumRoutines();
+
+  //add every stored routine to the bot's routine table, oldest upload first
+  int loadRoutines(DancingServos* bot);
+
+  //flash wear and timing
+  uint32_t getEraseCount(int slot);
+  unsigned long getLastWriteMicros();
+
+private:
+  friend bool routineStoreTest(DancingServos* bot);
+  const RoutineSlot* getSlot(int slot);
+  int findSlot(const char* name);
+  int pickFreeSlot();                 //least worn free slot, so erases are spread over the partition
+  bool eraseSlot(int slot);
+  bool writeFlash(size_t offset, const void* data, size_t len);
+
+  const uint8_t* mapped;              //start of the mapped partition
+  uint32_t nextSequence;
+  unsigned long lastWriteMicros;
+};
+
+//storage and wear spreading, erases every stored routine
+bool routineStoreTest(DancingServos* bot);
+
+#endif
@@ -0,0 +1,119 @@
+//TraceRecorder.cpp
+//UT Austin RAS Demobots
+
+#include <stdio.h>
+#include <string.h>
+#include "TraceRecorder.h"
+
+static const char* traceKinds[NUM_TRACE_KINDS] = {"pos", "wave", "phase", "stop"};
+
+#if TRACE_ENABLED
+TraceRecord traceBuffer[TRACE_SIZE];
+volatile uint32_t traceHead = 0;
+
+void traceClear() {
+  traceHead = 0;
+}
+
+uint32_t traceEnd() {
+  return traceHead;
+}
+
+uint32_t traceStart(uint32_t end) {
+  return end < TRACE_SIZE ? 0 : end - TRACE_SIZE;
+}
+
+int traceCopy(TraceRecord* out, uint32_t* next, uint32_t end, int max) {
+  //skip what the motion task wrote over since the last copy
+  uint32_t from = *next;
+  uint32_t oldest = traceStart(traceHead);
+  if ((int32_t) (oldest - from) > 0) {from = oldest;}
+  int n = 0;
+  while ((int32_t) (end - from) > n && n < max) {
+    out[n] = traceBuffer[(from + n) & (TRACE_SIZE - 1)];
+    n++;
+  }
+  *next = (int32_t) (end - from) > n ? from + n : end;
+
+  //the record at from is written over once traceHead passes from + TRACE_SIZE, leave out any that were while copying
+  __sync_synchronize();     //copied before looking at traceHead again
+  int overwritten = (int32_t) (traceStart(traceHead) - from);
+  if (overwritten <= 0) {return n;}
+  if (overwritten >= n) {return 0;}
+  memmove(out, out + overwritten, (n - overwritten) * sizeof(TraceRecord));
+  return n - overwritten;
+}
+#else
+void traceClear() {}
+uint32_t traceEnd() {return 0;}
+uint32_t traceStart(uint32_t end) {return 0;}
+int traceCopy(TraceRecord* out, uint32_t* next, uint32_t end, int max) {return 0;}
+#endif
+
+int traceFormat(const TraceRecord* r, char* line, int size) {
+  const char* kind = r->kind < NUM_TRACE_KINDS ? traceKinds[r->kind] : "?";
+  int n = snprintf(line, size, "%lu,%u,%s,%d,%d,%d\n", (unsigned long) r->t, r->joint, kind, r->a, r->b, r->c);
+  return n < size ? n : size - 1;
+}
+
+void traceDump(Print* out) {
+  out->print("t_us,joint,kind,a,b,c\n");
+  TraceRecord records[16];
+  char line[64];
+  uint32_t end = traceEnd();
+  uint32_t next = traceStart(end);
+  while (next != end) {   //traceCopy() never moves next past end
+    int n = traceCopy(records, &next, end, 16);
+    for (int j = 0; j < n; j++) {
+      traceFormat(&records[j], line, sizeof(line));
+      out->print(line);
+    }
+  }
+}
+
+/* Test TraceRecorder
+ * A dump that falls behind the motion task while copying loses the records written over, not their order
+ */
+#define TEST_TRACE_RECORDS 3000
+#define TEST_TRACE_LATE 100
+
+bool traceRecorderTest() {
+  if (!TRACE_ENABLED) {
+    Serial.println("trace recorder test PASSED (built with TRACE_ENABLED=0)");
+    return true;
+  }
+  bool passed = true;
+  TraceRecord records[16];
+  traceClear();
+  for (int i = 0; i < TEST_TRACE_RECORDS; i++) {TRACE(TRACE_POS, 0, i, 0, 0);}
+
+  //the newest TRACE_SIZE are kept
+  uint32_t end = traceEnd();
+  uint32_t next = traceStart(end);
+  int n = traceCopy(records, &next, end, 16);
+  if (n != 16 || records[0].a != TEST_TRACE_RECORDS - TRACE_SIZE || records[15].a != TEST_TRACE_RECORDS - TRACE_SIZE + 15) {passed = false;}
+
+  //the motion task writes over the next records before the dump gets to them
+  for (int i = 0; i < TEST_TRACE_LATE; i++) {TRACE(TRACE_POS, 0, -1, 0, 0);}
+  int expected = TEST_TRACE_RECORDS - TRACE_SIZE + TEST_TRACE_LATE;
+  int copied = 16;
+  while (next != end) {
+    n = traceCopy(records, &next, end, 16);
+    for (int j = 0; j < n; j++) {
+      if (records[j].a != expected++) {passed = false;}
+    }
+    copied += n;
+  }
+  //none of the records written since the dump started
+  if (expected != TEST_TRACE_RECORDS || copied != TRACE_SIZE - TEST_TRACE_LATE + 16) {passed = false;}
+
+  //a dump that fell a whole buffer behind stops instead of reading past its end
+  end = traceEnd();
+  next = traceStart(end);
+  for (int i = 0; i < TRACE_SIZE * 2; i++) {TRACE(TRACE_POS, 0, -1, 0, 0);}
+  if (traceCopy(records, &next, end, 16) != 0 || next != end) {passed = false;}
+  traceClear();
+
+  Serial.println(passed ? "trace recorder test PASSED" : "trace recorder test FAILED");
+  return passed;
+}
@@ -0,0 +1,83 @@
+/* TraceRecorder.h
+ * UT Austin RAS Demobots
+ * Records what the servos were commanded in a ring buffer, for checking moves against their sinusoids
+ *
+ * Oscillator::setPos() records every position it writes (TRACE_POS), startO() records the sinusoid
+ * it is about to sample (TRACE_WAVE and TRACE_PHASE) and stopO() records the end of it (TRACE_STOP).
+ * The newest TRACE_SIZE records are kept, about 10 s of dancing with 4 servos at 50 samples/s.
+ *
+ * Dump the trace as CSV with traceDump(), over Serial (send 't') or from the mothership's "/trace" page.
+ * tools/TracePlot.cpp draws it with the ideal sinusoids on a PC.
+ *
+ * Recording is a few stores and a micros() call, build with -D TRACE_ENABLED=0 to compile it out.
+ *
+ * The motion task records on APP_CPU while loop() dumps on PRO_CPU, and a dump over Serial takes
+ * seconds, long enough for the oldest records to be written over. A dump reads up to the head it saw
+ * when it started, and traceCopy() leaves out records that were written over while it copied them,
+ * so a dump can start later than the trace did but never has a record that is half old and half new.
+ */
+
+#ifndef TRACERECORDER
+#define TRACERECORDER
+
+#include <Arduino.h>
+#include <stdint.h>
+
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 1
+#endif
+
+//records kept, must be a power of 2
+#define TRACE_SIZE 2048
+
+//record kinds
+enum {
+  TRACE_POS,      //a = position (degrees, before trim), b = trim
+  TRACE_WAVE,     //a = amplitude, b = offset (degrees, reverse applied), c = period (ms)
+  TRACE_PHASE,    //a = phase of the next sample (tenths of a degree, 0-3599), b = 1 if the wave is a foot turn or lift (see Kinematics.h)
+  TRACE_STOP,     //the oscillator stopped
+  NUM_TRACE_KINDS
+};
+
+//12 bytes
+typedef struct TraceRecord {
+  uint32_t t;     //micros()
+  uint8_t kind;
+  uint8_t joint;  //[hipL, hipR, ankleL, ankleR, hat, extra joints...], see Oscillator::setJoint()
+  int16_t a;
+  int16_t b;
+  int16_t c;
+} TraceRecord;
+
+#if TRACE_ENABLED
+extern TraceRecord traceBuffer[TRACE_SIZE];
+extern volatile uint32_t traceHead;    //records written since traceClear(), the next one goes at traceHead % TRACE_SIZE
+
+inline void traceRecord(uint8_t kind, uint8_t joint, int16_t a, int16_t b, int16_t c) {
+  uint32_t head = traceHead;
+  traceHead = head + 1;
+  __sync_synchronize();     //a reader that copies the old record in this slot sees traceHead move before it changes
+  TraceRecord* r = &traceBuffer[head & (TRACE_SIZE - 1)];
+  r->t = micros();
+  r->kind = kind;
+  r->joint = joint;
+  r->a = a;
+  r->b = b;
+  r->c = c;
+}
+#define TRACE(kind, joint, a, b, c) traceRecord(kind, joint, a, b, c)
+#else
+#define TRACE(kind, joint, a, b, c) do {} while (0)
+#endif
+
+void traceClear();
+uint32_t traceEnd();                                      //traceHead now, a dump reads up to here
+uint32_t traceStart(uint32_t end);                        //the oldest record kept when the head was at end
+int traceCopy(TraceRecord* out, uint32_t* next, uint32_t end, int max);   //copy records oldest first from *next up to end, moves *next past them, returns how many
+int traceFormat(const TraceRecord* r, char* line, int size);   //one CSV line, returns its length
+void traceDump(Print* out);                               //"t_us,joint,kind,a,b,c" CSV, oldest first
+
+//a dump that falls behind the motion task leaves out what was written over
+bool traceRecorderTest();
+
+#endif
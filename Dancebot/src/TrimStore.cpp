@@ -0,0 +1,180 @@
+/* TrimStore.cpp
+ * UT Austin RAS Demobots
+ * Servo trims saved in NVS, see TrimStore.h
+ *
+ * Arduino Preferences library (NVS)
+ * https://github.com/espressif/arduino-esp32/tree/master/libraries/Preferences
+ */
+
+#include <Arduino.h>
+#include <string.h>
+#include "TrimStore.h"
+
+#define TRIM_NAMESPACE "trims"
+
+#ifdef ESP_PLATFORM
+#include <Preferences.h>
+static Preferences prefs;
+#else
+//host stand-in for NVS, one record per MAC key
+#define TRIM_SIM_KEYS 8
+static char simKeys[TRIM_SIM_KEYS][TRIM_KEY_LEN];
+static TrimRecord simRecords[TRIM_SIM_KEYS];
+static int numSimKeys = 0;
+#endif
+
+
+TrimStore::TrimStore() {
+  key[0] = 0;
+  loadMicros = 0;
+}
+
+bool TrimStore::begin(const uint8_t mac[6]) {
+  snprintf(key, sizeof(key), "t%02x%02x%02x%02x%02x%02x", mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+#ifdef ESP_PLATFORM
+  return prefs.begin(TRIM_NAMESPACE, false);
+#else
+  return true;
+#endif
+}
+
+bool TrimStore::loadTrims(int trims[4]) {
+  unsigned long t0 = micros();
+  TrimRecord record;
+  memset(&record, 0, sizeof(TrimRecord));
+  bool found = false;
+
+#ifdef ESP_PLATFORM
+  if (prefs.getBytesLength(key) == sizeof(TrimRecord)) {
+    found = prefs.getBytes(key, &record, sizeof(TrimRecord)) == sizeof(TrimRecord);
+  }
+#else
+  for (int i = 0; i < numSimKeys; i++) {
+    if (strcmp(simKeys[i], key) == 0) {
+      record = simRecords[i];
+      found = true;
+    }
+  }
+#endif
+
+  //records from a newer firmware are ignored instead of guessed at
+  found = found && record.version == TRIM_VERSION;
+  if (found) {
+    for (int i = 0; i < 4; i++) {
+      trims[i] = record.trims[i];
+    }
+  }
+  loadMicros = micros() - t0;
+  return found;
+}
+
+bool TrimStore::saveTrims(const int trims[4]) {
+  TrimRecord record;
+  memset(&record, 0, sizeof(TrimRecord));
+  record.version = TRIM_VERSION;
+  for (int i = 0; i < 4; i++) {
+    record.trims[i] = trims[i];
+  }
+  return putRecord(&record);
+}
+
+bool TrimStore::clearTrims() {
+#ifdef ESP_PLATFORM
+  prefs.remove(key);
+  return true;
+#else
+  for (int i = 0; i < numSimKeys; i++) {
+    if (strcmp(simKeys[i], key) == 0) {
+      numSimKeys--;
+      strcpy(simKeys[i], simKeys[numSimKeys]);
+      simRecords[i] = simRecords[numSimKeys];
+      return true;
+    }
+  }
+  return true;
+#endif
+}
+
+bool TrimStore::putRecord(const TrimRecord* record) {
+#ifdef ESP_PLATFORM
+  return prefs.putBytes(key, record, sizeof(TrimRecord)) == sizeof(TrimRecord);
+#else
+  for (int i = 0; i < numSimKeys; i++) {
+    if (strcmp(simKeys[i], key) == 0) {
+      simRecords[i] = *record;
+      return true;
+    }
+  }
+  if (numSimKeys == TRIM_SIM_KEYS) {
+    return false;
+  }
+  strcpy(simKeys[numSimKeys], key);
+  simRecords[numSimKeys] = *record;
+  numSimKeys++;
+  return true;
+#endif
+}
+
+bool TrimStore::loadOrMigrateTrims(int trims[4], const int defaults[4]) {
+  if (loadTrims(trims)) {
+    return true;
+  }
+  for (int i = 0; i < 4; i++) {
+    trims[i] = defaults[i];
+  }
+  saveTrims(trims);
+  return false;
+}
+
+unsigned long TrimStore::getLoadMicros() {
+  return loadMicros;
+}
+
+
+
+//TEST FUNCTIONS
+
+bool trimStoreTest() {
+  bool passed = true;
+  //locally administered MACs, no real bot has them
+  uint8_t mac[6] = {0x02, 0x00, 0x00, 0x00, 0x7e, 0x57};
+  uint8_t otherMac[6] = {0x02, 0x00, 0x00, 0x00, 0x7e, 0x58};
+  const int defaults[4] = {90, 90, 90, 90};
+  const int saved[4] = {165, -20, 0, 180};
+  int trims[4] = {1, 2, 3, 4};
+  TrimStore store;
+  TrimStore other;
+  if (!store.begin(mac) || !other.begin(otherMac)) {
+    Serial.println("trim store test FAILED");
+    return false;
+  }
+  store.clearTrims();
+  other.clearTrims();
+
+  //nothing saved yet, the trims are left alone, then the defaults are saved on the first boot and loaded on the next
+  if (store.loadTrims(trims) || trims[0] != 1) {passed = false;}
+  if (store.loadOrMigrateTrims(trims, defaults) || memcmp(trims, defaults, sizeof(trims)) != 0) {passed = false;}
+  if (!store.loadOrMigrateTrims(trims, saved) || memcmp(trims, defaults, sizeof(trims)) != 0) {passed = false;}
+
+  //saved trims come back as they were, and only for their own MAC
+  if (!store.saveTrims(saved) || !store.loadTrims(trims) || memcmp(trims, saved, sizeof(trims)) != 0) {passed = false;}
+  if (other.loadTrims(trims)) {passed = false;}
+  if (!other.saveTrims(defaults) || !store.loadTrims(trims) || memcmp(trims, saved, sizeof(trims)) != 0) {passed = false;}
+
+  //a record from a newer firmware is ignored, the defaults replace it
+  TrimRecord record;
+  memset(&record, 0, sizeof(TrimRecord));
+  record.version = TRIM_VERSION + 1;
+  if (!store.putRecord(&record) || store.loadTrims(trims)) {passed = false;}
+  if (store.loadOrMigrateTrims(trims, defaults) || !store.loadTrims(trims) || memcmp(trims, defaults, sizeof(trims)) != 0) {
+    passed = false;
+  }
+
+  store.clearTrims();
+  other.clearTrims();
+  if (store.loadTrims(trims)) {passed = false;}
+
+  //no load timing, a host build's flash is RAM and its clock is virtual, a bot prints its load time at boot
+  Serial.println(passed ? "trim store test PASSED" : "trim store test FAILED");
+  return passed;
+}
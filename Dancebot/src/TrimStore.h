@@ -0,0 +1,55 @@
+/* TrimStore.h
+ * UT Austin RAS Demobots
+ * Save each bot's servo trims in NVS (flash) so they don't need to be hard coded
+ *
+ * Trims are stored under a key made from the bot's WiFi MAC address, so a flash image
+ * copied from another bot doesn't bring that bot's trims with it.
+ * If a bot has no saved trims, the hard coded trims in calibrateTrims() are saved as its starting point.
+ *
+ * Without ESP_PLATFORM (host builds) NVS is replaced by a RAM table.
+ */
+
+#ifndef TRIMSTORE
+#define TRIMSTORE
+
+#include <stdint.h>
+
+#define TRIM_VERSION 1
+#define TRIM_KEY_LEN 14       //"t" + 12 hex digits of the MAC + 0, NVS keys are at most 15 chars
+
+//what is saved in NVS
+//[hipL, hipR, ankleL, ankleR]
+typedef struct TrimRecord {
+  uint8_t version;            //TRIM_VERSION
+  uint8_t reserved;
+  int16_t trims[4];           //degrees
+} TrimRecord;
+
+class TrimStore {
+public:
+  TrimStore();
+  bool begin(const uint8_t mac[6]);
+
+  //load this bot's trims, false if it has none saved (trims is left unchanged)
+  bool loadTrims(int trims[4]);
+  bool saveTrims(const int trims[4]);
+  bool clearTrims();                //forget them, the next boot saves the defaults again
+
+  //load the saved trims, or save defaults as this bot's trims if there are none yet
+  //returns true if the trims came from NVS
+  bool loadOrMigrateTrims(int trims[4], const int defaults[4]);
+
+  unsigned long getLoadMicros();    //how long the last loadTrims() took
+
+private:
+  friend bool trimStoreTest();
+  bool putRecord(const TrimRecord* record);
+
+  char key[TRIM_KEY_LEN];
+  unsigned long loadMicros;
+};
+
+//load, save and migrate on two made up MACs
+bool trimStoreTest();
+
+#endif
@@ -0,0 +1,1496 @@
+/* ESP32 Web Controller for DanceBot
+ *
+ * Sets up the ESP32 as a WiFi Access Point or connects to an existing WiFi network
+ * Launches a Web Server with buttons to input dance moves to the DancingServos object
+ *
+ * WIFI_MODE variable
+ * AP Mode: Launches the web server at http://192.168.4.1:80/       AP untested
+ * STA Mode: Connects to an existing WiFi network
+ *
+ * Set WiFi credentials with "ssid" and "pass" strings
+
+ *
+ * Resources
+ *
+ * Arduino ESP32 and ESP32Servo Docs
+ * https://github.com/espressif/arduino-esp32
+ * https://www.arduinolibraries.info/libraries/esp32-servo
+ *
+ * Web Server
+ * https://github.com/espressif/arduino-esp32/tree/master/libraries/WebServer
+ * Arduino IDE: Examples > Examples for ESP32 > WebServer > AdvancedWebServer
+ * 
+ * Javascript AJAX and DOM
+ * https://www.w3schools.com/js/js_htmldom.asp
+ * https://www.w3schools.com/js/js_ajax_intro.asp
+ * https://www.w3schools.com/js/js_ajax_http_send.asp
+ * https://www.w3schools.com/jsref/event_onclick.asp
+ */
+ 
+#include "HardwareProfile.h"
+#if IS_MOTHERSHIP
+
+#include <WiFi.h>
+#include <WiFiClient.h>
+#include <WebServer.h>
+#include <ESPmDNS.h>
+//#include <esp_now.h>
+#include <esp_now.h>
+#include "DancingServos.h"
+#include "RoutineStore.h"
+#include "TrimStore.h"
+#include "FleetRegistry.h"
+#include "ReliableLink.h"
+#include "FleetTelemetry.h"
+#include "TraceRecorder.h"
+#include "WebController.h"
+#if HAS_MICROPHONE
+#include <esp_timer.h>
+#include "BeatTracker.h"
+#include "Microphone.h"
+#endif
+
+
+void handleRoot();
+void handleDanceMove();
+void handleDance();
+void handleNotFound();
+void handleUnknownMove();
+void transmitToDancebots();
+void transmitToFleet(const uint8_t* data, size_t len);
+esp_err_t sendToDancebot(FleetBot* bot, const uint8_t* data, size_t len);
+bool resendToDancebot(int id, struct_message* message);
+void handleRoutineUpload();
+void transmitRoutine(const uint8_t* routine, size_t len);
+void handleTrims();
+String getTrimsString();
+void handleFleet();
+void handleTrace();
+void handleTraceClear();
+void handleTempo();
+void setFleetTempo(int bpm);
+void loopBeat();
+void handleMusic();
+void handleTune();
+void loopTune();
+void setTuneParam(int joint, int param, int value);
+int getTuneParam(int joint, int param);
+
+String indexHTML();
+String getJavascript();
+
+
+/* Data Transmission */
+esp_now_peer_info_t peerInfo;
+uint8_t broadcastAddress[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+struct_message transmitMessage;  //message sent to clients
+struct_message receivedMessage; //message received by clients
+
+//dancebots that have joined, with their battery levels and power tiers
+FleetRegistry fleet;
+
+//commands waiting for acks from the dancebots
+ReliableSender reliable(resendToDancebot);
+
+//hellos from onDataRecv, loopFleet() adds the bots to the fleet
+#define HELLO_QUEUE_SIZE 16
+typedef struct HelloInfo {
+  uint8_t mac[6];
+  int id;                       //the id the bot thinks it has, -1 = none yet
+} HelloInfo;
+HelloInfo helloQueue[HELLO_QUEUE_SIZE];
+volatile int helloHead = 0;     //next hello for loopFleet()
+volatile int helloTail = 0;     //where onDataRecv puts the next hello
+
+//acks from onDataRecv, loopFleet() gives them to reliable so only loop() touches its table
+#define ACK_QUEUE_SIZE 64
+typedef struct AckInfo {
+  int id;
+  uint16_t seq;
+} AckInfo;
+AckInfo ackQueue[ACK_QUEUE_SIZE];
+volatile int ackHead = 0;
+volatile int ackTail = 0;
+
+//battery levels the bots were asked for, from onDataRecv, loopFleet() puts them in the fleet
+#define BATTERY_QUEUE_SIZE 16
+typedef struct BatteryInfo {
+  uint8_t mac[6];
+  int id;
+  int batteryLevel;
+  int powerTier;
+} BatteryInfo;
+BatteryInfo batteryQueue[BATTERY_QUEUE_SIZE];
+volatile int batteryHead = 0;
+volatile int batteryTail = 0;
+
+//telemetry history of each bot, see "/fleet"
+FleetTelemetry telemetry;
+
+//telemetry from onDataRecv, loopFleet() adds it to the history
+#define TELEMETRY_QUEUE_SIZE 16
+typedef struct TelemetryInfo {
+  uint8_t mac[6];
+  struct_telemetry message;
+} TelemetryInfo;
+TelemetryInfo telemetryQueue[TELEMETRY_QUEUE_SIZE];
+volatile int telemetryHead = 0;
+volatile int telemetryTail = 0;
+
+//the last beat a beacon went out for, see loopBeat()
+uint32_t lastBeacon = 0;
+bool beaconSent = false;
+
+#if HAS_MICROPHONE
+//the music's tempo and beat from the microphone, see loopMusic()
+#define MUSIC_READ_SAMPLES 512      //most samples taken per run, 32 ms
+#define MUSIC_TEMPO_STEP 2          //BPM the music has to move before the fleet's tempo follows it
+BeatTracker musicTracker;
+bool musicFollow = true;            //the fleet's tempo and beat follow the music
+bool musicStarted = false;
+unsigned long musicUpdate = 0;      //the tracker's last tempo update loopMusic() used
+unsigned long musicFrames = 0;
+unsigned long musicFrameCost = 0;   //us, all frames
+unsigned long musicMaxCost = 0;     //us, the worst run per frame in it
+#endif
+
+//live tuning of a move on the selected bots, see "/tune" and loopTune()
+#define TUNE_RATE 10                //frames a second by default
+#define TUNE_MAX_RATE 50
+#define TUNE_REFRESH_MS 1000        //every parameter is sent this often, for bots that missed a frame
+#define TUNE_PERIOD_BIT (NUM_LEG_JOINTS * 3)
+MoveShape tuneShape = {{0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, BEATS(4)};
+uint16_t tuneChanged = 0;           //bit joint * 3 + TUNE_ parameter, TUNE_PERIOD_BIT for the period, not sent yet
+uint64_t tuneBots = 0;              //bit id set for each bot tuned
+bool tuning = false;                //sending changes to the bots
+bool tuneStart = false;             //the next frame starts the tuned move
+int tuneRate = TUNE_RATE;
+uint16_t tuneSeq = 0;
+unsigned long lastTuneFrame = 0;
+unsigned long lastTuneRefresh = 0;
+unsigned long tuneChanges = 0;      //parameter changes posted, they go out in tuneFrames frames
+unsigned long tuneFrames = 0;
+
+//Web Server
+const char * server_ssid;
+const char * server_pass;
+int port = 80;
+IPAddress ip;
+String webServerPath = "http://";
+
+//Web server at port 80
+WebServer server(port);
+
+//DancingServos object
+DancingServos* dance_bot;
+
+//uploaded dance routines
+RoutineStore* routineStore;
+
+//saved servo trims
+TrimStore* trimStore;
+
+void printMACAddress(){
+  Serial.println(WiFi.macAddress());
+}
+
+//ESP-NOW sends since boot and the ones that weren't delivered, counted in the Wi-Fi task and printed from loop() ('j' over Serial)
+//printing each one from the callback would fill Serial at 115200 baud
+volatile uint32_t sendCount = 0;
+volatile uint32_t sendFailures = 0;
+uint32_t sendCountReset = 0;      //the counts at resetSendStats(), only the Wi-Fi task writes the counts
+uint32_t sendFailuresReset = 0;
+
+//callback when data is sent
+void onDataSent(const uint8_t *mac_addr, esp_now_send_status_t status) {
+  sendCount++;
+  if (status != ESP_NOW_SEND_SUCCESS) {
+    sendFailures++;
+  }
+}
+
+void printSendStats(Print* out) {
+  out->println("ESP-NOW sends: " + String(sendCount - sendCountReset) + " not delivered: " + String(sendFailures - sendFailuresReset));
+}
+
+void resetSendStats() {
+  sendCountReset = sendCount;
+  sendFailuresReset = sendFailures;
+}
+
+//callback when data is received
+void onDataRecv(const uint8_t* mac, const uint8_t* incomingData, int len) {
+  //every bot sends telemetry each second, don't print those
+  if (len == sizeof(struct_telemetry)) {
+    int next = (telemetryTail + 1) % TELEMETRY_QUEUE_SIZE;
+    if (next != telemetryHead) {
+      memcpy(telemetryQueue[telemetryTail].mac, mac, 6);
+      memcpy(&telemetryQueue[telemetryTail].message, incomingData, sizeof(struct_telemetry));
+      telemetryTail = next;
+    }
+    return;
+  }
+  if (len != sizeof(struct_message)) {
+    return;
+  }
+  memcpy(&receivedMessage, incomingData, sizeof(receivedMessage));
+
+  //a full queue drops the ack, the command is sent again and acked again
+  if (receivedMessage.status == Ack) {
+    int next = (ackTail + 1) % ACK_QUEUE_SIZE;
+    if (next != ackHead) {
+      ackQueue[ackTail].id = receivedMessage.id;
+      ackQueue[ackTail].seq = receivedMessage.seq;
+      ackTail = next;
+    }
+    return;
+  }
+
+  //bots say hello every few seconds, don't print those
+  if (receivedMessage.status == Hello) {
+    int next = (helloTail + 1) % HELLO_QUEUE_SIZE;
+    if (next != helloHead) {
+      memcpy(helloQueue[helloTail].mac, mac, 6);
+      helloQueue[helloTail].id = receivedMessage.id;
+      helloTail = next;
+    }
+    return;
+  }
+
+  //loopFleet() adds and drops bots, so only it touches the fleet
+  if (receivedMessage.status == BattLevel) {
+    int next = (batteryTail + 1) % BATTERY_QUEUE_SIZE;
+    if (next != batteryHead) {
+      memcpy(batteryQueue[batteryTail].mac, mac, 6);
+      batteryQueue[batteryTail].id = receivedMessage.id;
+      batteryQueue[batteryTail].batteryLevel = receivedMessage.batteryLevel;
+      batteryQueue[batteryTail].powerTier = receivedMessage.powerTier;
+      batteryTail = next;
+    }
+  }
+}
+
+/* Setup Functions */
+
+/* setupESPNOW 
+ * Sets up transmit and receive communication with Mothership
+*/
+int setupESPNOW(){
+  // Init ESP-NOW
+  if (esp_now_init() != 0) {
+    Serial.println("Error initializing ESP-NOW");
+    return 0;
+  }
+
+  esp_now_register_send_cb(onDataSent); //func called when we send data
+
+  //dancebots join by saying hello (see loopFleet), until then and past the ESP-NOW peer limit they are sent broadcasts
+  memcpy(peerInfo.peer_addr, broadcastAddress, sizeof(peerInfo.peer_addr));
+  peerInfo.channel = 0; 
+  peerInfo.encrypt = false;
+  if (esp_now_add_peer(&peerInfo) != ESP_OK){
+    Serial.println("Failed to add broadcast peer");
+    return 0;
+  }
+  memset(transmitMessage.target, 0xFF, sizeof(transmitMessage.target));
+  transmitMessage.tempo = REFERENCE_BPM;
+
+  esp_now_register_recv_cb(onDataRecv); //func called when we receive data
+  Serial.println("Finished setting up ESPNOW");
+  return 1;
+}
+
+/* loopFleet
+ * add bots that said hello to the fleet and send them their ids
+ * pass the bots' acks on to reliable
+ * drop bots that haven't said hello for FLEET_TIMEOUT_MS
+ * the first FLEET_MAX_PEERS bots are ESP-NOW peers, when one leaves the next bot takes its place
+ * keep the telemetry and battery levels the bots sent
+ */
+void loopFleet() {
+  unsigned long t = millis();
+
+  while (helloHead != helloTail) {
+    HelloInfo* hello = &helloQueue[helloHead];
+    bool known = fleet.findBot(hello->mac) != -1;
+    int id = fleet.join(hello->mac, t);
+    if (id == -1) {
+      Serial.println("Fleet is full, a dancebot could not join");
+    }
+    else if (!known) {
+      Serial.println("Dancebot " + String(id) + " joined, " + String(fleet.getNumBots()) + " dancebots");
+      if (id >= TELEMETRY_MAX_BOTS) {
+        Serial.println("Dancebot " + String(id) + " has no telemetry history, only the first " + String(TELEMETRY_MAX_BOTS) + " do");
+      }
+    }
+    else if (hello->id != id) {
+      fleet.getBot(id)->needsId = true;    //the bot restarted, or missed its id
+    }
+    helloHead = (helloHead + 1) % HELLO_QUEUE_SIZE;
+  }
+
+  while (telemetryHead != telemetryTail) {
+    TelemetryInfo* info = &telemetryQueue[telemetryHead];
+    FleetBot* bot = fleet.getBot(info->message.id);
+    if (info->message.status == Telemetry && bot != NULL && memcmp(bot->mac, info->mac, 6) == 0) {
+      bot->lastSeen = t;
+      bot->batteryLevel = info->message.sample.battery;
+      bot->powerTier = info->message.sample.powerTier;
+      telemetry.addSample(info->message.id, &info->message.sample);
+    }
+    telemetryHead = (telemetryHead + 1) % TELEMETRY_QUEUE_SIZE;
+  }
+
+  while (batteryHead != batteryTail) {
+    BatteryInfo* info = &batteryQueue[batteryHead];
+    FleetBot* bot = fleet.getBot(info->id);
+    if (bot != NULL && memcmp(bot->mac, info->mac, 6) == 0) {
+      transmitMessage.batteryFlag = 0; //don't ask for battery level anymore (could be redundant if you always set flag = 0 each time you ask for battlvl)
+      Serial.println("Dancebot " + String(info->id) + " battery level: " + String(info->batteryLevel) + " power tier: " + String(info->powerTier));
+      bot->batteryLevel = info->batteryLevel;
+      bot->powerTier = info->powerTier;
+    }
+    batteryHead = (batteryHead + 1) % BATTERY_QUEUE_SIZE;
+  }
+
+  while (ackHead != ackTail) {
+    reliable.ack(ackQueue[ackHead].id, ackQueue[ackHead].seq);
+    ackHead = (ackHead + 1) % ACK_QUEUE_SIZE;
+  }
+
+  for (int id = 0; id < MAX_DANCEBOTS; id++) {
+    FleetBot* bot = fleet.getBot(id);
+    if (bot == NULL) {
+      continue;
+    }
+
+    if (t - bot->lastSeen > FLEET_TIMEOUT_MS) {
+      if (bot->isPeer) {
+        esp_now_del_peer(bot->mac);
+      }
+      reliable.dropBot(id);
+      telemetry.clearBot(id);
+      fleet.leave(id);
+      Serial.println("Dancebot " + String(id) + " left, " + String(fleet.getNumBots()) + " dancebots");
+      continue;
+    }
+
+    if (!bot->isPeer && fleet.getNumPeers() < FLEET_MAX_PEERS) {
+      memcpy(peerInfo.peer_addr, bot->mac, sizeof(peerInfo.peer_addr));
+      peerInfo.channel = 0; 
+      peerInfo.encrypt = false;
+      if (esp_now_add_peer(&peerInfo) == ESP_OK) {
+        fleet.setPeer(id, true);
+      }
+    }
+
+    if (bot->needsId) {
+      struct_message idMessage;
+      memset(&idMessage, 0, sizeof(idMessage));
+      idMessage.id = id;
+      idMessage.status = SetID;
+      idMessage.tempo = transmitMessage.tempo;
+      memcpy(idMessage.target, bot->mac, sizeof(idMessage.target));
+      if (sendToDancebot(bot, (uint8_t *) &idMessage, sizeof(idMessage)) == ESP_OK) {
+        bot->needsId = false;
+      }
+    }
+  }
+
+  reliable.loop(t);
+  loopBeat();
+  loopTune();
+}
+
+/* loopBeat
+ * broadcast a beat beacon on every beat, the bots' BeatClocks follow it (see BeatClock.h)
+ * a broadcast goes out once and isn't retried, so it reaches every bot at about the same time
+ */
+void loopBeat() {
+  BeatClock* clock = dance_bot->getBeatClock();
+  if (clock == NULL) {
+    return;
+  }
+  uint32_t beat = clock->getBeat(clock->now());
+  if (beaconSent && beat == lastBeacon) {
+    return;
+  }
+  struct_beat beacon;
+  clock->makeBeacon(&beacon);
+  if (esp_now_send(broadcastAddress, (uint8_t *) &beacon, sizeof(beacon)) == ESP_OK) {
+    lastBeacon = beat;
+    beaconSent = true;
+  }
+}
+
+#if HAS_MICROPHONE
+bool setupMusic() {
+  return microphoneBegin();
+}
+
+/* loopMusic
+ * feed the microphone's samples to the beat tracker, and while musicFollow is set let the fleet follow the music:
+ * a tempo MUSIC_TEMPO_STEP or more from the fleet's is sent to the bots like a /tempo change,
+ * and the beat grid in the beacons is moved onto the music's beats
+ */
+void loopMusic() {
+  static int16_t samples[MUSIC_READ_SAMPLES];
+  int count = microphoneRead(samples, MUSIC_READ_SAMPLES);
+  if (count == 0) {
+    return;
+  }
+  //the last sample came in about now, the DMA buffer it waited in is shorter than a frame
+  int64_t readTime = esp_timer_get_time();
+  unsigned long frames = musicTracker.getFrameCount();
+  unsigned long start = micros();
+  musicTracker.addSamples(samples, count);
+  unsigned long cost = micros() - start;
+  frames = musicTracker.getFrameCount() - frames;
+  if (frames > 0) {
+    musicFrames += frames;
+    musicFrameCost += cost;
+    if (cost / frames > musicMaxCost) {musicMaxCost = cost / frames;}
+  }
+
+  if (!musicFollow || !musicTracker.hasTempo() || musicTracker.getConfidence() < BEAT_MIN_CONFIDENCE ||
+      musicTracker.getTempoUpdates() == musicUpdate) {
+    return;
+  }
+  musicUpdate = musicTracker.getTempoUpdates();
+  int bpm = lround(musicTracker.getTempo());
+  if (abs(bpm - transmitMessage.tempo) >= MUSIC_TEMPO_STEP) {
+    setFleetTempo(bpm);
+    transmitMessage.status = SetTempo;
+    transmitToDancebots();
+    transmitMessage.status = None;
+  }
+  BeatClock* clock = dance_bot->getBeatClock();
+  int64_t beat = musicTracker.getLastBeat();
+  if (clock != NULL && beat >= 0) {
+    int64_t beatTime = readTime - (musicTracker.getSampleCount() - beat) * 1000000 / BEAT_SAMPLE_RATE;
+    clock->alignBeat(clock->toFleet(beatTime));
+  }
+}
+#endif
+
+/* loopTune
+ * send the tuning changes to the selected bots, at most tuneRate frames a second
+ * changes that come in between frames are merged, a frame only has each changed parameter's latest value
+ * frames are broadcast once like the beat beacons, so every selected bot gets a change at the same time,
+ * and every parameter goes out again each TUNE_REFRESH_MS in case a bot missed one
+ */
+void loopTune() {
+  unsigned long t = millis();
+  if (!tuning || tuneBots == 0 || t - lastTuneFrame < 1000UL / tuneRate) {
+    return;
+  }
+  bool all = tuneStart || t - lastTuneRefresh >= TUNE_REFRESH_MS;
+  uint16_t changed = all ? (1 << (TUNE_PERIOD_BIT + 1)) - 1 : tuneChanged;
+  if (changed == 0) {
+    return;
+  }
+
+  struct_tune frame;
+  memset(&frame, 0, sizeof(frame));
+  frame.status = Tune;
+  frame.seq = ++tuneSeq;
+  frame.flags = tuneStart ? TUNE_START : 0;
+  frame.bots = tuneBots;
+  for (int bit = 0; bit <= TUNE_PERIOD_BIT; bit++) {
+    if ((changed & (1 << bit)) == 0) {
+      continue;
+    }
+    TuneDelta* delta = &frame.deltas[frame.count++];
+    delta->joint = bit == TUNE_PERIOD_BIT ? 0 : bit / 3;
+    delta->param = bit == TUNE_PERIOD_BIT ? TUNE_PERIOD : bit % 3;
+    delta->value = getTuneParam(delta->joint, delta->param);
+  }
+  if (esp_now_send(broadcastAddress, (uint8_t *) &frame, TUNE_HEADER_SIZE + frame.count * sizeof(TuneDelta)) != ESP_OK) {
+    return;
+  }
+  lastTuneFrame = t;
+  if (all) {lastTuneRefresh = t;}
+  tuneChanged = 0;
+  tuneStart = false;
+  tuneFrames++;
+}
+
+void setTuneParam(int joint, int param, int value) {
+  switch (param) {
+    case TUNE_AMP:    tuneShape.amp[joint] = clampTuneValue(param, value); break;
+    case TUNE_OFF:    tuneShape.off[joint] = clampTuneValue(param, value); break;
+    case TUNE_PH0:    tuneShape.ph0[joint] = clampTuneValue(param, value); break;
+    case TUNE_PERIOD: tuneShape.period = clampTuneValue(param, value); break;
+  }
+  tuneChanged |= 1 << (param == TUNE_PERIOD ? TUNE_PERIOD_BIT : joint * 3 + param);
+  tuneChanges++;
+}
+
+int getTuneParam(int joint, int param) {
+  switch (param) {
+    case TUNE_AMP:    return tuneShape.amp[joint];
+    case TUNE_OFF:    return tuneShape.off[joint];
+    case TUNE_PH0:    return lround(tuneShape.ph0[joint]);
+    default:          return tuneShape.period;
+  }
+}
+
+/* setupWiFi
+ * NOTE: this legacy function = setupAPNetwork() in DancebotESP32
+ * STA = connect to a WiFi network with name ssid
+ * AP = create a WiFi access point with  name ssid
+ */
+void setupWiFi(String mode, const char * ssid, const char * pass) {
+  server_ssid = ssid;
+  server_pass = pass;
+
+  /*****OLD WIFI CODE******/
+  if (mode.equals("AP")) {
+    //Turn on Access Point
+    WiFi.softAP(ssid, pass);
+    ip = WiFi.softAPIP();
+  }
+  else {
+    //Connect to a WiFi network
+    WiFi.mode(WIFI_STA);
+    WiFi.begin(ssid, pass);
+    while (WiFi.status() != WL_CONNECTED) {
+      delay(500);
+      yield();
+      //Serial.print(".");
+    }
+    ip = WiFi.localIP();
+
+    if (MDNS.begin("esp32")) {
+      Serial.println("MDNS responder started");
+    }
+  }
+
+  Serial.println("WiFi mode=" + mode + ", ssid = " + String(ssid) + ", pass = " + String(pass));
+}
+
+void setupWebServer(DancingServos* _dance_bot, RoutineStore* _routineStore, TrimStore* _trimStore) {
+  //Turn on a web server at port 80
+  //Map paths to hander functions, can also specify HTTP methods
+
+  server.on("/", handleRoot);
+  server.on("/danceM", HTTP_POST, handleDanceMove);
+  server.on("/danceM", HTTP_GET, handleRoot);
+  server.on("/dance", HTTP_POST, handleDance);
+  server.on("/dance", HTTP_GET, handleRoot);
+  server.on("/routine", HTTP_POST, handleRoutineUpload);
+  server.on("/routine", HTTP_GET, handleRoot);
+  server.on("/trim", handleTrims);
+  server.on("/fleet", HTTP_GET, handleFleet);
+  server.on("/trace", HTTP_GET, handleTrace);
+  server.on("/trace", HTTP_POST, handleTraceClear);
+  server.on("/tempo", handleTempo);
+  server.on("/music", handleMusic);
+  server.on("/tune", handleTune);
+  server.onNotFound(handleNotFound);    //404 Not Found
+
+  server.begin();
+
+  webServerPath += ip.toString() + ":" + String(port) + "/";
+
+  Serial.println("Web server at " + webServerPath);
+
+  dance_bot = _dance_bot;
+  routineStore = _routineStore;
+  trimStore = _trimStore;
+  dance_bot->getMoveShape(WALK, &tuneShape);
+}
+
+/* Main Loop */
+void loopWebServer() {
+  //handle web server
+  server.handleClient();
+}
+
+
+/* Request Handlers */
+
+//main page   "/"
+void handleRoot() {
+  Serial.println("Server received new client");
+  server.send(200, "text/html", indexHTML());
+}
+
+
+//dance moves    "/danceM"
+void handleDanceMove() {
+  //hasArg() checks if the last HTTP request in the server has an argument
+  //arg() gets the value of the arg by name
+
+  //check for serial input form
+  String dance_move = "";
+  if(server.hasArg("dance_move")) {
+    //BPM = the tempo to dance it at, it goes to the dancebots with the move
+    if (server.hasArg("BPM")) {
+      setFleetTempo(server.arg("BPM").toInt());
+    }
+    dance_move = server.arg("dance_move");
+    Serial.println("Server received dance_move: " + dance_move);
+    //a dance move ends live tuning, the bots stop taking the changes too
+    tuning = false;
+
+    //queue=1 plays the move after the moves already queued
+    bool queue = server.hasArg("queue") && server.arg("queue") == "1";
+    dance_bot->setQueueMoves(queue);
+    transmitMessage.status = queue ? QueueMove : None;
+
+    if (dance_move == "Stop") {
+      dance_bot->stopOscillation();
+      dance_bot->enableDanceRoutine(false);
+      transmitMessage.danceMove = STOP;
+      strcpy(transmitMessage.character, "Dance: STOP");
+    }
+    else if (dance_move == "Reset") {
+      dance_bot->position0();
+      transmitMessage.danceMove = RESET;
+      strcpy(transmitMessage.character, "Dance: RESET");
+    }
+    else if (dance_move == "Walk") {
+      // dance_bot->walk(-1, 1500, false); //ORIGINAL
+      dance_bot->walk(-1, 1500, true);
+      transmitMessage.danceMove = WALK;
+      strcpy(transmitMessage.character, "Dance: WALK");
+    }
+    else if (dance_move == "Hop") {
+      // dance_bot->hop(25, -1); // ORIGINAL
+      dance_bot->hop(40, -1);
+      transmitMessage.danceMove = HOP;
+      strcpy(transmitMessage.character, "Dance: HOP");
+    }
+    else if (dance_move == "Wiggle") {
+      dance_bot->wiggle(30, -1);
+      transmitMessage.danceMove = WIGGLE;
+      strcpy(transmitMessage.character, "Dance: WIGGLE");
+    }
+    else if (dance_move == "Ankles") {
+      dance_bot->themAnkles(-1);
+      transmitMessage.danceMove = ANKLES;
+      strcpy(transmitMessage.character, "Dance: ANKLES");
+    }
+    // dev notes: new moves below:
+    else if (dance_move == "Left Heel Toe") {
+      dance_bot->heel_toe(-1, true);
+      transmitMessage.danceMove = LEFT_HEELTOE;
+      strcpy(transmitMessage.character, "Dance: LEFT_HEELTOE");
+    }
+    else if (dance_move == "Right Heel Toe") {
+      dance_bot->heel_toe(-1, false);
+      transmitMessage.danceMove = RIGHT_HEELTOE;
+      strcpy(transmitMessage.character, "Dance: RIGHT_HEELTOE");
+    }
+    else if (dance_move == "Left Stank") {
+      dance_bot->stank(-1, true);
+      transmitMessage.danceMove = LEFT_STANK;
+      strcpy(transmitMessage.character, "Dance: LEFT_STANK");
+    }
+    else if (dance_move == "Right Stank") {
+      dance_bot->stank(-1, false);
+      transmitMessage.danceMove = RIGHT_STANK;
+      strcpy(transmitMessage.character, "Dance: RIGHT_STANK");
+    }
+    else if (dance_move == "Backwards Walk") {
+      // dev notes: more jank changes
+      // dance_bot->walk(-1, 1500, true); //ORIGNAL
+      dance_bot->walk(-1, 1500, false);
+      transmitMessage.danceMove = BWALK;
+      strcpy(transmitMessage.character, "Dance: BWALK");
+    }
+    else if (dance_move == "Wave") {
+      dance_bot->wave(40, -1);
+      transmitMessage.danceMove = WAVE;
+      strcpy(transmitMessage.character, "Dance: WAVE");
+    }
+    // dev notes: TEST MOVES below:
+    // else if (dance_move == "ankles") {
+    //   dance_bot->ankles(-1);
+    //   transmitMessage.danceMove = ANKLES_TEST;
+    // }
+    // else if (dance_move == "ankles_phase") {
+    //   dance_bot->ankles_phase(-1);
+    //   transmitMessage.danceMove = ANKLES_PHASE;
+    // }
+    // else if (dance_move == "ankles_offset") {
+    //   dance_bot->ankles_offset(-1);
+    //   transmitMessage.danceMove = ANKLES_OFFSET;
+    // }
+    // else if (dance_move == "legs") {
+    //   dance_bot->legs(-1);
+    //   transmitMessage.danceMove = LEGS;
+    // }
+    // else if (dance_move == "legs_phase") {
+    //   dance_bot->legs_phase(-1);
+    //   transmitMessage.danceMove = LEGS_PHASE;
+    // }
+    // else if (dance_move == "legs_offset") {
+    //   dance_bot->legs_offset(-1);
+    //   transmitMessage.danceMove = LEGS_OFFSET;
+    // }
+    else {
+      Serial.println("Dance move not recognized, ERROR too lit for this robot");
+      dance_bot->setQueueMoves(false);
+      handleUnknownMove();
+      return;
+    }
+    dance_bot->setQueueMoves(false);
+  }
+  else {
+    dance_move = "ERROR Server did not find dance move argument in HTTP request";
+    strcpy(transmitMessage.character, "Server argument not found");
+  }
+
+  transmitToDancebots();
+
+  //delay(1000);
+
+  //handleRoot();     //now the form is handled with JS so there is no need to respond with index html
+  server.send(200, "text/plain", dance_move);
+}
+
+//dance routines    "/dance"
+void handleDance() {
+  String dance_routine = "";
+  if(server.hasArg("dance_routine")) {
+    dance_routine = server.arg("dance_routine");
+    Serial.println("Server received dance_routine: " + dance_routine);
+
+    //look the routine up by name, dance routine i is sent to the dancebots as DEMO1 + i
+    String * danceRoutines = dance_bot->getDanceRoutines();
+    int routine = -1;
+    for (int i = 0; i < dance_bot->getNumDanceRoutines(); i++) {
+      if (dance_routine.equals(danceRoutines[i])) {
+        routine = i;
+        break;
+      }
+    }
+
+    if (routine == -1) {
+      Serial.println("Dance routine not recognized, ERROR too lit for this robot");
+      handleUnknownMove();
+      return;
+    }
+
+    dance_bot->setDanceRoutine(routine);
+    dance_bot->enableDanceRoutine(true);
+    //uploaded routines can be at different indexes on each bot, so the bots look the routine up by name
+    transmitMessage.danceMove = DEMO1 + routine;
+    transmitMessage.status = None;
+    strncpy(transmitMessage.character, danceRoutines[routine].c_str(), sizeof(transmitMessage.character) - 1);
+    transmitMessage.character[sizeof(transmitMessage.character) - 1] = 0;
+    transmitToDancebots();
+  }
+  else {
+    dance_routine = "ERROR Server did not find dance routine argument in HTTP request";
+    //strcpy(message.character, "Server arguement not found");
+  }
+  server.send(200, "text/plain", dance_routine);
+}
+
+//transmit transmitMessage to all clients
+//each bot acknowledges it, bots that don't are sent it again (see ReliableLink.h)
+void transmitToDancebots() {
+  memset(transmitMessage.target, 0xFF, sizeof(transmitMessage.target));
+  transmitMessage.seq = reliable.nextSeq();
+
+  //track before sending, an ack can come back before esp_now_send returns
+  for (int i = 0; i < MAX_DANCEBOTS; i++) {
+    if (fleet.getBot(i) != NULL && !reliable.track(i, &transmitMessage, millis())) {
+      Serial.println("Too many commands waiting for acks, Dancebot " + String(i) + " may miss this one");
+    }
+  }
+  transmitToFleet((uint8_t *) &transmitMessage, sizeof(transmitMessage));
+  transmitMessage.seq = 0;
+}
+
+//send to every bot
+//unicast to each bot while they are all ESP-NOW peers (unicasts are acknowledged and retried by the radio),
+//otherwise one broadcast reaches all of them
+void transmitToFleet(const uint8_t* data, size_t len) {
+  if (!fleet.allPeers()) {
+    if (esp_now_send(broadcastAddress, data, len) != ESP_OK) {
+      Serial.println("Error broadcasting to Dancebots");
+    }
+    return;
+  }
+
+  for (int i = 0; i < MAX_DANCEBOTS; i++) {
+    FleetBot* bot = fleet.getBot(i);
+    if (bot == NULL) {
+      continue;
+    }
+    if (esp_now_send(bot->mac, data, len) != ESP_OK) {
+      Serial.print("Error sending Dancebot ");
+      Serial.print(i);
+      Serial.println(" data");
+    }
+  }
+}
+
+//send to one bot, unicast if it is an ESP-NOW peer, otherwise broadcast (bots check the message's target)
+esp_err_t sendToDancebot(FleetBot* bot, const uint8_t* data, size_t len) {
+  return esp_now_send(bot->isPeer ? bot->mac : broadcastAddress, data, len);
+}
+
+//ReliableSender resends a command to the one bot that hasn't acknowledged it
+bool resendToDancebot(int id, struct_message* message) {
+  FleetBot* bot = fleet.getBot(id);
+  if (bot == NULL) {
+    return false;
+  }
+  memcpy(message->target, bot->mac, sizeof(message->target));
+  return sendToDancebot(bot, (uint8_t *) message, sizeof(struct_message)) == ESP_OK;
+}
+
+//upload a dance routine    "/routine"
+//either routine = the routine binary format as hex (see RoutineStore.h)
+//or name = routine name and steps = "Walk,1500,2;Hop,25,1" (dance move, arg, cycles for each step)
+//or delete = routine name, deletes it here and on the dancebots
+void handleRoutineUpload() {
+  static uint8_t routine[ROUTINE_MAX_SIZE];
+  size_t len = 0;
+
+  if (server.hasArg("delete")) {
+    String name = server.arg("delete");
+    if (!routineStore->deleteRoutine(name.c_str(), dance_bot)) {
+      server.send(404, "text/plain", "ERROR routine not stored");
+      return;
+    }
+    transmitMessage.status = DeleteRoutine;
+    strncpy(transmitMessage.character, name.c_str(), sizeof(transmitMessage.character) - 1);
+    transmitMessage.character[sizeof(transmitMessage.character) - 1] = 0;
+    transmitToDancebots();
+    transmitMessage.status = None;
+    Serial.println("Deleted routine " + name);
+    server.send(200, "text/plain", name);
+    return;
+  }
+
+  if (server.hasArg("routine")) {
+    String hex = server.arg("routine");
+    for (unsigned int i = 0; i + 1 < hex.length() && len < ROUTINE_MAX_SIZE; i += 2) {
+      routine[len++] = strtoul(hex.substring(i, i + 2).c_str(), NULL, 16);
+    }
+  }
+  else if (server.hasArg("name") && server.hasArg("steps")) {
+    DanceStep steps[ROUTINE_MAX_STEPS];
+    int numSteps = 0;
+    String text = server.arg("steps") + ";";
+    String * danceMoves = dance_bot->getDanceMoves();
+
+    //the index of a dance move name is its enum
+    int start = 0;
+    for (int end = text.indexOf(';'); end != -1 && numSteps < ROUTINE_MAX_STEPS; end = text.indexOf(';', start)) {
+      String step = text.substring(start, end);
+      start = end + 1;
+      if (step.length() == 0) {continue;}
+      int comma1 = step.indexOf(',');
+      int comma2 = step.indexOf(',', comma1 + 1);
+      int move = -1;
+      for (int i = 0; comma1 != -1 && i < dance_bot->getNumDanceMoves(); i++) {
+        if (step.substring(0, comma1).equals(danceMoves[i])) {move = i;}
+      }
+      if (move == -1 || comma2 == -1) {
+        server.send(400, "text/plain", "ERROR step not valid: " + step);
+        return;
+      }
+
+      steps[numSteps].move = move;
+      steps[numSteps].arg = constrain((int) step.substring(comma1 + 1, comma2).toInt(), -32768, 32767);
+      steps[numSteps].cycles = step.substring(comma2 + 1).toFloat();
+      if (!checkDanceStep(&steps[numSteps])) {
+        server.send(400, "text/plain", "ERROR step out of range: " + step + ", periods are " + String(MIN_MOVE_PERIOD) +
+                    " to " + String(MAX_MOVE_PERIOD) + " ms, angles up to " + String(MAX_MOVE_ANGLE));
+        return;
+      }
+      numSteps++;
+    }
+    len = buildRoutine(routine, server.arg("name").c_str(), steps, numSteps);
+  }
+
+  if (len == 0 || !checkRoutine(routine, len)) {
+    server.send(400, "text/plain", "ERROR routine not valid");
+    return;
+  }
+
+  //store it, play it from flash and send it to the dancebots
+  const RoutineHeader* stored = routineStore->storeRoutine(routine, len, dance_bot);
+  if (stored == NULL) {
+    server.send(500, "text/plain", "ERROR could not store routine, delete one if all " + String(ROUTINE_NUM_SLOTS) +
+                " are stored or the bot has " + String(MAX_DANCE_ROUTINES) + " routines");
+    return;
+  }
+  transmitRoutine(routine, len);
+
+  Serial.println("Stored routine " + String(stored->name) + " in " + String(routineStore->getLastWriteMicros()) + " us");
+  server.send(200, "text/plain", String(stored->name));
+}
+
+//send a routine to all clients in chunks
+//each chunk has its own crc, the bots also check the whole routine's crc before storing it
+void transmitRoutine(const uint8_t* routine, size_t len) {
+  struct_routine_chunk chunk;
+  memset(&chunk, 0, sizeof(chunk));
+  chunk.status = RoutineChunk;
+  chunk.routineCrc = routineCrc32(routine, len);
+  chunk.routineLength = len;
+
+  for (size_t offset = 0; offset < len; offset += ROUTINE_CHUNK_SIZE) {
+    chunk.offset = offset;
+    chunk.length = (len - offset < ROUTINE_CHUNK_SIZE) ? (len - offset) : ROUTINE_CHUNK_SIZE;
+    memcpy(chunk.data, routine + offset, chunk.length);
+    chunk.chunkCrc = routineCrc32(chunk.data, chunk.length);
+
+    transmitToFleet((uint8_t *) &chunk, sizeof(chunk));
+  }
+}
+
+//servo trims    "/trim"
+//GET returns this bot's trims as "hipL,hipR,ankleL,ankleR"
+//POST trims = "hipL,hipR,ankleL,ankleR" sets and saves them, bot = dancebot number, or -1 for this bot (default)
+void handleTrims() {
+  if (server.method() == HTTP_GET) {
+    server.send(200, "text/plain", getTrimsString());
+    return;
+  }
+
+  int trims[4];
+  if (!server.hasArg("trims") || sscanf(server.arg("trims").c_str(), "%d,%d,%d,%d", &trims[0], &trims[1], &trims[2], &trims[3]) != 4) {
+    server.send(400, "text/plain", "ERROR Server did not find trims argument in HTTP request");
+    return;
+  }
+  int bot = server.hasArg("bot") ? server.arg("bot").toInt() : -1;
+
+  if (bot == -1) {
+    //the next setPos() uses the new trims, move to rest now so they can be checked
+    dance_bot->setTrims(trims[0], trims[1], trims[2], trims[3]);
+    trimStore->saveTrims(trims);
+    if (!dance_bot->isOscillating()) {
+      dance_bot->position0();
+    }
+  }
+  else if (fleet.getBot(bot) != NULL) {
+    //its own message, the moves broadcast from transmitMessage keep their id
+    FleetBot* target = fleet.getBot(bot);
+    struct_message trimMessage;
+    memset(&trimMessage, 0, sizeof(trimMessage));
+    trimMessage.status = SetTrims;
+    trimMessage.id = bot;
+    trimMessage.tempo = transmitMessage.tempo;
+    memcpy(trimMessage.trims, trims, sizeof(trimMessage.trims));
+    memcpy(trimMessage.target, target->mac, sizeof(trimMessage.target));
+    trimMessage.seq = reliable.nextSeq();
+    reliable.track(bot, &trimMessage, millis());
+    esp_err_t result = sendToDancebot(target, (uint8_t *) &trimMessage, sizeof(trimMessage));
+    if (result != ESP_OK) {
+      server.send(500, "text/plain", "ERROR could not send trims to Dancebot " + String(bot));
+      return;
+    }
+  }
+  else {
+    server.send(400, "text/plain", "ERROR no Dancebot " + String(bot));
+    return;
+  }
+  server.send(200, "text/plain", server.arg("trims"));
+}
+
+String getTrimsString() {
+  int trims[4];
+  dance_bot->getTrims(trims);
+  return String(trims[0]) + "," + String(trims[1]) + "," + String(trims[2]) + "," + String(trims[3]);
+}
+
+//fleet telemetry    "/fleet"
+//no arguments: one CSV line for each bot with its latest telemetry
+//bot = dancebot number: that bot's history as CSV, oldest first, age_s is seconds before the newest sample
+//  tier = 0 (1 s samples, default), 1 (10 s) or 2 (1 min), see FleetTelemetry.h
+//  format = bin: the TelemetrySamples as they are in memory instead of CSV, 8 bytes each
+void handleFleet() {
+  static TelemetrySample samples[TELEMETRY_TIER_SIZE];
+
+  if (!server.hasArg("bot")) {
+    String csv = "id,mac,peer,last_seen_ms,battery,move,rssi,jitter_ms,lag_ms,power_tier,reset_reason\n";
+    unsigned long t = millis();
+    for (int id = 0; id < MAX_DANCEBOTS; id++) {
+      FleetBot* bot = fleet.getBot(id);
+      if (bot == NULL) {
+        continue;
+      }
+      char line[128];
+      int n = snprintf(line, sizeof(line), "%d,%02x:%02x:%02x:%02x:%02x:%02x,%d,%lu", id,
+                       bot->mac[0], bot->mac[1], bot->mac[2], bot->mac[3], bot->mac[4], bot->mac[5], bot->isPeer, t - bot->lastSeen);
+      int count = telemetry.getSamples(id, TIER_1S, samples, TELEMETRY_TIER_SIZE);
+      if (count > 0) {
+        TelemetrySample* s = &samples[count - 1];
+        snprintf(line + n, sizeof(line) - n, ",%u,%u,%d,%u,%u,%u,%u\n",
+                 s->battery, s->danceMove, s->rssi, s->jitter, s->lag, s->powerTier, s->resetReason);
+      }
+      else {
+        snprintf(line + n, sizeof(line) - n, ",,,,,,,\n");
+      }
+      csv += line;
+    }
+    server.send(200, "text/csv", csv);
+    return;
+  }
+
+  int id = server.arg("bot").toInt();
+  int tier = server.hasArg("tier") ? server.arg("tier").toInt() : TIER_1S;
+  if (fleet.getBot(id) == NULL || id >= TELEMETRY_MAX_BOTS) {
+    server.send(404, "text/plain", "ERROR no telemetry for Dancebot " + String(id));
+    return;
+  }
+  if (tier < 0 || tier >= NUM_TELEMETRY_TIERS) {
+    server.send(400, "text/plain", "ERROR tier must be 0, 1 or 2");
+    return;
+  }
+
+  int count = telemetry.getSamples(id, tier, samples, TELEMETRY_TIER_SIZE);
+  if (server.arg("format") == "bin") {
+    server.send_P(200, "application/octet-stream", (const char*) samples, count * sizeof(TelemetrySample));
+    return;
+  }
+
+  String csv = "age_s,battery,move,rssi,jitter_ms,lag_ms,power_tier,reset_reason\n";
+  for (int i = 0; i < count; i++) {
+    TelemetrySample* s = &samples[i];
+    char line[64];
+    snprintf(line, sizeof(line), "%d,%u,%u,%d,%u,%u,%u,%u\n", (count - 1 - i) * telemetry.getTierSeconds(tier),
+             s->battery, s->danceMove, s->rssi, s->jitter, s->lag, s->powerTier, s->resetReason);
+    csv += line;
+  }
+  server.send(200, "text/csv", csv);
+}
+
+//servo trace of the mothership's own servos    "/trace", see TraceRecorder.h
+//GET: the trace as CSV, oldest first
+//  format = bin: the TraceRecords as they are in memory instead of CSV, 12 bytes each
+//POST: clear the trace
+//the trace can be longer than a String fits, so it is sent in pieces
+void handleTrace() {
+  if (!TRACE_ENABLED) {
+    server.send(404, "text/plain", "ERROR built with TRACE_ENABLED=0");
+    return;
+  }
+
+  TraceRecord records[32];
+  uint32_t end = traceEnd();
+  uint32_t next = traceStart(end);
+  bool binary = server.arg("format") == "bin";
+  //chunked either way, records the motion task writes over while this sends are left out (see TraceRecorder.h)
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  if (binary) {
+    server.send(200, "application/octet-stream", "");
+  }
+  else {
+    server.send(200, "text/csv", "t_us,joint,kind,a,b,c\n");
+  }
+  while (next != end) {
+    int n = traceCopy(records, &next, end, 32);
+    if (n == 0) {continue;}   //an empty chunk would end the response
+    if (binary) {
+      server.sendContent((const char*) records, n * sizeof(TraceRecord));
+      continue;
+    }
+    char csv[32 * 48];
+    int length = 0;
+    for (int j = 0; j < n; j++) {
+      length += traceFormat(&records[j], csv + length, sizeof(csv) - length);
+    }
+    server.sendContent(csv, length);
+  }
+  server.sendContent("");   //end of the chunked response
+}
+
+void handleTraceClear() {
+  traceClear();
+  server.send(200, "text/plain", "OK");
+}
+
+//fleet tempo    "/tempo"
+//GET returns the tempo in BPM
+//POST bpm = MIN_BPM to MAX_BPM sets it for this bot and the dancebots, the moves they are dancing change speed without stopping
+void handleTempo() {
+  if (server.method() == HTTP_POST) {
+    if (!server.hasArg("bpm")) {
+      server.send(400, "text/plain", "ERROR Server did not find bpm argument in HTTP request");
+      return;
+    }
+    setFleetTempo(server.arg("bpm").toInt());
+    transmitMessage.status = SetTempo;
+    transmitToDancebots();
+    transmitMessage.status = None;
+  }
+  server.send(200, "text/plain", String(transmitMessage.tempo));
+}
+
+//the tempo for this bot, the beat beacons and the next messages to the dancebots
+void setFleetTempo(int bpm) {
+  transmitMessage.tempo = constrain(bpm, MIN_BPM, MAX_BPM);
+  dance_bot->setTempo(transmitMessage.tempo);
+  if (dance_bot->getBeatClock() != NULL) {
+    dance_bot->getBeatClock()->setTempo(transmitMessage.tempo);
+  }
+}
+
+//following the music    "/music", see loopMusic()
+//GET returns a CSV line: whether the fleet follows the music, its tempo (BPM), how sure the tracker is of it (%),
+//  frames analysed, their average and worst cost (us) and microphone overruns
+//POST follow = 1 or 0 starts or stops the fleet following the music, the tracker keeps listening either way
+void handleMusic() {
+#if HAS_MICROPHONE
+  if (server.method() == HTTP_POST) {
+    if (!server.hasArg("follow")) {
+      server.send(400, "text/plain", "ERROR Server did not find follow argument in HTTP request");
+      return;
+    }
+    musicFollow = server.arg("follow").toInt() != 0;
+  }
+  char csv[160];
+  snprintf(csv, sizeof(csv), "following,tempo,confidence,frames,frame_us_avg,frame_us_max,overruns\n%d,%.1f,%d,%lu,%lu,%lu,%lu\n",
+           musicFollow, musicTracker.getTempo(), musicTracker.getConfidence(), musicFrames,
+           musicFrames == 0 ? 0 : musicFrameCost / musicFrames, musicMaxCost, microphoneGetOverruns());
+  server.send(200, "text/csv", csv);
+#else
+  server.send(404, "text/plain", "ERROR this dancebot has no microphone");
+#endif
+}
+
+//live tuning    "/tune", see loopTune()
+//GET returns the tuned move as a MoveShape (see MoveAlgebra.h) to paste into DancingServos.cpp,
+//  name = what to call it, and how many changes went out in how many frames
+//POST takes any of:
+//  from = a dance move made from a MoveShape (Walk, Left Stank...), tuning starts from it
+//  bots = all, or Dancebot numbers like 1,3,5, the bots that get the changes
+//  joint = 0 to 3 [hipL, hipR, ankleL, ankleR] with any of amp, off, ph0 (degrees)
+//  period = ms at REFERENCE_BPM
+//  rate = most frames a second, 1 to TUNE_MAX_RATE
+//  start = 1 starts the tuned move on the bots, forever, 0 stops sending them changes (they keep dancing)
+//and returns the same as GET
+void handleTune() {
+  static const char* paramNames[] = {"amp", "off", "ph0"};
+  if (server.method() == HTTP_POST) {
+    if (server.hasArg("from")) {
+      String * danceMoves = dance_bot->getDanceMoves();
+      int move = -1;
+      for (int i = 0; i < dance_bot->getNumDanceMoves(); i++) {
+        if (server.arg("from").equals(danceMoves[i])) {move = i;}
+      }
+      if (move == -1 || !dance_bot->getMoveShape(move, &tuneShape)) {
+        server.send(400, "text/plain", "ERROR " + server.arg("from") + " is not made from a MoveShape");
+        return;
+      }
+      tuneChanged = (1 << (TUNE_PERIOD_BIT + 1)) - 1;
+    }
+    if (server.hasArg("bots")) {
+      String bots = server.arg("bots");
+      tuneBots = 0;
+      if (bots == "all") {
+        tuneBots = ~0ULL;
+      }
+      else {
+        const char* p = bots.c_str();
+        while (*p != '\0') {
+          char* end;
+          long id = strtol(p, &end, 10);
+          if (end == p) {
+            p++;
+            continue;
+          }
+          if (id >= 0 && id < MAX_DANCEBOTS) {tuneBots |= 1ULL << id;}
+          p = end;
+        }
+      }
+    }
+    if (server.hasArg("joint")) {
+      int joint = server.arg("joint").toInt();
+      if (joint < 0 || joint >= NUM_LEG_JOINTS) {
+        server.send(400, "text/plain", "ERROR joint must be 0 to 3");
+        return;
+      }
+      for (int param = TUNE_AMP; param <= TUNE_PH0; param++) {
+        if (server.hasArg(paramNames[param])) {setTuneParam(joint, param, server.arg(paramNames[param]).toInt());}
+      }
+    }
+    if (server.hasArg("period")) {
+      setTuneParam(0, TUNE_PERIOD, server.arg("period").toInt());
+    }
+    if (server.hasArg("rate")) {
+      tuneRate = constrain((int) server.arg("rate").toInt(), 1, TUNE_MAX_RATE);
+    }
+    if (server.hasArg("start")) {
+      tuning = server.arg("start") != "0";
+      tuneStart = tuning;
+    }
+  }
+
+  //the period in beats when it is a whole number of them, like the moves in DancingServos.cpp
+  const MoveShape& m = tuneShape;
+  String name = server.hasArg("name") ? server.arg("name") : String("tunedShape");
+  int beat = BEATS(1);
+  String period = m.period % beat == 0 ? "BEATS(" + String(m.period / beat) + ")" : String(m.period);
+  char shape[160];
+  snprintf(shape, sizeof(shape), "{{%d, %d, %d, %d}, {%d, %d, %d, %d}, {%ld, %ld, %ld, %ld}, %s}",
+           m.amp[0], m.amp[1], m.amp[2], m.amp[3], m.off[0], m.off[1], m.off[2], m.off[3],
+           lround(m.ph0[0]), lround(m.ph0[1]), lround(m.ph0[2]), lround(m.ph0[3]), period.c_str());
+  server.send(200, "text/plain", "static constexpr MoveShape " + name + " = " + String(shape) + ";\n" +
+                                 "//" + String(tuneChanges) + " changes sent in " + String(tuneFrames) + " frames\n");
+}
+
+void handleNotFound() {
+  String message = "File Not Found\n\n";
+  message += "URI: " + server.uri() + "\n";
+  message += "Method: " + String((server.method() == HTTP_GET)?"GET":"POST") + "\n";
+  message += "Arguments: " + String(server.args()) + "\n";
+  for (uint8_t i=0; i<server.args(); i++){
+    message += " " + server.argName(i) + ": " + server.arg(i) + "\n";
+  }
+  server.send(404, "text/plain", message);
+}
+
+void handleUnknownMove() {
+  String message = "Dance move not recognized \nERROR too lit for this robot\n\n";
+  server.send(404, "text/plain", message);
+}
+
+
+
+/* HTML */
+String indexHTML() {
+  String button_css = "width:100%; margin-bottom:1em; padding: 1em; font-family:'Arial';font-size:medium;color:#1d1f21; background-color:#8abeb7;border-color:#5e8d87;";
+  String * danceMoves = dance_bot->getDanceMoves();
+  String * danceRoutines = dance_bot->getDanceRoutines();
+  
+  String htmlPage = String("<head>") +
+              "<meta name=\"viewport\" content=\"width=device-width, initial-scale=1.0\" />" + 
+            "</head>" +
+            
+            "<body style=\"width:auto; font-family:'Arial'; background-color:#1d1f21; color:#c5c8c6;\">" +
+              //Header
+              "<div id=\"page_header\" style=\"margin: 0 5% 2em 5%; color:#cc6666;\">" +
+                "<h1>Demobots Dancing Robot</h1>" +
+              "</div>" +
+
+              //Dance Moves
+              "<div id=\"page_dances\" style=\"margin: 0 5% 2em 5%;\">" +
+                "<h3 style=\"color:#81a2be;\">Dance Moves</h3>" +
+                
+                "<div id=\"dance_moves\" style=\"\">" +             
+                  "<div style=\"padding-left: 1.5em; font-size:medium;\">" +
+                    "<p id=\"current_move\">Current Move: " + danceMoves[0] + "</p>" +
+                    "<p><label><input type=\"checkbox\" id=\"queue_moves\"> Queue moves (play after the current move)</label></p>" +
+                  "</div>" +
+  
+                  "<div id=\"dance_move_buttons\" style=\"padding-left: 1.5em; \">";
+                    for (int i = 0; i < dance_bot->getNumDanceMoves(); i++) {
+                      htmlPage += "<button onclick=\"postDancemove('" + danceMoves[i] + "')\" style=\"" + button_css + "\">" + danceMoves[i] + "</button>";
+                    }
+  htmlPage += String("</div>") +
+                "</div>" +
+              "</div>" +
+
+              //Tempo
+              "<div id=\"page_tempo\" style=\"margin: 0 5% 2em 5%;\">" +
+                "<h3 style=\"color:#81a2be;\">Tempo</h3>" +
+                "<div style=\"padding-left: 1.5em; font-size:medium;\">" +
+                  "<p id=\"tempo_status\">Tempo: " + String(transmitMessage.tempo) + " BPM</p>" +
+                  "<input id=\"tempo_bpm\" type=\"number\" min=\"" + String(MIN_BPM) + "\" max=\"" + String(MAX_BPM) + "\" value=\"" + String(transmitMessage.tempo) + "\" style=\"width:100%; margin-bottom:1em;\">" +
+                  "<button onclick=\"postTempo()\" style=\"" + button_css + "\">Set Tempo</button>" +
+                "</div>" +
+              "</div>" +
+
+              //Live Tuning
+              "<div id=\"page_tune\" style=\"margin: 0 5% 2em 5%;\">" +
+                "<h3 style=\"color:#81a2be;\">Tune a Move</h3>" +
+                "<div style=\"padding-left: 1.5em; font-size:medium;\">" +
+                  "<p>Start from a move and pick the dancebots: all, or numbers like 1,3,5</p>" +
+                  "<input id=\"tune_from\" value=\"Walk\" style=\"width:100%; margin-bottom:1em;\">" +
+                  "<input id=\"tune_bots\" value=\"all\" style=\"width:100%; margin-bottom:1em;\">" +
+                  "<button onclick=\"postTuneStart()\" style=\"" + button_css + "\">Start Tuning</button>" +
+                  "<div id=\"tune_sliders\">";
+                  {
+                    static const char* jointNames[] = {"hipL", "hipR", "ankleL", "ankleR"};
+                    static const char* params[] = {"amp", "off", "ph0"};
+                    static const char* ranges[] = {"min=\"-90\" max=\"90\"", "min=\"-45\" max=\"45\"", "min=\"-180\" max=\"180\" step=\"5\""};
+                    for (int j = 0; j < NUM_LEG_JOINTS; j++) {
+                      for (int p = 0; p < 3; p++) {
+                        String id = "tune_" + String(j) + "_" + String(p);
+                        htmlPage += "<p>" + String(jointNames[j]) + " " + params[p] + " <span id=\"" + id + "_value\"></span></p>" +
+                                    "<input id=\"" + id + "\" type=\"range\" " + ranges[p] + " style=\"width:100%;\" " +
+                                    "oninput=\"postTune('joint=" + String(j) + "&" + params[p] + "=', this)\">";
+                      }
+                    }
+                  }
+  htmlPage += String("<p>period (ms) <span id=\"tune_period_value\"></span></p>") +
+                  "<input id=\"tune_period\" type=\"range\" min=\"200\" max=\"4000\" step=\"50\" style=\"width:100%;\" oninput=\"postTune('period=', this)\">" +
+                  "</div>" +
+                  "<pre id=\"tune_shape\" style=\"white-space:pre-wrap;\"></pre>" +
+                "</div>" +
+              "</div>" +
+
+              //Dance Routines
+              "<div id=\"page_routines\" style=\"margin: 0 5% 2em 5%;\">" +
+                "<h3 style=\"color:#81a2be;\">Dances</h3>" +
+
+                "<div id=\"dance_routines\" style=\"\">" +             
+                  "<div style=\"padding-left: 1.5em; font-size:medium;\">" +
+                    "<p id=\"current_routine\">Current Dance: None</p>" +
+                  "</div>" +
+                  "<div id=\"dance_routine_buttons\" style=\"padding-left: 1.5em; \">";
+                  for (int i = 0; i < dance_bot->getNumDanceRoutines(); i++) {
+                      htmlPage += "<button onclick=\"postDanceRoutine('" + danceRoutines[i] + "')\" style=\"" + button_css + "\">" + danceRoutines[i] + "</button>";
+                    }
+  htmlPage += String("</div>") +
+                "</div>" + 
+                
+              "</div>" +
+
+              //Servo Trims
+              "<div id=\"page_trims\" style=\"margin: 0 5% 2em 5%;\">" +
+                "<h3 style=\"color:#81a2be;\">Calibrate</h3>" +
+                "<div style=\"padding-left: 1.5em; font-size:medium;\">" +
+                  "<p>Dancebot number (-1 = this bot) and trims: hipL,hipR,ankleL,ankleR</p>" +
+                  "<input id=\"trim_bot\" type=\"number\" value=\"-1\" style=\"width:100%; margin-bottom:1em;\">" +
+                  "<input id=\"trim_values\" value=\"" + getTrimsString() + "\" style=\"width:100%; margin-bottom:1em;\">" +
+                  "<button onclick=\"postTrims()\" style=\"" + button_css + "\">Set Trims</button>" +
+                  "<p id=\"trim_status\"></p>" +
+                "</div>" +
+              "</div>" +
+
+              //Upload Dance Routine
+              "<div id=\"page_upload\" style=\"margin: 0 5% 2em 5%;\">" +
+                "<h3 style=\"color:#81a2be;\">Upload Dance</h3>" +
+                "<div style=\"padding-left: 1.5em; font-size:medium;\">" +
+                  "<p>Steps are dance move, arg, cycles: Walk,1500,2;Hop,25,1</p>" +
+                  "<input id=\"routine_name\" placeholder=\"Name\" style=\"width:100%; margin-bottom:1em;\">" +
+                  "<input id=\"routine_steps\" placeholder=\"Steps\" style=\"width:100%; margin-bottom:1em;\">" +
+                  "<button onclick=\"postRoutine()\" style=\"" + button_css + "\">Upload</button>" +
+                  "<p id=\"upload_status\"></p>" +
+                "</div>" +
+              "</div>" +
+              
+              getJavascript() +
+            "</body>";
+  return htmlPage;
+}
+
+
+
+/* JAVASCRIPT */
+
+String getJavascript() {
+  String s = String("<script>") +
+      "function updateCurrentMove(move) {" +
+        "document.getElementById('current_move').innerText = 'Current Move: ' + move; " +
+      "}" +
+
+      "function updateCurrentRoutiune(routine) {" +
+        "document.getElementById('current_routine').innerText = 'Current Dance: ' + routine; " +
+      "}" +
+      
+      //function to HTTP Post
+      "function postDancemove(move) {" +
+        "var xhttp = new XMLHttpRequest(); " +
+        "xhttp.open('POST', '/danceM', true);" +
+        "xhttp.setRequestHeader('Content-type', 'application/x-www-form-urlencoded');" +
+        "var queue = document.getElementById('queue_moves').checked ? 1 : 0;" +
+        "xhttp.send('dance_move=' + move + '&queue=' + queue);" +
+
+        "xhttp.onload = function() { " +
+          "console.log('Move Received: ' + xhttp.responseText); " +
+          "updateCurrentMove(xhttp.responseText)" +
+        "}" +
+      "}" +
+      
+      "function postDanceRoutine(routine) {" +
+        "var xhttp = new XMLHttpRequest(); " +
+        "xhttp.open('POST', '/dance', true);" +
+        "xhttp.setRequestHeader('Content-type', 'application/x-www-form-urlencoded');" +
+        "xhttp.send('dance_routine=' + routine);" +
+
+        "xhttp.onload = function() { " +
+          "console.log('Dance Received: ' + xhttp.responseText); " +
+          "updateCurrentRoutiune(xhttp.responseText)" +
+        "}" +
+      "}" +
+
+      "function postTempo() {" +
+        "var xhttp = new XMLHttpRequest(); " +
+        "xhttp.open('POST', '/tempo', true);" +
+        "xhttp.setRequestHeader('Content-type', 'application/x-www-form-urlencoded');" +
+        "xhttp.send('bpm=' + document.getElementById('tempo_bpm').value);" +
+
+        "xhttp.onload = function() { " +
+          "document.getElementById('tempo_status').innerText = 'Tempo: ' + xhttp.responseText + ' BPM'; " +
+        "}" +
+      "}" +
+
+      "function postTrims() {" +
+        "var xhttp = new XMLHttpRequest(); " +
+        "xhttp.open('POST', '/trim', true);" +
+        "xhttp.setRequestHeader('Content-type', 'application/x-www-form-urlencoded');" +
+        "var bot = document.getElementById('trim_bot').value;" +
+        "var trims = document.getElementById('trim_values').value;" +
+        "xhttp.send('bot=' + bot + '&trims=' + trims);" +
+
+        "xhttp.onload = function() { " +
+          "document.getElementById('trim_status').innerText = 'Trims: ' + xhttp.responseText; " +
+        "}" +
+      "}" +
+
+      "function postRoutine() {" +
+        "var xhttp = new XMLHttpRequest(); " +
+        "xhttp.open('POST', '/routine', true);" +
+        "xhttp.setRequestHeader('Content-type', 'application/x-www-form-urlencoded');" +
+        "var name = encodeURIComponent(document.getElementById('routine_name').value);" +
+        "var steps = encodeURIComponent(document.getElementById('routine_steps').value);" +
+        "xhttp.send('name=' + name + '&steps=' + steps);" +
+
+        "xhttp.onload = function() { " +
+          "document.getElementById('upload_status').innerText = 'Uploaded: ' + xhttp.responseText; " +
+        "}" +
+      "}" +
+
+      //the sliders follow the tuned move the mothership sends back, its numbers are amp, off, ph0 for each joint, then the period
+      "function showTune(text) {" +
+        "document.getElementById('tune_shape').innerText = text;" +
+        "var shape = text.split(';')[0];" +
+        "var n = shape.substring(shape.indexOf('{')).match(/-?\\d+/g);" +
+        "if (!n || n.length < 13) { return; }" +
+        "for (var p = 0; p < 3; p++) { for (var j = 0; j < 4; j++) {" +
+          "document.getElementById('tune_' + j + '_' + p).value = n[p * 4 + j];" +
+          "document.getElementById('tune_' + j + '_' + p + '_value').innerText = n[p * 4 + j];" +
+        "} }" +
+        "if (shape.indexOf('BEATS(') == -1) { document.getElementById('tune_period').value = n[12]; }" +
+        "else { document.getElementById('tune_period').value = n[12] * " + String(BEATS(1)) + "; }" +
+        "document.getElementById('tune_period_value').innerText = document.getElementById('tune_period').value;" +
+      "}" +
+
+      "function postTuneStart() {" +
+        "var xhttp = new XMLHttpRequest(); " +
+        "xhttp.open('POST', '/tune', true);" +
+        "xhttp.setRequestHeader('Content-type', 'application/x-www-form-urlencoded');" +
+        "var from = encodeURIComponent(document.getElementById('tune_from').value);" +
+        "var bots = encodeURIComponent(document.getElementById('tune_bots').value);" +
+        "xhttp.send('from=' + from + '&bots=' + bots + '&start=1');" +
+        "xhttp.onload = function() { showTune(xhttp.responseText); }" +
+      "}" +
+
+      //every slider move is posted, the mothership merges them into at most its rate of frames to the bots
+      "function postTune(arg, slider) {" +
+        "document.getElementById(slider.id + '_value').innerText = slider.value;" +
+        "var xhttp = new XMLHttpRequest(); " +
+        "xhttp.open('POST', '/tune', true);" +
+        "xhttp.setRequestHeader('Content-type', 'application/x-www-form-urlencoded');" +
+        "xhttp.send(arg + slider.value);" +
+        "xhttp.onload = function() { document.getElementById('tune_shape').innerText = xhttp.responseText; }" +
+      "}" +
+
+  "</script>";
+  return s;
+}
+
+#endif
@@ -0,0 +1,27 @@
+/* WebController.h
+ * UT Austin RAS Demobots
+ * Mothership only: web page for picking dance moves, sends them to the other dancebots over ESP-NOW
+ */
+
+#ifndef WEBCONTROLLER
+#define WEBCONTROLLER
+
+#include "HardwareProfile.h"
+#include "DancingServos.h"
+#include "RoutineStore.h"
+#include "TrimStore.h"
+#include "Messages.h"
+
+int setupESPNOW();
+void setupWiFi(String mode, const char * _ssid, const char * _pass);
+void setupWebServer(DancingServos* _bot, RoutineStore* _routineStore, TrimStore* _trimStore);
+void loopWebServer();
+void loopFleet();         //call each loop(), lets bots join and drops the ones that left
+void printSendStats(Print* out);    //ESP-NOW sends and how many weren't delivered, since resetSendStats()
+void resetSendStats();
+#if HAS_MICROPHONE
+bool setupMusic();        //false if the microphone didn't start
+void loopMusic();         //call every few ms, before the microphone's DMA buffers fill (see Microphone.h)
+#endif
+
+#endif
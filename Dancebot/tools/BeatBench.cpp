@@ -0,0 +1,295 @@
+/* BeatBench.cpp
+ * UT Austin RAS Demobots
+ * Runs the mothership's beat tracker (src/BeatTracker.cpp) on a PC against music with labeled beats,
+ * and prints how well it found them and what each frame of analysis cost.
+ *
+ * Build from the Dancebot folder:
+ *    g++ -std=gnu++11 -O2 tools/BeatBench.cpp -o beatbench
+ *
+ *    ./beatbench song.wav song.txt [more.wav more.txt ...]
+ *    ./beatbench --synth 100         a click track at 100 BPM over noise, 30 s
+ *    ./beatbench --test              the firmware's beatTrackerTest()
+ *
+ * WAV files are 16 bit PCM, mono or stereo at any rate, they are mixed to mono and resampled to BEAT_SAMPLE_RATE.
+ * Beat files have the time of one beat in seconds on each line (e.g. a Sonic Visualiser or madmom export),
+ * anything after the number and lines that don't start with one are skipped.
+ *
+ * The samples go in BENCH_CHUNK at a time like the mothership's loopMusic(), each beat is counted when the tracker
+ * first puts its latest beat past it. A beat is found if it is within BENCH_TOLERANCE_S of a labeled one (the usual
+ * 70 ms), the first BENCH_SKIP_S seconds are left out of the score while the tracker fills its history.
+ * The tempo is right if it is within 4% of the labeled one, from the median time between labeled beats.
+ * The cost is this PC's, the mothership's own is on its "/music" page.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+#include <vector>
+
+#define BEAT_TRACKER_HOST
+#include "../src/BeatTracker.cpp"
+
+#define BENCH_CHUNK 160             //samples per addSamples(), 10 ms
+#define BENCH_TOLERANCE_S 0.07
+#define BENCH_SKIP_S 5.0
+#define SYNTH_SECONDS 30
+
+typedef struct BenchResult {
+  double labeledBpm;
+  double bpm;
+  int confidence;
+  int found;                //estimated beats within the tolerance of a labeled beat
+  int estimated;
+  int labeled;
+  double frameUs;           //average cost of a frame
+  double maxFrameUs;        //worst chunk, per frame in it
+  double seconds;           //of audio
+} BenchResult;
+
+static double nowUs() {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1e6 + t.tv_nsec / 1e3;
+}
+
+static uint32_t readLE(const uint8_t* p, int bytes) {
+  uint32_t value = 0;
+  for (int i = bytes - 1; i >= 0; i--) {
+    value = value << 8 | p[i];
+  }
+  return value;
+}
+
+//16 bit PCM to mono at BEAT_SAMPLE_RATE, straight lines between the samples
+static bool readWav(const char* path, std::vector<int16_t>* out) {
+  FILE* f = fopen(path, "rb");
+  if (f == NULL) {
+    fprintf(stderr, "Can't open %s\n", path);
+    return false;
+  }
+  std::vector<uint8_t> data;
+  uint8_t buf[65536];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+    data.insert(data.end(), buf, buf + n);
+  }
+  fclose(f);
+  if (data.size() < 12 || memcmp(&data[0], "RIFF", 4) != 0 || memcmp(&data[8], "WAVE", 4) != 0) {
+    fprintf(stderr, "%s is not a WAV file\n", path);
+    return false;
+  }
+
+  int channels = 0;
+  int rate = 0;
+  const uint8_t* pcm = NULL;
+  size_t pcmBytes = 0;
+  for (size_t pos = 12; pos + 8 <= data.size();) {
+    uint32_t size = readLE(&data[pos + 4], 4);
+    const uint8_t* chunk = &data[pos + 8];
+    size_t available = std::min((size_t) size, data.size() - pos - 8);
+    if (memcmp(&data[pos], "fmt ", 4) == 0 && available >= 16) {
+      if (readLE(chunk, 2) != 1 || readLE(chunk + 14, 2) != 16) {
+        fprintf(stderr, "%s is not 16 bit PCM\n", path);
+        return false;
+      }
+      channels = readLE(chunk + 2, 2);
+      rate = readLE(chunk + 4, 4);
+    }
+    else if (memcmp(&data[pos], "data", 4) == 0) {
+      pcm = chunk;
+      pcmBytes = available;
+    }
+    pos += 8 + size + (size & 1);
+  }
+  if (channels < 1 || rate <= 0 || pcm == NULL) {
+    fprintf(stderr, "%s has no fmt or data chunk\n", path);
+    return false;
+  }
+
+  size_t frames = pcmBytes / (2 * channels);
+  std::vector<float> mono(frames);
+  for (size_t i = 0; i < frames; i++) {
+    float sum = 0;
+    for (int c = 0; c < channels; c++) {
+      sum += (int16_t) readLE(pcm + (i * channels + c) * 2, 2);
+    }
+    mono[i] = sum / channels;
+  }
+  out->clear();
+  for (double t = 0; t < frames - 1; t += (double) rate / BEAT_SAMPLE_RATE) {
+    size_t i = (size_t) t;
+    double x = mono[i] + (t - i) * (mono[i + 1] - mono[i]);
+    out->push_back((int16_t) std::max(-32768.0, std::min(32767.0, x)));
+  }
+  return true;
+}
+
+static bool readBeats(const char* path, std::vector<double>* beats) {
+  FILE* f = fopen(path, "r");
+  if (f == NULL) {
+    fprintf(stderr, "Can't open %s\n", path);
+    return false;
+  }
+  char line[256];
+  while (fgets(line, sizeof(line), f) != NULL) {
+    char* end;
+    double t = strtod(line, &end);
+    if (end != line) {
+      beats->push_back(t);
+    }
+  }
+  fclose(f);
+  std::sort(beats->begin(), beats->end());
+  return true;
+}
+
+//clicks of decaying noise on every beat over quieter noise, like beatTrackerTest() but longer and at any tempo
+static void synthClicks(double bpm, std::vector<int16_t>* samples, std::vector<double>* beats) {
+  uint32_t random = 1;
+  double period = 60.0 * BEAT_SAMPLE_RATE / bpm;
+  for (int i = 0; i < SYNTH_SECONDS * BEAT_SAMPLE_RATE; i++) {
+    random = random * 1103515245 + 12345;
+    int noise = (int) ((random >> 16) & 0x3FF) - 512;
+    double sinceClick = fmod(i, period);
+    int click = sinceClick < 320 ? (int) (noise * 24 * (320 - sinceClick) / 320) : 0;
+    samples->push_back((int16_t) (noise / 8 + click));
+  }
+  for (double t = 0; t < SYNTH_SECONDS; t += 60 / bpm) {
+    beats->push_back(t);
+  }
+}
+
+static BenchResult run(const std::vector<int16_t>& samples, const std::vector<double>& labeled) {
+  static BeatTracker tracker;
+  tracker.reset();
+  BenchResult r;
+  memset(&r, 0, sizeof(r));
+  r.seconds = (double) samples.size() / BEAT_SAMPLE_RATE;
+
+  std::vector<double> estimated;
+  double costSum = 0;
+  int64_t lastBeat = -1;
+  for (size_t i = 0; i < samples.size(); i += BENCH_CHUNK) {
+    int count = (int) std::min((size_t) BENCH_CHUNK, samples.size() - i);
+    unsigned long frames = tracker.getFrameCount();
+    double start = nowUs();
+    tracker.addSamples(&samples[i], count);
+    double cost = nowUs() - start;
+    frames = tracker.getFrameCount() - frames;
+    if (frames > 0) {
+      costSum += cost;
+      r.maxFrameUs = std::max(r.maxFrameUs, cost / frames);
+    }
+
+    int64_t beat = tracker.getLastBeat();
+    if (beat >= 0 && (lastBeat < 0 || beat - lastBeat > tracker.getBeatPeriod() / 2)) {
+      estimated.push_back((double) beat / BEAT_SAMPLE_RATE);
+      lastBeat = beat;
+    }
+  }
+  r.frameUs = tracker.getFrameCount() == 0 ? 0 : costSum / tracker.getFrameCount();
+  r.bpm = tracker.getTempo();
+  r.confidence = tracker.getConfidence();
+
+  //each labeled beat matches at most one estimated beat, both are in order
+  std::vector<double> scored;
+  for (size_t i = 0; i < labeled.size(); i++) {
+    if (labeled[i] >= BENCH_SKIP_S) {scored.push_back(labeled[i]);}
+  }
+  size_t j = 0;
+  for (size_t i = 0; i < estimated.size(); i++) {
+    if (estimated[i] < BENCH_SKIP_S) {
+      continue;
+    }
+    r.estimated++;
+    while (j < scored.size() && scored[j] < estimated[i] - BENCH_TOLERANCE_S) {j++;}
+    if (j < scored.size() && fabs(scored[j] - estimated[i]) <= BENCH_TOLERANCE_S) {
+      r.found++;
+      j++;
+    }
+  }
+  r.labeled = scored.size();
+
+  std::vector<double> intervals;
+  for (size_t i = 1; i < labeled.size(); i++) {
+    intervals.push_back(labeled[i] - labeled[i - 1]);
+  }
+  if (!intervals.empty()) {
+    std::sort(intervals.begin(), intervals.end());
+    r.labeledBpm = 60 / intervals[intervals.size() / 2];
+  }
+  return r;
+}
+
+static double fMeasure(int found, int estimated, int labeled) {
+  return estimated + labeled == 0 ? 0 : 2.0 * found / (estimated + labeled);
+}
+
+static bool tempoRight(const BenchResult& r) {
+  return r.labeledBpm > 0 && fabs(r.bpm / r.labeledBpm - 1) < 0.04;
+}
+
+static void print(const char* name, const BenchResult& r) {
+  printf("%-32s %7.1f %7.1f %4d%%  %-5s %5.3f %6d %6d %8.1f %8.1f %7.0fx\n", name, r.labeledBpm, r.bpm, r.confidence,
+         tempoRight(r) ? "yes" : "no", fMeasure(r.found, r.estimated, r.labeled), r.estimated, r.labeled, r.frameUs,
+         r.maxFrameUs, r.frameUs > 0 ? 1e6 / BEAT_FRAME_RATE / r.frameUs : 0);
+}
+
+int main(int argc, char** argv) {
+  if (argc >= 2 && strcmp(argv[1], "--test") == 0) {
+    return beatTrackerTest() ? 0 : 1;
+  }
+  if (argc < 3 || (strcmp(argv[1], "--synth") != 0 && argc % 2 != 1)) {
+    fprintf(stderr, "usage: beatbench song.wav song.txt [more.wav more.txt ...]\n"
+                    "       beatbench --synth BPM\n"
+                    "       beatbench --test\n");
+    return 2;
+  }
+
+  printf("%-32s %7s %7s %5s  %-5s %5s %6s %6s %8s %8s %8s\n", "file", "label", "bpm", "conf", "tempo", "F",
+         "beats", "label", "frame_us", "max_us", "realtime");
+  if (strcmp(argv[1], "--synth") == 0) {
+    std::vector<int16_t> samples;
+    std::vector<double> beats;
+    synthClicks(atof(argv[2]), &samples, &beats);
+    BenchResult r = run(samples, beats);
+    print("clicks", r);
+    return tempoRight(r) ? 0 : 1;
+  }
+
+  int files = 0;
+  int tempos = 0;
+  int found = 0;
+  int estimated = 0;
+  int labeled = 0;
+  double cost = 0;
+  double seconds = 0;
+  double maxCost = 0;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::vector<int16_t> samples;
+    std::vector<double> beats;
+    if (!readWav(argv[i], &samples) || !readBeats(argv[i + 1], &beats)) {
+      continue;
+    }
+    BenchResult r = run(samples, beats);
+    print(argv[i], r);
+    files++;
+    if (tempoRight(r)) {tempos++;}
+    found += r.found;
+    estimated += r.estimated;
+    labeled += r.labeled;
+    cost += r.frameUs * r.seconds;
+    seconds += r.seconds;
+    maxCost = std::max(maxCost, r.maxFrameUs);
+  }
+  if (files == 0) {
+    return 1;
+  }
+  printf("\n%d files, %.0f s: tempo right in %d, F-measure %.3f, frame %.1f us average, %.1f us worst\n", files, seconds,
+         tempos, fMeasure(found, estimated, labeled), seconds > 0 ? cost / seconds : 0, maxCost);
+  return 0;
+}
@@ -0,0 +1,268 @@
+/* TracePlot.cpp
+ * UT Austin RAS Demobots
+ * Draws a servo trace from the firmware (see src/TraceRecorder.h) as an SVG, one panel for each joint
+ * with the commanded positions and the ideal sinusoid of each move over them,
+ * and prints how far the commanded positions were from the ideal.
+ *
+ * Build from the Dancebot folder:
+ *    g++ -std=gnu++11 -O2 tools/TracePlot.cpp -o traceplot
+ *
+ * Get a trace from a dancebot's Serial (send 't') or the mothership's "/trace" page, then:
+ *    ./traceplot trace.csv > trace.svg
+ *
+ * Lines that aren't trace records are skipped, so a whole Serial log works too.
+ * Moves written as foot turns and lifts (see src/Kinematics.h) have no ideal curve, their sinusoids aren't in servo degrees.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#define MAX_JOINTS 16      //see NUM_JOINTS in src/HardwareProfile.h
+#define PLOT_WIDTH 1000
+#define PANEL_HEIGHT 180
+#define MARGIN 50
+#define IDEAL_STEPS 2000    //points in each panel's ideal curve
+
+static const char* jointNames[] = {"hipL", "hipR", "ankleL", "ankleR", "hat"};
+
+static const char* jointName(int joint) {
+  static char name[16];
+  if (joint < (int) (sizeof(jointNames) / sizeof(jointNames[0]))) {
+    return jointNames[joint];
+  }
+  snprintf(name, sizeof(name), "joint%d", joint);
+  return name;
+}
+
+typedef struct Sample {
+  double t;       //s
+  int pos;
+  int trim;
+} Sample;
+
+//one move's sinusoid, from its wave record to the next wave or stop record
+typedef struct Wave {
+  double start;   //when it was set (s)
+  double t0;      //its first sample (s)
+  double end;
+  int amp;
+  int off;
+  int period;     //ms
+  double phase;   //radians at t0
+} Wave;
+
+typedef struct Joint {
+  std::vector<Sample> samples;
+  std::vector<Wave> waves;
+  bool open;      //the last wave hasn't ended yet
+} Joint;
+
+static Joint joints[MAX_JOINTS];
+
+//the wave sample s came from, NULL = none
+static const Wave* findWave(const Joint* joint, double t) {
+  for (size_t i = 0; i < joint->waves.size(); i++) {
+    const Wave* w = &joint->waves[i];
+    if (t >= w->t0 && t < w->end) {
+      return w;
+    }
+  }
+  return NULL;
+}
+
+static double ideal(const Wave* w, double t) {
+  return w->amp * sin(w->phase + 2 * M_PI * (t - w->t0) * 1000 / w->period) + w->off;
+}
+
+//read the CSV, returns the end of the trace (s)
+static double readTrace(FILE* in) {
+  char line[256];
+  uint64_t wraps = 0;
+  uint32_t last = 0;
+  bool first = true;
+  double t = 0;
+  while (fgets(line, sizeof(line), in) != NULL) {
+    unsigned long us;
+    unsigned int joint;
+    char kind[8];
+    int a, b, c;
+    if (sscanf(line, "%lu,%u,%7[a-z],%d,%d,%d", &us, &joint, kind, &a, &b, &c) != 6 || joint >= MAX_JOINTS) {
+      continue;
+    }
+
+    //micros() wraps every 71 minutes
+    if (!first && (uint32_t) us < last) {wraps += 1ULL << 32;}
+    last = us;
+    first = false;
+    t = (wraps + (uint32_t) us) / 1e6;
+
+    Joint* j = &joints[joint];
+    if (strcmp(kind, "pos") == 0) {
+      Sample s = {t, a, b};
+      j->samples.push_back(s);
+      //the first sample of a new wave
+      if (j->open && j->waves.back().t0 < 0) {j->waves.back().t0 = t;}
+    }
+    else if (strcmp(kind, "wave") == 0) {
+      if (j->open) {j->waves.back().end = t;}
+      Wave w = {t, -1, INFINITY, a, b, c, 0};
+      j->waves.push_back(w);
+      j->open = c > 0;
+      if (!j->open) {j->waves.pop_back();}
+    }
+    else if (strcmp(kind, "phase") == 0) {
+      if (j->open) {j->waves.back().phase = a * M_PI / 1800;}
+      //a task space wave, not in servo degrees
+      if (j->open && b != 0) {
+        j->waves.pop_back();
+        j->open = false;
+      }
+    }
+    else if (strcmp(kind, "stop") == 0) {
+      if (j->open) {j->waves.back().end = t;}
+      j->open = false;
+    }
+  }
+  for (int i = 0; i < MAX_JOINTS; i++) {
+    if (joints[i].open && joints[i].waves.back().t0 < 0) {joints[i].waves.pop_back();}
+    if (joints[i].open) {joints[i].waves.back().end = t;}
+  }
+  return t;
+}
+
+static void plot(FILE* out, double tMin, double tMax) {
+  int numPanels = 0;
+  for (int i = 0; i < MAX_JOINTS; i++) {
+    if (!joints[i].samples.empty()) {numPanels++;}
+  }
+  int height = numPanels * PANEL_HEIGHT + MARGIN;
+  double span = tMax > tMin ? tMax - tMin : 1;
+  double plotWidth = PLOT_WIDTH - 2 * MARGIN;
+
+  fprintf(out, "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"%d\" height=\"%d\" font-family=\"Arial\" font-size=\"12\">\n", PLOT_WIDTH, height);
+  fprintf(out, "<rect width=\"100%%\" height=\"100%%\" fill=\"white\"/>\n");
+
+  int panel = 0;
+  for (int i = 0; i < MAX_JOINTS; i++) {
+    Joint* j = &joints[i];
+    if (j->samples.empty()) {
+      continue;
+    }
+
+    //y range covers the samples and the ideal curves
+    double yMin = j->samples[0].pos, yMax = yMin;
+    for (size_t k = 0; k < j->samples.size(); k++) {
+      yMin = fmin(yMin, j->samples[k].pos);
+      yMax = fmax(yMax, j->samples[k].pos);
+    }
+    for (size_t k = 0; k < j->waves.size(); k++) {
+      yMin = fmin(yMin, j->waves[k].off - fabs(j->waves[k].amp));
+      yMax = fmax(yMax, j->waves[k].off + fabs(j->waves[k].amp));
+    }
+    yMin -= 5;
+    yMax += 5;
+
+    double top = MARGIN / 2 + panel * PANEL_HEIGHT;
+    double panelHeight = PANEL_HEIGHT - 30;
+    #define X(t) (MARGIN + ((t) - tMin) / span * plotWidth)
+    #define Y(y) (top + (yMax - (y)) / (yMax - yMin) * panelHeight)
+
+    fprintf(out, "<rect x=\"%d\" y=\"%.1f\" width=\"%.1f\" height=\"%.1f\" fill=\"none\" stroke=\"#999\"/>\n", MARGIN, top, plotWidth, panelHeight);
+    fprintf(out, "<text x=\"%d\" y=\"%.1f\">%s (trim %d)</text>\n", MARGIN + 4, top + 14, jointName(i), j->samples.back().trim);
+    fprintf(out, "<text x=\"%d\" y=\"%.1f\" text-anchor=\"end\">%.0f</text>\n", MARGIN - 4, top + 10, yMax);
+    fprintf(out, "<text x=\"%d\" y=\"%.1f\" text-anchor=\"end\">%.0f</text>\n", MARGIN - 4, top + panelHeight, yMin);
+    if (yMin < 0 && yMax > 0) {
+      fprintf(out, "<line x1=\"%d\" y1=\"%.1f\" x2=\"%.1f\" y2=\"%.1f\" stroke=\"#ddd\"/>\n", MARGIN, Y(0), MARGIN + plotWidth, Y(0));
+    }
+
+    //time axis, a tick every 1, 2 or 5 times a power of 10 seconds
+    double step = pow(10, floor(log10(span / 5)));
+    if (span / step > 25) {step *= 5;}
+    else if (span / step > 10) {step *= 2;}
+    for (double t = ceil(tMin / step) * step; t <= tMax; t += step) {
+      fprintf(out, "<text x=\"%.1f\" y=\"%.1f\" text-anchor=\"middle\" fill=\"#666\">%g</text>\n", X(t), top + panelHeight + 14, t);
+    }
+
+    //ideal sinusoids, dashed
+    for (size_t k = 0; k < j->waves.size(); k++) {
+      const Wave* w = &j->waves[k];
+      int steps = (int) ((w->end - w->t0) / span * IDEAL_STEPS) + 2;
+      fprintf(out, "<polyline fill=\"none\" stroke=\"#e08000\" stroke-dasharray=\"4,3\" points=\"");
+      for (int s = 0; s <= steps; s++) {
+        double t = w->t0 + (w->end - w->t0) * s / steps;
+        fprintf(out, "%.1f,%.1f ", X(t), Y(ideal(w, t)));
+      }
+      fprintf(out, "\"/>\n");
+    }
+
+    //commanded positions, held until the next one
+    fprintf(out, "<polyline fill=\"none\" stroke=\"#2060c0\" points=\"");
+    for (size_t k = 0; k < j->samples.size(); k++) {
+      const Sample* s = &j->samples[k];
+      double next = k + 1 < j->samples.size() ? j->samples[k + 1].t : tMax;
+      fprintf(out, "%.1f,%.1f %.1f,%.1f ", X(s->t), Y(s->pos), X(next), Y(s->pos));
+    }
+    fprintf(out, "\"/>\n");
+    #undef X
+    #undef Y
+    panel++;
+  }
+
+  fprintf(out, "<text x=\"%d\" y=\"%d\"><tspan fill=\"#2060c0\">commanded</tspan>  <tspan fill=\"#e08000\">ideal</tspan>  (degrees before trim, seconds)</text>\n",
+          MARGIN, height - 8);
+  fprintf(out, "</svg>\n");
+}
+
+//how far each joint's samples were from the ideal
+static void report(FILE* out) {
+  fprintf(out, "joint,samples,compared,rms_deg,max_deg\n");
+  for (int i = 0; i < MAX_JOINTS; i++) {
+    Joint* j = &joints[i];
+    if (j->samples.empty()) {
+      continue;
+    }
+    double squares = 0, worst = 0;
+    int compared = 0;
+    for (size_t k = 0; k < j->samples.size(); k++) {
+      const Wave* w = findWave(j, j->samples[k].t);
+      if (w == NULL) {
+        continue;
+      }
+      double error = j->samples[k].pos - ideal(w, j->samples[k].t);
+      squares += error * error;
+      worst = fmax(worst, fabs(error));
+      compared++;
+    }
+    fprintf(out, "%s,%d,%d,%.2f,%.2f\n", jointName(i), (int) j->samples.size(), compared,
+            compared > 0 ? sqrt(squares / compared) : 0.0, worst);
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: traceplot trace.csv > trace.svg\n");
+    return 2;
+  }
+  FILE* in = strcmp(argv[1], "-") == 0 ? stdin : fopen(argv[1], "r");
+  if (in == NULL) {
+    fprintf(stderr, "Can't open %s\n", argv[1]);
+    return 2;
+  }
+  double tMax = readTrace(in);
+  double tMin = tMax;
+  for (int i = 0; i < MAX_JOINTS; i++) {
+    if (!joints[i].samples.empty()) {tMin = fmin(tMin, joints[i].samples[0].t);}
+  }
+  if (tMin >= tMax) {
+    fprintf(stderr, "No servo positions in %s\n", argv[1]);
+    return 1;
+  }
+
+  plot(stdout, tMin, tMax);
+  report(stderr);
+  return 0;
+}